@@ -41,6 +41,8 @@ using std::vector;
 #include "cnn_genome.hxx"
 #include "exact.hxx"
 
+#include "common/file_writer.hxx"
+
 #ifdef _MYSQL_
 #include "common/db_conn.hxx"
 #endif
@@ -1345,11 +1347,13 @@ bool EXACT::insert_genome(CNN_Genome* genome) {
 
         cout << "writing new best (data) to: " << (output_directory + "/global_best_" + to_string(inserted_genomes) + ".txt") << endl;
 
-        genome->write_to_file(output_directory + "/global_best_" + to_string(inserted_genomes) + ".txt");
+        ostringstream genome_file;
+        genome->write(genome_file);
+        FileWriter::get_shared()->write(output_directory + "/global_best_" + to_string(inserted_genomes) + ".txt", genome_file.str());
 
         cout << "writing new best (graphviz) to: " << (output_directory + "/global_best_" + to_string(inserted_genomes) + ".txt") << endl;
 
-        ofstream gv_file(output_directory + "/global_best_" + to_string(inserted_genomes) + ".gv");
+        ostringstream gv_file;
         gv_file << "#EXACT settings: " << endl;
 
         gv_file << "#EXACT settings: " << endl;
@@ -1436,7 +1440,7 @@ bool EXACT::insert_genome(CNN_Genome* genome) {
         gv_file << "#\t\tnode_disable: " << node_disable << endl;
 
         genome->print_graphviz(gv_file);
-        gv_file.close();
+        FileWriter::get_shared()->write(output_directory + "/global_best_" + to_string(inserted_genomes) + ".gv", gv_file.str());
     }
     cout << endl;
 
@@ -2656,7 +2660,7 @@ CNN_Genome* EXACT::create_child() {
 
 
 void EXACT::write_individual_hyperparameters(CNN_Genome *individual) {
-    fstream out(output_directory + "/individual_hyperparameters.txt", fstream::out | fstream::app);
+    ostringstream out;
 
     out << individual->get_best_validation_error()
         << "," << individual->get_best_validation_error()
@@ -2682,7 +2686,7 @@ void EXACT::write_individual_hyperparameters(CNN_Genome *individual) {
 
         << endl;
 
-    out.close();
+    FileWriter::get_shared()->append(output_directory + "/individual_hyperparameters.txt", out.str());
 }
 
 void EXACT::write_statistics(int new_generation_id, float new_fitness) {
@@ -2818,7 +2822,9 @@ void EXACT::write_statistics(int new_generation_id, float new_fitness) {
     if (max_weights == -EXACT_MAX_FLOAT) max_weights = 0;
 
 
-    fstream out(output_directory + "/progress.txt", fstream::out | fstream::app);
+    //the lines are queued to the background file writer so inserting
+    //genomes doesn't wait on the filesystem
+    ostringstream out;
 
     out << setw(16) << time(NULL)
         << setw(16) << new_generation_id
@@ -2852,9 +2858,9 @@ void EXACT::write_statistics(int new_generation_id, float new_fitness) {
     }
     out << endl;
 
-    out.close();
+    FileWriter::get_shared()->append(output_directory + "/progress.txt", out.str());
 
-    out = fstream(output_directory + "/hyperparameters.txt", fstream::out | fstream::app);
+    out = ostringstream();
 
     float min_initial_mu = 10, max_initial_mu = 0, avg_initial_mu = 0;
     float min_mu_delta = 10, max_mu_delta = 0, avg_mu_delta = 0;
@@ -3071,7 +3077,7 @@ void EXACT::write_statistics(int new_generation_id, float new_fitness) {
 
         << endl;
  
-    out.close();
+    FileWriter::get_shared()->append(output_directory + "/hyperparameters.txt", out.str());
 }
 
 void EXACT::write_hyperparameters_header() {
@@ -0,0 +1,144 @@
+#include <cstdio>
+
+#include <fstream>
+using std::ios;
+using std::ofstream;
+
+#include <iostream>
+using std::cerr;
+using std::cout;
+using std::endl;
+
+#include <mutex>
+using std::mutex;
+using std::unique_lock;
+
+#include <string>
+using std::string;
+
+#include <thread>
+using std::thread;
+
+#include <vector>
+using std::vector;
+
+#include "file_writer.hxx"
+
+FileWrite::FileWrite(string _filename, string _contents, bool _append) : filename(_filename), contents(_contents), append(_append) {
+}
+
+FileWriter::FileWriter(int32_t _max_queued) : max_queued(_max_queued), writing(false), shutting_down(false) {
+    if (max_queued < 1) max_queued = 1;
+    writer = thread(&FileWriter::writer_loop, this);
+}
+
+FileWriter::~FileWriter() {
+    {
+        unique_lock<mutex> lock(queue_mutex);
+        shutting_down = true;
+    }
+    work_available.notify_all();
+
+    //the writer empties the queue before it exits
+    writer.join();
+}
+
+void FileWriter::enqueue(FileWrite file_write) {
+    {
+        unique_lock<mutex> lock(queue_mutex);
+        space_available.wait(lock, [this] { return (int32_t)queue.size() < max_queued; });
+        queue.push_back(std::move(file_write));
+    }
+    work_available.notify_one();
+}
+
+void FileWriter::write(string filename, string contents) {
+    enqueue( FileWrite(filename, std::move(contents), false) );
+}
+
+void FileWriter::append(string filename, string contents) {
+    enqueue( FileWrite(filename, std::move(contents), true) );
+}
+
+void FileWriter::print(string contents) {
+    enqueue( FileWrite("", std::move(contents), true) );
+}
+
+void FileWriter::flush() {
+    unique_lock<mutex> lock(queue_mutex);
+    queue_finished.wait(lock, [this] { return queue.empty() && !writing; });
+}
+
+void FileWriter::writer_loop() {
+    vector<FileWrite> batch;
+
+    while (true) {
+        {
+            unique_lock<mutex> lock(queue_mutex);
+            work_available.wait(lock, [this] { return shutting_down || !queue.empty(); });
+            if (queue.empty()) return;
+
+            //take everything queued so far so it can be written as a batch
+            while (!queue.empty()) {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+            writing = true;
+        }
+        space_available.notify_all();
+
+        for (int32_t i = 0; i < (int32_t)batch.size(); ) {
+            //appends and prints to the same place are merged into one write
+            string contents = std::move(batch[i].contents);
+            int32_t next = i + 1;
+            if (batch[i].append) {
+                while (next < (int32_t)batch.size() && batch[next].append && batch[next].filename == batch[i].filename) {
+                    contents += batch[next].contents;
+                    next++;
+                }
+            }
+
+            if (batch[i].filename == "") {
+                cout << contents;
+                cout.flush();
+            } else if (batch[i].append) {
+                ofstream outfile(batch[i].filename, ios::out | ios::binary | ios::app);
+
+                if (!outfile.is_open()) {
+                    cerr << "ERROR, could not open file for writing: '" << batch[i].filename << "'" << endl;
+                } else {
+                    outfile.write(contents.c_str(), contents.size());
+                    outfile.close();
+                }
+            } else {
+                string temporary_filename = batch[i].filename + ".tmp";
+                ofstream outfile(temporary_filename, ios::out | ios::binary | ios::trunc);
+
+                if (!outfile.is_open()) {
+                    cerr << "ERROR, could not open file for writing: '" << temporary_filename << "'" << endl;
+                } else {
+                    outfile.write(contents.c_str(), contents.size());
+                    outfile.close();
+
+                    if (std::rename(temporary_filename.c_str(), batch[i].filename.c_str()) != 0) {
+                        cerr << "ERROR, could not rename '" << temporary_filename << "' to '" << batch[i].filename << "'" << endl;
+                    }
+                }
+            }
+
+            i = next;
+        }
+        batch.clear();
+
+        {
+            unique_lock<mutex> lock(queue_mutex);
+            writing = false;
+            if (queue.empty()) queue_finished.notify_all();
+        }
+    }
+}
+
+FileWriter* FileWriter::get_shared() {
+    static FileWriter shared_writer(1024);
+    return &shared_writer;
+}
@@ -0,0 +1,70 @@
+#ifndef EXACT_FILE_WRITER_HXX
+#define EXACT_FILE_WRITER_HXX
+
+#include <condition_variable>
+using std::condition_variable;
+
+#include <deque>
+using std::deque;
+
+#include <mutex>
+using std::mutex;
+
+#include <string>
+using std::string;
+
+#include <thread>
+using std::thread;
+
+class FileWrite {
+    public:
+        //an empty filename prints the contents to standard output
+        string filename;
+        string contents;
+        bool append;
+
+        FileWrite(string _filename, string _contents, bool _append);
+};
+
+//a single background thread which writes files (and prints to standard
+//output) for the threads queueing them, so that searches which write out
+//results as they go don't wait on a slow or shared filesystem. the complete
+//contents are queued with each write so nothing the caller owns is used
+//afterwards. writes are done in the order they were queued, and at most
+//max_queued can be waiting, after which queueing blocks until there is room.
+class FileWriter {
+    private:
+        thread writer;
+
+        mutex queue_mutex;
+        condition_variable work_available;
+        condition_variable space_available;
+        condition_variable queue_finished;
+        deque<FileWrite> queue;
+        int32_t max_queued;
+        bool writing;
+        bool shutting_down;
+
+        void writer_loop();
+        void enqueue(FileWrite file_write);
+
+    public:
+        FileWriter(int32_t _max_queued);
+        ~FileWriter();
+
+        //replaces the file with the contents. they are written to a temporary
+        //file which is renamed over the file, so it is never left partially
+        //written (e.g. a checkpoint when the process is killed)
+        void write(string filename, string contents);
+        void append(string filename, string contents);
+        void print(string contents);
+
+        //returns once everything queued so far has been written
+        void flush();
+
+        //a process wide writer, created the first time it is requested and
+        //flushed when the process exits
+        static FileWriter* get_shared();
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include <algorithm>
+using std::find;
+using std::max;
+
+#include <atomic>
+using std::atomic;
+
+#include <functional>
+using std::function;
+
+#include <mutex>
+using std::mutex;
+using std::unique_lock;
+
+#include <thread>
+using std::thread;
+
+#include "thread_pool.hxx"
+
+class ThreadPoolJob {
+    public:
+        const function<void (int32_t)> *task;
+        int32_t number_tasks;
+        atomic<int32_t> next_task;
+
+        //number of pool workers currently executing tasks from this job,
+        //only modified while holding the pool mutex
+        int32_t active_workers;
+
+        ThreadPoolJob(int32_t _number_tasks, const function<void (int32_t)> *_task) : task(_task), number_tasks(_number_tasks), next_task(0), active_workers(0) {
+        }
+
+        bool exhausted() const {
+            return next_task.load() >= number_tasks;
+        }
+
+        void run_tasks() {
+            for (int32_t i = next_task++; i < number_tasks; i = next_task++) {
+                (*task)(i);
+            }
+        }
+};
+
+ThreadPool::ThreadPool(int32_t number_threads) : shutting_down(false) {
+    for (int32_t i = 0; i < number_threads; i++) {
+        workers.push_back( thread(&ThreadPool::worker_loop, this) );
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        unique_lock<mutex> lock(pool_mutex);
+        shutting_down = true;
+    }
+    work_available.notify_all();
+
+    for (uint32_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+int32_t ThreadPool::get_number_threads() const {
+    return workers.size();
+}
+
+void ThreadPool::remove_job(ThreadPoolJob *job) {
+    auto it = find(jobs.begin(), jobs.end(), job);
+    if (it != jobs.end()) jobs.erase(it);
+}
+
+void ThreadPool::worker_loop() {
+    unique_lock<mutex> lock(pool_mutex);
+
+    while (true) {
+        work_available.wait(lock, [this] { return shutting_down || !jobs.empty(); });
+        if (jobs.empty()) return;
+
+        ThreadPoolJob *job = jobs.front();
+        job->active_workers++;
+
+        lock.unlock();
+        job->run_tasks();
+        lock.lock();
+
+        //every task of the job has been claimed, so no other worker should pick it up
+        remove_job(job);
+        job->active_workers--;
+        if (job->active_workers == 0) job_finished.notify_all();
+    }
+}
+
+void ThreadPool::parallel_for(int32_t number_tasks, const function<void (int32_t)> &task) {
+    if (number_tasks <= 0) return;
+
+    if (number_tasks == 1 || workers.size() == 0) {
+        for (int32_t i = 0; i < number_tasks; i++) task(i);
+        return;
+    }
+
+    ThreadPoolJob job(number_tasks, &task);
+
+    {
+        unique_lock<mutex> lock(pool_mutex);
+        jobs.push_back(&job);
+    }
+    work_available.notify_all();
+
+    job.run_tasks();
+
+    //all tasks have been claimed once run_tasks returns, so the job is
+    //finished when no worker is still running one of them
+    unique_lock<mutex> lock(pool_mutex);
+    remove_job(&job);
+    job_finished.wait(lock, [&job] { return job.active_workers == 0; });
+}
+
+ThreadPool* ThreadPool::get_shared() {
+    static ThreadPool shared_pool(max<int32_t>(1, thread::hardware_concurrency()) - 1);
+    return &shared_pool;
+}
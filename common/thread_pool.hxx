@@ -0,0 +1,61 @@
+#ifndef EXACT_THREAD_POOL_HXX
+#define EXACT_THREAD_POOL_HXX
+
+#include <atomic>
+using std::atomic;
+
+#include <condition_variable>
+using std::condition_variable;
+
+#include <deque>
+using std::deque;
+
+#include <functional>
+using std::function;
+
+#include <mutex>
+using std::mutex;
+
+#include <thread>
+using std::thread;
+
+#include <vector>
+using std::vector;
+
+class ThreadPoolJob;
+
+//a set of worker threads that are kept alive for the lifetime of the pool,
+//so that code which repeatedly runs small parallel loops (e.g. one forward
+//and backward pass per training series every bp iteration) does not pay for
+//thread creation each time. multiple threads may call parallel_for on the
+//same pool concurrently, the calling thread also works on its own loop so
+//nested or concurrent calls can never deadlock waiting on the workers.
+class ThreadPool {
+    private:
+        vector<thread> workers;
+
+        mutex pool_mutex;
+        condition_variable work_available;
+        condition_variable job_finished;
+        deque<ThreadPoolJob*> jobs;
+        bool shutting_down;
+
+        void worker_loop();
+        void remove_job(ThreadPoolJob *job);
+
+    public:
+        ThreadPool(int32_t number_threads);
+        ~ThreadPool();
+
+        int32_t get_number_threads() const;
+
+        //runs task(i) for i in [0, number_tasks) and returns once all of them
+        //have completed. the task is passed by reference and is never copied.
+        void parallel_for(int32_t number_tasks, const function<void (int32_t)> &task);
+
+        //a process wide pool with one worker per hardware thread (less the
+        //calling thread), created the first time it is requested
+        static ThreadPool* get_shared();
+};
+
+#endif
@@ -1,5 +1,8 @@
 #include <chrono>
 
+#include <deque>
+using std::deque;
+
 #include <iomanip>
 using std::setw;
 using std::fixed;
@@ -45,6 +48,45 @@ bool finished = false;
 
 int images_resize;
 
+//with a timeout, a worker which hasn't sent back its genome within that many
+//seconds is given up on, and the genome is sent to the next worker asking
+//for work instead. 0 waits forever.
+int worker_timeout = 0;
+
+//what the master knows about one of its workers
+class WorkerState {
+    public:
+        bool terminated;
+        bool failed;
+
+        //the genome the worker is training (empty if none), kept to be
+        //reissued if it fails
+        string outstanding_genome;
+        std::chrono::time_point<std::chrono::steady_clock> genome_sent;
+
+        //when a failed worker was last heard from (or failed)
+        std::chrono::time_point<std::chrono::steady_clock> last_heard;
+
+        WorkerState() : terminated(false), failed(false) {
+        }
+};
+
+//workers only ask for more work after sending back their genome, so once
+//every worker has been terminated the search is done. a failed worker may
+//only have been slow, so it is waited on to ask for work (and be terminated)
+//unless it stays silent for another timeout, when it is assumed to be dead.
+bool workers_stopped(const vector<WorkerState> &workers) {
+    std::chrono::time_point<std::chrono::steady_clock> now = std::chrono::steady_clock::now();
+
+    for (int i = 1; i < (int)workers.size(); i++) {
+        const WorkerState &worker = workers[i];
+        if (worker.terminated) continue;
+        if (worker.failed && std::chrono::duration_cast<std::chrono::seconds>(now - worker.last_heard).count() >= worker_timeout) continue;
+        return false;
+    }
+    return true;
+}
+
 void send_work_request(int target) {
     int work_request_message[1];
     work_request_message[0] = 0;
@@ -83,12 +125,7 @@ CNN_Genome* receive_genome_from(string name, int source) {
     return genome;
 }
 
-void send_genome_to(string name, int target, CNN_Genome* genome) {
-    ostringstream oss;
-
-    genome->write(oss);
-
-    string genome_str = oss.str();
+void send_genome_string_to(string name, int target, const string &genome_str) {
     int length = genome_str.size();
 
     cout << "[" << setw(10) << name << "] sending genome of length: " << length << " to: " << target << endl;
@@ -101,6 +138,12 @@ void send_genome_to(string name, int target, CNN_Genome* genome) {
     MPI_Send(genome_str.c_str(), length, MPI_CHAR, target, GENOME_TAG, MPI_COMM_WORLD);
 }
 
+void send_genome_to(string name, int target, CNN_Genome* genome) {
+    ostringstream oss;
+    genome->write(oss);
+    send_genome_string_to(name, target, oss.str());
+}
+
 void send_terminate_message(int target) {
     int terminate_message[1];
     terminate_message[0] = 0;
@@ -120,21 +163,83 @@ void master(const Images &training_images, const Images &validation_images, cons
 
     int terminates_sent = 0;
 
-    while (true) {
-        //wait for a incoming message
+    vector<WorkerState> workers(max_rank);
+    deque<string> reissued_genomes;
+
+    //a send to a failed worker shouldn't take the search down with it
+    if (worker_timeout > 0) MPI_Comm_set_errhandler(MPI_COMM_WORLD, MPI_ERRORS_RETURN);
+
+    while (!workers_stopped(workers)) {
+        //wait for a incoming message, with a timeout the workers' deadlines
+        //are checked every time around (even if messages keep arriving)
         MPI_Status status;
-        MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+        if (worker_timeout > 0) {
+            std::chrono::time_point<std::chrono::steady_clock> now = std::chrono::steady_clock::now();
+
+            for (int i = 1; i < max_rank; i++) {
+                WorkerState &worker = workers[i];
+                if (worker.failed || worker.outstanding_genome.empty()) continue;
+                if (std::chrono::duration_cast<std::chrono::seconds>(now - worker.genome_sent).count() < worker_timeout) continue;
+
+                cerr << "[" << setw(10) << name << "] worker " << i << " has not sent back its genome in " << worker_timeout << " seconds, reissuing it" << endl;
+                reissued_genomes.push_back(worker.outstanding_genome);
+                worker.outstanding_genome.clear();
+                worker.failed = true;
+                worker.last_heard = now;
+            }
+
+            int arrived;
+            MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &arrived, &status);
+
+            if (!arrived) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+        } else {
+            MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+        }
 
         int source = status.MPI_SOURCE;
         int tag = status.MPI_TAG;
         cout << "[" << setw(10) << name << "] probe returned message from: " << source << " with tag: " << tag << endl;
 
+        WorkerState &worker = workers[source];
+
+        //a worker given up on which was only slow has had its genome reissued,
+        //so its result is dropped and it is told to stop when it asks for work
+        if (worker.failed) {
+            worker.last_heard = std::chrono::steady_clock::now();
+
+            if (tag == WORK_REQUEST_TAG) {
+                receive_work_request(source);
+
+                if (!worker.terminated) {
+                    cout << "[" << setw(10) << name << "] terminating failed worker: " << source << endl;
+                    send_terminate_message(source);
+                    worker.terminated = true;
+                }
+            } else {
+                delete receive_genome_from(name, source);
+            }
+            continue;
+        }
 
         //if the message is a work request, send a genome
 
         if (tag == WORK_REQUEST_TAG) {
             receive_work_request(source);
 
+            //genomes from failed workers go out before any new ones
+            if (reissued_genomes.size() > 0) {
+                cout << "[" << setw(10) << name << "] reissuing genome to: " << source << endl;
+                send_genome_string_to(name, source, reissued_genomes.front());
+
+                worker.outstanding_genome = reissued_genomes.front();
+                worker.genome_sent = std::chrono::steady_clock::now();
+                reissued_genomes.pop_front();
+                continue;
+            }
+
             exact_mutex.lock();
             CNN_Genome *genome = exact->generate_individual();
             exact_mutex.unlock();
@@ -143,10 +248,10 @@ void master(const Images &training_images, const Images &validation_images, cons
                 //send terminate message
                 cout << "[" << setw(10) << name << "] terminating worker: " << source << endl;
                 send_terminate_message(source);
+                worker.terminated = true;
                 terminates_sent++;
 
                 cout << "[" << setw(10) << name << "] sent: " << terminates_sent << " terminates of: " << (max_rank - 1) << endl;
-                if (terminates_sent >= max_rank - 1) return;
 
             } else {
                 ofstream outfile(exact->get_output_directory() + "/gen_" + to_string(genome->get_generation_id()));
@@ -155,7 +260,14 @@ void master(const Images &training_images, const Images &validation_images, cons
 
                 //send genome
                 cout << "[" << setw(10) << name << "] sending genome to: " << source << endl;
-                send_genome_to(name, source, genome);
+                ostringstream oss;
+                genome->write(oss);
+                send_genome_string_to(name, source, oss.str());
+
+                if (worker_timeout > 0) {
+                    worker.outstanding_genome = oss.str();
+                    worker.genome_sent = std::chrono::steady_clock::now();
+                }
 
                 //delete this genome as it will not be used again
                 delete genome;
@@ -163,6 +275,7 @@ void master(const Images &training_images, const Images &validation_images, cons
         } else if (tag == GENOME_LENGTH_TAG) {
             cout << "[" << setw(10) << name << "] received genome from: " << source << endl;
             CNN_Genome *genome = receive_genome_from(name, source);
+            worker.outstanding_genome.clear();
 
             exact_mutex.lock();
             exact->insert_genome(genome);
@@ -174,6 +287,20 @@ void master(const Images &training_images, const Images &validation_images, cons
             MPI_Abort(MPI_COMM_WORLD, 1);
         }
     }
+
+    if (reissued_genomes.size() > 0) {
+        cerr << "[" << setw(10) << name << "] " << reissued_genomes.size() << " genomes from failed workers were lost, there were no workers left to reissue them to" << endl;
+    }
+
+    //a failed worker which never asked for more work is still told to stop,
+    //in case it was only slow
+    for (int i = 1; i < max_rank; i++) {
+        if (workers[i].failed && !workers[i].terminated) {
+            cout << "[" << setw(10) << name << "] terminating failed worker: " << i << endl;
+            send_terminate_message(i);
+            workers[i].terminated = true;
+        }
+    }
 }
 
 void worker(const Images &training_images, const Images &validation_images, const Images &testing_images, int rank) {
@@ -260,6 +387,8 @@ int main(int argc, char** argv) {
 
     get_argument(arguments, "--images_resize", true, images_resize);
 
+    get_argument(arguments, "--worker_timeout", false, worker_timeout);
+
     Images training_images(training_filename, padding);
     Images validation_images(validation_filename, padding, training_images.get_average(), training_images.get_std_dev());
     Images testing_images(testing_filename, padding, training_images.get_average(), training_images.get_std_dev());
@@ -1,5 +1,19 @@
 #include <chrono>
 
+#include <condition_variable>
+using std::condition_variable;
+
+#include <csignal>
+
+#include <cstring>
+
+#include <deque>
+using std::deque;
+
+#include <fstream>
+using std::ifstream;
+using std::ios;
+
 #include <iomanip>
 using std::setw;
 using std::fixed;
@@ -10,8 +24,17 @@ using std::cerr;
 using std::cout;
 using std::endl;
 
+#include <map>
+using std::map;
+
 #include <mutex>
+using std::lock_guard;
 using std::mutex;
+using std::unique_lock;
+
+#include <sstream>
+using std::istringstream;
+using std::ostringstream;
 
 #include <string>
 using std::string;
@@ -19,21 +42,30 @@ using std::string;
 #include <thread>
 using std::thread;
 
+#include <utility>
+using std::pair;
+
 #include <vector>
 using std::vector;
 
 #include "mpi.h"
 
 #include "common/arguments.hxx"
+#include "common/file_writer.hxx"
+#include "common/files.hxx"
 
 #include "rnn/examm.hxx"
 
 #include "time_series/time_series.hxx"
 
+#include "shared_time_series.hxx"
+
 #define WORK_REQUEST_TAG 1
-#define GENOME_LENGTH_TAG 2
 #define GENOME_TAG 3
 #define TERMINATE_TAG 4
+#define ELITE_TAG 6
+#define FINAL_ELITE_TAG 7
+#define MIGRANT_TAG 8
 
 mutex examm_mutex;
 
@@ -43,73 +75,266 @@ EXAMM *examm;
 
 bool finished = false;
 
-vector< vector< vector<double> > > training_inputs;
-vector< vector< vector<double> > > training_outputs;
-vector< vector< vector<double> > > validation_inputs;
-vector< vector< vector<double> > > validation_outputs;
+SeriesViews training_inputs;
+SeriesViews training_outputs;
+SeriesViews validation_inputs;
+SeriesViews validation_outputs;
+
+//genomes are sent without these, every rank sets them from its own copy of the data
+vector<string> input_parameter_names;
+vector<string> output_parameter_names;
+map<string,double> normalize_mins;
+map<string,double> normalize_maxs;
+
+//truncated backpropagation through time is off with a window of 0
+int32_t bptt_window = 0;
+int32_t bptt_stride = 0;
+
+//genomes are never stopped early with a grace period of 0
+int32_t early_stop_grace = 0;
+
+//how many genomes each worker has waiting for it while it trains one, so it
+//can start on the next as soon as it finishes. 0 asks for the next genome
+//only after the previous one has been sent back.
+int32_t prefetch_depth = 1;
+
+//each worker rank trains this many genomes at once, on threads which share
+//the rank's one copy of the training data
+int32_t worker_threads = 1;
+
+//with a timeout, a worker which has genomes out but hasn't been heard from in
+//that many seconds is given up on, and its genomes are sent to other workers.
+//it has to be longer than training any one genome takes. 0 waits forever.
+int32_t worker_timeout = 0;
+
+mutex trainer_mutex;
+condition_variable genome_available;
+condition_variable genome_trained;
+deque<RNN_Genome*> untrained_genomes;
+deque<RNN_Genome*> trained_genomes;
+bool trainers_finished = false;
+
+//with --hierarchical, each group of ranks (by default the ranks on a node)
+//has a sub-master running its own search over some of the islands for the
+//workers in the group. every migration_interval genomes a sub-master sends
+//its best genome to the global master (rank 0), which answers with the best
+//genome it has from the other sub-masters to be inserted as a migrant.
+bool hierarchical = false;
+int32_t migration_interval = 100;
+
+//the communicator a master (or sub-master) and its workers use
+MPI_Comm search_comm = MPI_COMM_WORLD;
+
+string checkpoint_file = "";
+int32_t checkpoint_interval = 300;
+
+//set by SIGUSR1 (write a checkpoint) or SIGTERM (write a checkpoint, then
+//stop the workers and exit)
+volatile sig_atomic_t checkpoint_signal = 0;
+
+void checkpoint_signal_handler(int signal) {
+    checkpoint_signal = signal;
+}
 
 void send_work_request(int target) {
     int work_request_message[1];
     work_request_message[0] = 0;
-    MPI_Send(work_request_message, 1, MPI_INT, target, WORK_REQUEST_TAG, MPI_COMM_WORLD);
+    MPI_Send(work_request_message, 1, MPI_INT, target, WORK_REQUEST_TAG, search_comm);
 }
 
 void receive_work_request(int source) {
     MPI_Status status;
     int work_request_message[1];
-    MPI_Recv(work_request_message, 1, MPI_INT, source, WORK_REQUEST_TAG, MPI_COMM_WORLD, &status);
+    MPI_Recv(work_request_message, 1, MPI_INT, source, WORK_REQUEST_TAG, search_comm, &status);
 }
 
-RNN_Genome* receive_genome_from(string name, int source) {
-    MPI_Status status;
-    int length_message[1];
-    MPI_Recv(length_message, 1, MPI_INT, source, GENOME_LENGTH_TAG, MPI_COMM_WORLD, &status);
+//a genome send which may not have completed yet, its buffer can only be
+//reused once it has. the buffer keeps its capacity between sends, so once
+//it has held the largest message nothing is allocated for it again
+class PendingSend {
+    public:
+        MPI_Request request;
+        string buffer;
 
-    int length = length_message[0];
+        PendingSend() : request(MPI_REQUEST_NULL) {
+        }
+};
 
-    cout << "[" << setw(10) << name << "] receiving genome of length: " << length << " from: " << source << endl;
+vector<PendingSend*> pending_sends;
+
+PendingSend* get_send_buffer() {
+    for (int32_t i = 0; i < (int32_t)pending_sends.size(); i++) {
+        int completed;
+        MPI_Test(&pending_sends[i]->request, &completed, MPI_STATUS_IGNORE);
+        if (completed) return pending_sends[i];
+    }
 
-    char* genome_str = new char[length + 1];
+    pending_sends.push_back(new PendingSend());
+    return pending_sends.back();
+}
+
+void wait_for_sends() {
+    for (int32_t i = 0; i < (int32_t)pending_sends.size(); i++) {
+        MPI_Wait(&pending_sends[i]->request, MPI_STATUS_IGNORE);
+        delete pending_sends[i];
+    }
+    pending_sends.clear();
+}
 
-    cout << "[" << setw(10) << name << "] receiving genome from: " << source << endl;
-    MPI_Recv(genome_str, length, MPI_CHAR, source, GENOME_TAG, MPI_COMM_WORLD, &status);
+//a genome is sent as a single message: the per genome training settings
+//EXAMM picks (which aren't written with the genome) followed by the genome
+//bytes. the receiver sizes it by probing for it first. an empty message is
+//sent when there is no genome to send.
+RNN_Genome* receive_genome_from(string name, MPI_Status &status, string &buffer, MPI_Comm comm) {
+    int source = status.MPI_SOURCE;
+    int length;
+    MPI_Get_count(&status, MPI_CHAR, &length);
 
-    genome_str[length] = '\0';
+    cout << "[" << setw(10) << name << "] receiving genome of length: " << length << " from: " << source << endl;
+
+    buffer.resize(length);
+    MPI_Recv(&buffer[0], length, MPI_CHAR, source, status.MPI_TAG, comm, MPI_STATUS_IGNORE);
 
-    //cout << "genome_str:" << endl << genome_str << endl;
+    if (length == 0) return NULL;
+
+    double settings[3];
+    if (length < (int)sizeof(settings)) {
+        cerr << "[" << setw(10) << name << "] ERROR: received a genome message of " << length << " bytes from: " << source << ", which is too short to hold its training settings" << endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    memcpy(settings, &buffer[0], sizeof(settings));
 
-    RNN_Genome* genome = new RNN_Genome(genome_str, length, false);
+    RNN_Genome* genome = new RNN_Genome(&buffer[sizeof(settings)], length - sizeof(settings), false);
+    genome->set_early_stop(settings[0], early_stop_grace);
+    genome->set_training_series_fraction(settings[1]);
+    genome->set_keep_optimizer_state(settings[2] != 0.0);
+    genome->set_parameter_names(input_parameter_names, output_parameter_names);
+    genome->set_normalize_bounds(normalize_mins, normalize_maxs);
 
-    delete [] genome_str;
     return genome;
 }
 
-void send_genome_to(string name, int target, RNN_Genome* genome) {
-    char *byte_array;
-    int32_t length;
+string genome_message(RNN_Genome* genome) {
+    ostringstream genome_bytes;
 
-    genome->write_to_array(&byte_array, length);
+    if (genome != NULL) {
+        double settings[3];
+        settings[0] = genome->get_early_stop_threshold();
+        settings[1] = genome->get_training_series_fraction();
+        settings[2] = genome->get_keep_optimizer_state() ? 1.0 : 0.0;
+        genome_bytes.write((char*)settings, sizeof(settings));
+        genome->write_to_compact_stream(genome_bytes, false);
+    }
+
+    return genome_bytes.str();
+}
 
-    cout << "[" << setw(10) << name << "] sending genome of length: " << length << " to: " << target << endl;
+void send_message_to(string name, int target, const string &message, MPI_Comm comm, int tag) {
+    PendingSend *send = get_send_buffer();
+    send->buffer.assign(message.data(), message.size());
 
-    int length_message[1];
-    length_message[0] = length;
-    MPI_Send(length_message, 1, MPI_INT, target, GENOME_LENGTH_TAG, MPI_COMM_WORLD);
+    cout << "[" << setw(10) << name << "] sending genome of length: " << send->buffer.size() << " to: " << target << endl;
+    MPI_Isend(&send->buffer[0], send->buffer.size(), MPI_CHAR, target, tag, comm, &send->request);
+}
 
-    cout << "[" << setw(10) << name << "] sending genome to: " << target << endl;
-    MPI_Send(byte_array, length, MPI_CHAR, target, GENOME_TAG, MPI_COMM_WORLD);
+void send_genome_to(string name, int target, RNN_Genome* genome, MPI_Comm comm, int tag) {
+    send_message_to(name, target, genome_message(genome), comm, tag);
 }
 
 void send_terminate_message(int target) {
     int terminate_message[1];
     terminate_message[0] = 0;
-    MPI_Send(terminate_message, 1, MPI_INT, target, TERMINATE_TAG, MPI_COMM_WORLD);
+    MPI_Send(terminate_message, 1, MPI_INT, target, TERMINATE_TAG, search_comm);
 }
 
 void receive_terminate_message(int source) {
     MPI_Status status;
     int terminate_message[1];
-    MPI_Recv(terminate_message, 1, MPI_INT, source, TERMINATE_TAG, MPI_COMM_WORLD, &status);
+    MPI_Recv(terminate_message, 1, MPI_INT, source, TERMINATE_TAG, search_comm, &status);
+}
+
+//a sub-master inserts the migrants sent back for its elites as they arrive.
+//once its search is finished the rest are only received.
+void receive_migrants(string name, int64_t elites_sent, int64_t &migrants_received, bool search_finished, string &buffer) {
+    while (migrants_received < elites_sent) {
+        MPI_Status status;
+        if (search_finished) {
+            MPI_Probe(0, MIGRANT_TAG, MPI_COMM_WORLD, &status);
+        } else {
+            int arrived;
+            MPI_Iprobe(0, MIGRANT_TAG, MPI_COMM_WORLD, &arrived, &status);
+            if (!arrived) return;
+        }
+
+        RNN_Genome *migrant = receive_genome_from(name, status, buffer, MPI_COMM_WORLD);
+        migrants_received++;
+
+        if (migrant == NULL) continue;
+        if (!search_finished) examm->insert_migrant(migrant);
+        delete migrant;
+    }
+}
+
+//what the master knows about one of its workers
+class WorkerState {
+    public:
+        bool terminated;
+        bool failed;
+
+        int64_t genomes_sent;
+        int64_t genomes_received;
+        int64_t work_requests_received;
+
+        std::chrono::time_point<std::chrono::steady_clock> last_heard;
+
+        //with a worker_timeout, the messages for the genomes the worker has
+        //not sent back yet (by generation id), to be reissued if it fails
+        map<int32_t, string> outstanding_genomes;
+
+        WorkerState() : terminated(false), failed(false), genomes_sent(0), genomes_received(0), work_requests_received(0), last_heard(std::chrono::steady_clock::now()) {
+        }
+};
+
+//every worker thread starts by asking for 1 + prefetch_depth genomes and asks
+//for another after each one it sends back, so once a worker has been
+//terminated it is only done when all of those requests and results have
+//been received. a failed worker may only have been slow, so it is waited on
+//the same way unless it stays silent for another timeout, in which case it
+//is assumed to be dead.
+bool workers_finished(const vector<WorkerState> &workers) {
+    std::chrono::time_point<std::chrono::steady_clock> now = std::chrono::steady_clock::now();
+
+    for (int32_t i = 1; i < (int32_t)workers.size(); i++) {
+        const WorkerState &worker = workers[i];
+        if (worker.failed && std::chrono::duration_cast<std::chrono::seconds>(now - worker.last_heard).count() >= worker_timeout) continue;
+
+        int64_t work_requests_expected = (int64_t)worker_threads * (1 + prefetch_depth) + worker.genomes_sent;
+        if (!worker.terminated || worker.genomes_received != worker.genomes_sent || worker.work_requests_received != work_requests_expected) return false;
+    }
+    return true;
+}
+
+//gives up on any worker with genomes out which hasn't sent anything within
+//the timeout, queueing its genomes to be sent to the next workers asking
+void check_worker_timeouts(string name, vector<WorkerState> &workers, deque< pair<int32_t, string> > &reissued_genomes) {
+    std::chrono::time_point<std::chrono::steady_clock> now = std::chrono::steady_clock::now();
+
+    for (int32_t i = 1; i < (int32_t)workers.size(); i++) {
+        WorkerState &worker = workers[i];
+        if (worker.failed || worker.genomes_received == worker.genomes_sent) continue;
+        if (std::chrono::duration_cast<std::chrono::seconds>(now - worker.last_heard).count() < worker_timeout) continue;
+
+        cerr << "[" << setw(10) << name << "] worker " << i << " has not been heard from in " << worker_timeout << " seconds, reissuing its " << worker.outstanding_genomes.size() << " genomes" << endl;
+
+        for (auto genome = worker.outstanding_genomes.begin(); genome != worker.outstanding_genomes.end(); genome++) {
+            reissued_genomes.push_back(*genome);
+        }
+        worker.outstanding_genomes.clear();
+        worker.failed = true;
+
+        //the worker gets another timeout to show up before it is assumed dead
+        worker.last_heard = now;
+    }
 }
 
 void master(int max_rank) {
@@ -118,21 +343,119 @@ void master(int max_rank) {
     cout << "MAX INT: " << numeric_limits<int>::max() << endl;
 
     int terminates_sent = 0;
+    int64_t genomes_received = 0;
+
+    vector<WorkerState> workers(max_rank);
+    deque< pair<int32_t, string> > reissued_genomes;
+
+    //a send to a failed worker shouldn't take the search down with it
+    if (worker_timeout > 0) MPI_Comm_set_errhandler(search_comm, MPI_ERRORS_RETURN);
+
+    string receive_buffer;
+
+    //sub-masters get one migrant (or an empty message) back for every elite
+    int64_t elites_sent = 0;
+    int64_t migrants_received = 0;
+
+    std::chrono::time_point<std::chrono::steady_clock> last_checkpoint = std::chrono::steady_clock::now();
+
+    //after a SIGTERM every worker is told to stop, and the genomes they were
+    //training are received but left out of the search, which was checkpointed
+    bool stopping = false;
+
+    while (!workers_finished(workers)) {
+        //the master only checks for a checkpoint between messages, which
+        //arrive often enough with any number of workers
+        if (checkpoint_file != "") {
+            int signal = checkpoint_signal;
+            std::chrono::time_point<std::chrono::steady_clock> now = std::chrono::steady_clock::now();
+
+            if (!stopping && (signal != 0 || std::chrono::duration_cast<std::chrono::seconds>(now - last_checkpoint).count() >= checkpoint_interval)) {
+                checkpoint_signal = 0;
+                examm->write_checkpoint(checkpoint_file);
+                last_checkpoint = now;
+
+                if (signal == SIGTERM) {
+                    FileWriter::get_shared()->flush();
+                    cerr << "[" << setw(10) << name << "] terminating the workers after writing checkpoint" << endl;
+                    stopping = true;
+
+                    for (int32_t i = 1; i < max_rank; i++) {
+                        if (workers[i].terminated) continue;
+                        send_terminate_message(i);
+                        workers[i].terminated = true;
+                        terminates_sent++;
+                    }
+                }
+            }
+        }
 
-    while (true) {
-        //wait for a incoming message
+        if (hierarchical) receive_migrants(name, elites_sent, migrants_received, false, receive_buffer);
+
+        //wait for a incoming message, with a timeout the workers' deadlines
+        //are checked every time around (even if messages keep arriving)
         MPI_Status status;
-        MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+        if (worker_timeout > 0) {
+            check_worker_timeouts(name, workers, reissued_genomes);
+
+            int arrived;
+            MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, search_comm, &arrived, &status);
+
+            if (!arrived) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+        } else {
+            MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, search_comm, &status);
+        }
 
         int source = status.MPI_SOURCE;
         int tag = status.MPI_TAG;
         cout << "[" << setw(10) << name << "] probe returned message from: " << source << " with tag: " << tag << endl;
 
+        WorkerState &worker = workers[source];
+        worker.last_heard = std::chrono::steady_clock::now();
+
+        //a worker given up on which turns out to only have been slow has had its
+        //genomes reissued, so anything else it sends is dropped and it is told
+        //to stop the next time it asks for work
+        if (worker.failed) {
+            if (tag == WORK_REQUEST_TAG) {
+                receive_work_request(source);
+                worker.work_requests_received++;
+
+                if (!worker.terminated) {
+                    cout << "[" << setw(10) << name << "] terminating failed worker: " << source << endl;
+                    send_terminate_message(source);
+                    worker.terminated = true;
+                }
+            } else {
+                RNN_Genome *genome = receive_genome_from(name, status, receive_buffer, search_comm);
+                worker.genomes_received++;
+                if (genome != NULL) delete genome;
+            }
+            continue;
+        }
 
         //if the message is a work request, send a genome
 
         if (tag == WORK_REQUEST_TAG) {
             receive_work_request(source);
+            worker.work_requests_received++;
+
+            //this worker has already been sent its terminate
+            if (worker.terminated) continue;
+
+            //genomes from failed workers go out before any new ones
+            if (reissued_genomes.size() > 0) {
+                cout << "[" << setw(10) << name << "] reissuing genome " << reissued_genomes.front().first << " to: " << source << endl;
+                send_message_to(name, source, reissued_genomes.front().second, search_comm, GENOME_TAG);
+                worker.outstanding_genomes.insert(reissued_genomes.front());
+                worker.genomes_sent++;
+
+                reissued_genomes.pop_front();
+                continue;
+            }
 
             examm_mutex.lock();
             RNN_Genome *genome = examm->generate_genome();
@@ -142,47 +465,367 @@ void master(int max_rank) {
                 //send terminate message
                 cout << "[" << setw(10) << name << "] terminating worker: " << source << endl;
                 send_terminate_message(source);
+                worker.terminated = true;
                 terminates_sent++;
 
                 cout << "[" << setw(10) << name << "] sent: " << terminates_sent << " terminates of: " << (max_rank - 1) << endl;
-                if (terminates_sent >= max_rank - 1) return;
 
             } else {
                 //genome->write_to_file( examm->get_output_directory() + "/before_send_gen_" + to_string(genome->get_generation_id()) );
 
                 //send genome
                 cout << "[" << setw(10) << name << "] sending genome to: " << source << endl;
-                send_genome_to(name, source, genome);
+                string message = genome_message(genome);
+                send_message_to(name, source, message, search_comm, GENOME_TAG);
+                worker.genomes_sent++;
+
+                if (worker_timeout > 0) worker.outstanding_genomes[genome->get_generation_id()] = message;
 
                 //delete this genome as it will not be used again
                 delete genome;
             }
-        } else if (tag == GENOME_LENGTH_TAG) {
+        } else if (tag == GENOME_TAG) {
             cout << "[" << setw(10) << name << "] received genome from: " << source << endl;
-            RNN_Genome *genome = receive_genome_from(name, source);
+            RNN_Genome *genome = receive_genome_from(name, status, receive_buffer, search_comm);
+            worker.genomes_received++;
+            worker.outstanding_genomes.erase(genome->get_generation_id());
+            genomes_received++;
+
+            if (stopping) {
+                delete genome;
+                continue;
+            }
 
             examm_mutex.lock();
             examm->insert_genome(genome);
             examm_mutex.unlock();
 
-            //this genome will be deleted if/when removed from population
+            //the population keeps its own copy
+            delete genome;
+
+            if (hierarchical && genomes_received % migration_interval == 0) {
+                send_genome_to(name, 0, examm->get_best_genome(), MPI_COMM_WORLD, ELITE_TAG);
+                elites_sent++;
+            }
         } else {
             cerr << "[" << setw(10) << name << "] ERROR: received message with unknown tag: " << tag << endl;
             MPI_Abort(MPI_COMM_WORLD, 1);
         }
     }
+
+    if (reissued_genomes.size() > 0) {
+        cerr << "[" << setw(10) << name << "] " << reissued_genomes.size() << " genomes from failed workers were lost, there were no workers left to reissue them to" << endl;
+    }
+
+    //a failed worker which never asked for more work is still told to stop,
+    //in case it was only slow
+    for (int32_t i = 1; i < max_rank; i++) {
+        if (workers[i].failed && !workers[i].terminated) {
+            cout << "[" << setw(10) << name << "] terminating failed worker: " << i << endl;
+            send_terminate_message(i);
+            workers[i].terminated = true;
+        }
+    }
+
+    int32_t workers_failed = 0;
+    for (int32_t i = 1; i < max_rank; i++) {
+        if (workers[i].failed) workers_failed++;
+    }
+    if (workers_failed == max_rank - 1) {
+        cerr << "[" << setw(10) << name << "] ERROR: every worker failed before the search finished" << endl;
+    }
+
+    if (hierarchical) {
+        send_genome_to(name, 0, examm->get_best_genome(), MPI_COMM_WORLD, FINAL_ELITE_TAG);
+        receive_migrants(name, elites_sent, migrants_received, true, receive_buffer);
+    }
+
+    wait_for_sends();
+}
+
+//each sub-master gets its own range of innovation numbers
+int32_t get_innovation_offset(int32_t sub_master_index, int32_t number_sub_masters) {
+    return sub_master_index * (numeric_limits<int32_t>::max() / number_sub_masters);
+}
+
+//what the global master knows about the migration between the sub-masters
+class MigrationState {
+    public:
+        double best_fitness;
+
+        //by rank, the latest elite of each sub-master and how many elites
+        //and migrants have gone between it and the global master
+        vector<RNN_Genome*> elites;
+        vector<int64_t> elites_received;
+        vector<int64_t> migrants_sent;
+
+        //by sub-master index
+        vector<int32_t> innovation_offsets;
+
+        MigrationState(int max_rank, int32_t number_sub_masters) : best_fitness(EXAMM_MAX_DOUBLE), elites(max_rank, NULL), elites_received(max_rank, 0), migrants_sent(max_rank, 0) {
+            for (int32_t i = 0; i < number_sub_masters; i++) {
+                innovation_offsets.push_back(get_innovation_offset(i, number_sub_masters));
+            }
+        }
+
+        ~MigrationState() {
+            for (int32_t i = 0; i < (int32_t)elites.size(); i++) {
+                if (elites[i] != NULL) delete elites[i];
+            }
+        }
+
+        void write_checkpoint(string filename) {
+            ostringstream checkpoint;
+
+            int32_t version = EXAMM_CHECKPOINT_VERSION;
+            int32_t number_ranks = elites.size();
+            int32_t number_sub_masters = innovation_offsets.size();
+            checkpoint.write((char*)&version, sizeof(int32_t));
+            checkpoint.write((char*)&number_ranks, sizeof(int32_t));
+            checkpoint.write((char*)&number_sub_masters, sizeof(int32_t));
+            checkpoint.write((char*)&innovation_offsets[0], sizeof(int32_t) * number_sub_masters);
+            checkpoint.write((char*)&best_fitness, sizeof(double));
+
+            for (int32_t i = 0; i < number_ranks; i++) {
+                checkpoint.write((char*)&elites_received[i], sizeof(int64_t));
+                checkpoint.write((char*)&migrants_sent[i], sizeof(int64_t));
+
+                ostringstream genome_bytes;
+                if (elites[i] != NULL) elites[i]->write_to_stream(genome_bytes);
+                write_binary_string(checkpoint, genome_bytes.str(), "elite", false);
+            }
+
+            FileWriter::get_shared()->write(filename, checkpoint.str());
+            cout << "wrote global checkpoint to '" << filename << "'" << endl;
+        }
+
+        void read_checkpoint(string filename) {
+            ifstream infile(filename, ios::in | ios::binary);
+            if (!infile.good()) {
+                cerr << "ERROR: could not open global checkpoint '" << filename << "'" << endl;
+                exit(1);
+            }
+
+            infile.seekg(0, ios::end);
+            int64_t file_size = infile.tellg();
+            infile.seekg(0, ios::beg);
+
+            int32_t version, number_ranks, number_sub_masters;
+            infile.read((char*)&version, sizeof(int32_t));
+            check_checkpoint(infile, filename, "version");
+            infile.read((char*)&number_ranks, sizeof(int32_t));
+            check_checkpoint(infile, filename, "number of ranks");
+            infile.read((char*)&number_sub_masters, sizeof(int32_t));
+            check_checkpoint(infile, filename, "number of sub-masters");
+
+            if (version != EXAMM_CHECKPOINT_VERSION) {
+                cerr << "ERROR: global checkpoint '" << filename << "' has version " << version << ", expected " << EXAMM_CHECKPOINT_VERSION << endl;
+                exit(1);
+            }
+
+            if (number_ranks != (int32_t)elites.size() || number_sub_masters != (int32_t)innovation_offsets.size()) {
+                cerr << "ERROR: global checkpoint '" << filename << "' has " << number_ranks << " ranks and " << number_sub_masters << " sub-masters but the search has " << elites.size() << " and " << innovation_offsets.size() << endl;
+                exit(1);
+            }
+
+            vector<int32_t> checkpoint_offsets(number_sub_masters);
+            infile.read((char*)&checkpoint_offsets[0], sizeof(int32_t) * number_sub_masters);
+            check_checkpoint(infile, filename, "innovation offsets");
+
+            if (checkpoint_offsets != innovation_offsets) {
+                cerr << "ERROR: global checkpoint '" << filename << "' gives the sub-masters different innovation offsets than the search" << endl;
+                exit(1);
+            }
+
+            infile.read((char*)&best_fitness, sizeof(double));
+            check_checkpoint(infile, filename, "best fitness");
+
+            for (int32_t i = 0; i < number_ranks; i++) {
+                infile.read((char*)&elites_received[i], sizeof(int64_t));
+                check_checkpoint(infile, filename, "number of elites received");
+                infile.read((char*)&migrants_sent[i], sizeof(int64_t));
+                check_checkpoint(infile, filename, "number of migrants sent");
+
+                string genome_bytes;
+                read_checkpoint_string(infile, file_size, genome_bytes, filename, "elite");
+
+                if (elites[i] != NULL) delete elites[i];
+                elites[i] = NULL;
+
+                if (genome_bytes.size() > 0) {
+                    istringstream genome_iss(genome_bytes);
+                    elites[i] = new RNN_Genome(genome_iss);
+                }
+            }
+
+            cout << "resumed from global checkpoint '" << filename << "' with best fitness " << best_fitness << endl;
+        }
+};
+
+//the global master keeps the latest elite from each sub-master, writes out
+//the best of them, and answers each elite with the best of the others
+void global_master(int max_rank, int32_t number_sub_masters, string output_directory, bool resume) {
+    string name = "global";
+
+    if (output_directory != "") mkpath(output_directory.c_str(), 0777);
+
+    MigrationState state(max_rank, number_sub_masters);
+    vector<RNN_Genome*> &elites = state.elites;
+
+    string global_checkpoint_file = checkpoint_file + ".global";
+    if (resume) state.read_checkpoint(global_checkpoint_file);
+
+    int32_t sub_masters_finished = 0;
+    string receive_buffer;
+
+    std::chrono::time_point<std::chrono::steady_clock> last_checkpoint = std::chrono::steady_clock::now();
+
+    while (sub_masters_finished < number_sub_masters) {
+        //the sub-masters' checkpoints are written on their own, so a resumed
+        //search may get elites which are a little older than these
+        if (checkpoint_file != "") {
+            int signal = checkpoint_signal;
+            std::chrono::time_point<std::chrono::steady_clock> now = std::chrono::steady_clock::now();
+
+            if (signal != 0 || std::chrono::duration_cast<std::chrono::seconds>(now - last_checkpoint).count() >= checkpoint_interval) {
+                checkpoint_signal = 0;
+                state.write_checkpoint(global_checkpoint_file);
+                last_checkpoint = now;
+            }
+        }
+
+        MPI_Status status;
+        MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+
+        int source = status.MPI_SOURCE;
+        int tag = status.MPI_TAG;
+
+        if (tag != ELITE_TAG && tag != FINAL_ELITE_TAG) {
+            cerr << "[" << setw(10) << name << "] ERROR: received message with unknown tag: " << tag << endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+
+        RNN_Genome *elite = receive_genome_from(name, status, receive_buffer, MPI_COMM_WORLD);
+        state.elites_received[source]++;
+
+        if (elite != NULL) {
+            if (elites[source] != NULL) delete elites[source];
+            elites[source] = elite;
+
+            if (elite->get_fitness() < state.best_fitness) {
+                state.best_fitness = elite->get_fitness();
+                cout << "[" << setw(10) << name << "] new global best fitness: " << state.best_fitness << " from: " << source << endl;
+
+                if (output_directory != "") {
+                    ostringstream graphviz;
+                    elite->write_graphviz(graphviz);
+                    FileWriter::get_shared()->write(output_directory + "/global_best_genome.gv", graphviz.str());
+
+                    ostringstream genome_bytes;
+                    elite->write_to_stream(genome_bytes);
+                    FileWriter::get_shared()->write(output_directory + "/global_best_genome.bin", genome_bytes.str());
+                }
+            }
+        }
+
+        if (tag == FINAL_ELITE_TAG) {
+            sub_masters_finished++;
+            continue;
+        }
+
+        RNN_Genome *migrant = NULL;
+        for (int32_t i = 0; i < max_rank; i++) {
+            if (i == source || elites[i] == NULL) continue;
+            if (migrant == NULL || elites[i]->get_fitness() < migrant->get_fitness()) migrant = elites[i];
+        }
+        send_genome_to(name, source, migrant, MPI_COMM_WORLD, MIGRANT_TAG);
+        state.migrants_sent[source]++;
+    }
+
+    wait_for_sends();
+
+    if (checkpoint_file != "") state.write_checkpoint(global_checkpoint_file);
+
+    for (int32_t i = 0; i < max_rank; i++) {
+        if (state.elites_received[i] == 0) continue;
+        cout << "[" << setw(10) << name << "] rank " << i << " sent " << state.elites_received[i] << " elites and was sent " << state.migrants_sent[i] << " migrants" << endl;
+    }
+}
+
+//trains the genomes the worker's main thread has received, which is the
+//only thread making MPI calls
+void trainer_thread() {
+    while (true) {
+        RNN_Genome *genome = NULL;
+        {
+            unique_lock<mutex> lock(trainer_mutex);
+            genome_available.wait(lock, [] { return trainers_finished || !untrained_genomes.empty(); });
+            if (untrained_genomes.empty()) return;
+
+            genome = untrained_genomes.front();
+            untrained_genomes.pop_front();
+        }
+
+        //the search settings aren't part of the genome files sent over
+        genome->set_truncated_bptt(bptt_window, bptt_stride);
+        genome->backpropagate_stochastic(training_inputs, training_outputs, validation_inputs, validation_outputs);
+
+        {
+            lock_guard<mutex> lock(trainer_mutex);
+            trained_genomes.push_back(genome);
+        }
+        genome_trained.notify_one();
+    }
 }
 
 void worker(int rank) {
     string name = "worker_" + to_string(rank);
 
-    while (true) {
-        cout << "[" << setw(10) << name << "] sending work request!" << endl;
+    //ask for the prefetched genomes up front, after that a genome is asked
+    //for each time one is finished, so the next is already here by then
+    for (int32_t i = 0; i < worker_threads * (1 + prefetch_depth); i++) {
         send_work_request(0);
-        cout << "[" << setw(10) << name << "] sent work request!" << endl;
+    }
+
+    vector<thread> trainers;
+    for (int32_t i = 0; i < worker_threads; i++) {
+        trainers.push_back( thread(trainer_thread) );
+    }
+
+    string receive_buffer;
+    bool terminated = false;
+    int32_t genomes_in_progress = 0;
+
+    //genomes queued before the terminate message still need to be trained
+    //and sent back
+    while (!terminated || genomes_in_progress > 0) {
+        deque<RNN_Genome*> finished_genomes;
+        {
+            lock_guard<mutex> lock(trainer_mutex);
+            finished_genomes.swap(trained_genomes);
+        }
+
+        for (int32_t i = 0; i < (int32_t)finished_genomes.size(); i++) {
+            //the result is sent in the background while the next genome is trained
+            send_genome_to(name, 0, finished_genomes[i], search_comm, GENOME_TAG);
+            send_work_request(0);
+
+            delete finished_genomes[i];
+            genomes_in_progress--;
+        }
 
+        int arrived = 0;
         MPI_Status status;
-        MPI_Probe(0, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+        if (!terminated) MPI_Iprobe(0, MPI_ANY_TAG, search_comm, &arrived, &status);
+
+        if (!arrived) {
+            //nothing to do until a genome is trained or another message
+            //arrives, which is polled for every millisecond
+            unique_lock<mutex> lock(trainer_mutex);
+            genome_trained.wait_for(lock, std::chrono::milliseconds(1), [] { return !trained_genomes.empty(); });
+            continue;
+        }
+
         int tag = status.MPI_TAG;
 
         cout << "[" << setw(10) << name << "] probe received message with tag: " << tag << endl;
@@ -190,45 +833,61 @@ void worker(int rank) {
         if (tag == TERMINATE_TAG) {
             cout << "[" << setw(10) << name << "] received terminate tag!" << endl;
             receive_terminate_message(0);
-            break;
+            terminated = true;
 
-        } else if (tag == GENOME_LENGTH_TAG) {
+        } else if (tag == GENOME_TAG) {
             cout << "[" << setw(10) << name << "] received genome!" << endl;
-            RNN_Genome* genome = receive_genome_from(name, 0);
-
-            genome->backpropagate_stochastic(training_inputs, training_outputs, validation_inputs, validation_outputs);
+            RNN_Genome* genome = receive_genome_from(name, status, receive_buffer, search_comm);
+            genomes_in_progress++;
 
-            send_genome_to(name, 0, genome);
-
-            delete genome;
+            {
+                lock_guard<mutex> lock(trainer_mutex);
+                untrained_genomes.push_back(genome);
+            }
+            genome_available.notify_one();
         } else {
             cerr << "[" << setw(10) << name << "] ERROR: received message with unknown tag: " << tag << endl;
             MPI_Abort(MPI_COMM_WORLD, 1);
         }
     }
+
+    {
+        lock_guard<mutex> lock(trainer_mutex);
+        trainers_finished = true;
+    }
+    genome_available.notify_all();
+
+    for (int32_t i = 0; i < (int32_t)trainers.size(); i++) {
+        trainers[i].join();
+    }
+
+    wait_for_sends();
 }
 
 int main(int argc, char** argv) {
-    MPI_Init(&argc, &argv);
+    //the worker's trainer threads never make MPI calls
+    int thread_support;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_support);
 
     int rank, max_rank;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &max_rank);
 
+    //but the main thread makes them while the trainers run, which needs at least this
+    if (thread_support < MPI_THREAD_FUNNELED) {
+        if (rank == 0) cerr << "ERROR: examm_mpi needs an MPI library with at least MPI_THREAD_FUNNELED thread support, but this one only provides level " << thread_support << endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
     arguments = vector<string>(argv, argv + argc);
 
-    TimeSeriesSets *time_series_sets = NULL;
-    if (rank == 0) {
-        //only have the master process print TSS info
-        time_series_sets = TimeSeriesSets::generate_from_arguments(arguments, true);
+    //only have the master process print TSS info
+    TimeSeriesSets *time_series_sets = generate_node_shared_time_series_sets(arguments, rank == 0);
 
-        if (argument_exists(arguments, "--write_time_series")) {
-            string base_filename;
-            get_argument(arguments, "--write_time_series", true, base_filename);
-            time_series_sets->write_time_series_sets(base_filename);
-        }
-    } else {
-        time_series_sets = TimeSeriesSets::generate_from_arguments(arguments, false);
+    if (rank == 0 && argument_exists(arguments, "--write_time_series")) {
+        string base_filename;
+        get_argument(arguments, "--write_time_series", true, base_filename);
+        time_series_sets->write_time_series_sets(base_filename);
     }
 
     int32_t time_offset = 1;
@@ -240,6 +899,11 @@ int main(int argc, char** argv) {
     int number_inputs = time_series_sets->get_number_inputs();
     int number_outputs = time_series_sets->get_number_outputs();
 
+    input_parameter_names = time_series_sets->get_input_parameter_names();
+    output_parameter_names = time_series_sets->get_output_parameter_names();
+    normalize_mins = time_series_sets->get_normalize_mins();
+    normalize_maxs = time_series_sets->get_normalize_maxs();
+
     cout << "number_inputs: " << number_inputs << ", number_outputs: " << number_outputs << endl;
 
     int32_t population_size;
@@ -296,7 +960,128 @@ int main(int argc, char** argv) {
     double baseline_pheromone = 0;
     get_argument(arguments, "--rec_depth_pheromone_baseline", false, baseline_pheromone);
 
-    if (rank == 0) {
+    if (get_argument(arguments, "--bptt_window", false, bptt_window)) {
+        bptt_stride = bptt_window;
+        get_argument(arguments, "--bptt_stride", false, bptt_stride);
+    }
+
+    get_argument(arguments, "--early_stop_grace", false, early_stop_grace);
+
+    get_argument(arguments, "--prefetch_depth", false, prefetch_depth);
+    if (prefetch_depth < 0) {
+        cerr << "ERROR: --prefetch_depth must be 0 or more, was: " << prefetch_depth << endl;
+        exit(1);
+    }
+
+    get_argument(arguments, "--worker_threads", false, worker_threads);
+    if (worker_threads < 1) {
+        cerr << "ERROR: --worker_threads must be at least 1, was: " << worker_threads << endl;
+        exit(1);
+    }
+
+    get_argument(arguments, "--worker_timeout", false, worker_timeout);
+    if (worker_timeout < 0) {
+        cerr << "ERROR: --worker_timeout must be 0 or more, was: " << worker_timeout << endl;
+        exit(1);
+    }
+
+    double halving_bp_fraction = 0.0;
+    get_argument(arguments, "--halving_bp_fraction", false, halving_bp_fraction);
+
+    double halving_series_fraction = 1.0;
+    get_argument(arguments, "--halving_series_fraction", false, halving_series_fraction);
+
+    double halving_promote_fraction = 0.5;
+    get_argument(arguments, "--halving_promote_fraction", false, halving_promote_fraction);
+
+    int32_t halving_rung_size = 4;
+    get_argument(arguments, "--halving_rung_size", false, halving_rung_size);
+
+    get_argument(arguments, "--checkpoint_file", false, checkpoint_file);
+    get_argument(arguments, "--checkpoint_interval", false, checkpoint_interval);
+    bool resume = argument_exists(arguments, "--resume");
+
+    if (resume && checkpoint_file == "") {
+        cerr << "ERROR: --resume requires a --checkpoint_file to resume from" << endl;
+        exit(1);
+    }
+
+    hierarchical = argument_exists(arguments, "--hierarchical");
+    get_argument(arguments, "--migration_interval", false, migration_interval);
+
+    //0 groups the ranks on each node
+    int32_t group_size = 0;
+    get_argument(arguments, "--group_size", false, group_size);
+
+    if (hierarchical && migration_interval < 1) {
+        cerr << "ERROR: --migration_interval must be at least 1, was: " << migration_interval << endl;
+        exit(1);
+    }
+
+    bool runs_search = (rank == 0);
+    int32_t number_sub_masters = 0;
+    int32_t sub_master_index = -1;
+
+    if (hierarchical) {
+        int color = MPI_UNDEFINED;
+        if (group_size > 0) {
+            if (rank > 0) color = (rank - 1) / group_size;
+        } else {
+            MPI_Comm node_comm;
+            MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+
+            //the lowest rank on the node names the group
+            int node_leader = rank;
+            MPI_Bcast(&node_leader, 1, MPI_INT, 0, node_comm);
+            MPI_Comm_free(&node_comm);
+
+            if (rank > 0) color = node_leader;
+        }
+        MPI_Comm_split(MPI_COMM_WORLD, color, rank, &search_comm);
+
+        int group_rank = -1;
+        int group_ranks = 0;
+        if (search_comm != MPI_COMM_NULL) {
+            MPI_Comm_rank(search_comm, &group_rank);
+            MPI_Comm_size(search_comm, &group_ranks);
+        }
+
+        //the lowest rank of each group is its sub-master
+        vector<int> is_sub_master(max_rank);
+        int this_is_sub_master = (group_rank == 0);
+        MPI_Allgather(&this_is_sub_master, 1, MPI_INT, is_sub_master.data(), 1, MPI_INT, MPI_COMM_WORLD);
+
+        for (int32_t i = 0; i < max_rank; i++) {
+            if (i == rank && is_sub_master[i]) sub_master_index = number_sub_masters;
+            if (is_sub_master[i]) number_sub_masters++;
+        }
+
+        if (number_sub_masters == 0 || number_sub_masters > number_islands) {
+            if (rank == 0) cerr << "ERROR: a hierarchical search needs between 1 and number_islands (" << number_islands << ") sub-masters, but the ranks make " << number_sub_masters << " groups" << endl;
+            MPI_Finalize();
+            exit(1);
+        }
+
+        if (group_rank == 0 && group_ranks < 2) {
+            cerr << "ERROR: the sub-master on rank " << rank << " has no workers, use a larger --group_size" << endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+
+        runs_search = (sub_master_index >= 0);
+
+        if (runs_search) {
+            //each sub-master searches its share of the islands and genomes,
+            //with its own range of innovation numbers and output directory
+            number_islands = number_islands / number_sub_masters + (sub_master_index < number_islands % number_sub_masters ? 1 : 0);
+            max_genomes = max_genomes / number_sub_masters + (sub_master_index < max_genomes % number_sub_masters ? 1 : 0);
+            if (checkpoint_file != "") checkpoint_file += "." + to_string(sub_master_index);
+        }
+    }
+
+    if (runs_search) {
+        string search_output_directory = output_directory;
+        if (hierarchical && output_directory != "") search_output_directory = output_directory + "/sub_master_" + to_string(sub_master_index);
+
         examm = new EXAMM(population_size, number_islands, max_genomes, num_genomes_check_on_island, check_on_island_method,
             time_series_sets->get_input_parameter_names(), 
             time_series_sets->get_output_parameter_names(),
@@ -309,19 +1094,45 @@ int main(int argc, char** argv) {
             rec_delay_min, rec_delay_max,
             decay_rate, baseline_pheromone,
             rec_sampling_population, rec_sampling_distribution,
-            output_directory);
+            search_output_directory);
 
         if (possible_node_types.size() > 0) examm->set_possible_node_types(possible_node_types);
+        examm->set_early_stop_grace(early_stop_grace);
+        examm->set_successive_halving(halving_bp_fraction, halving_series_fraction, halving_promote_fraction, halving_rung_size);
+        if (hierarchical) examm->set_innovation_offset(get_innovation_offset(sub_master_index, number_sub_masters));
+
+        if (resume) examm->read_checkpoint(checkpoint_file);
 
-        master(max_rank);
+        if (checkpoint_file != "") {
+            std::signal(SIGUSR1, checkpoint_signal_handler);
+            std::signal(SIGTERM, checkpoint_signal_handler);
+        }
+
+        int search_ranks;
+        MPI_Comm_size(search_comm, &search_ranks);
+        master(search_ranks);
     } else {
-        worker(rank);
+        //the masters stop their workers after a SIGTERM, so the other ranks
+        //ignore the one mpirun forwards to them
+        if (checkpoint_file != "") std::signal(SIGTERM, SIG_IGN);
+
+        if (hierarchical && rank == 0) {
+            if (checkpoint_file != "") std::signal(SIGUSR1, checkpoint_signal_handler);
+            global_master(max_rank, number_sub_masters, output_directory, resume);
+        } else {
+            if (checkpoint_file != "") std::signal(SIGUSR1, SIG_IGN);
+            worker(rank);
+        }
     }
 
+    if (search_comm != MPI_COMM_WORLD && search_comm != MPI_COMM_NULL) MPI_Comm_free(&search_comm);
+
     finished = true;
 
     cout << "rank " << rank << " completed!" << endl;
 
+    free_node_shared_time_series_sets(time_series_sets);
+
     MPI_Finalize();
 
     return 0;
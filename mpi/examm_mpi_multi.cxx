@@ -32,6 +32,8 @@ using std::vector;
 
 #include "time_series/time_series.hxx"
 
+#include "shared_time_series.hxx"
+
 #define WORK_REQUEST_TAG 1
 #define GENOME_LENGTH_TAG 2
 #define GENOME_TAG 3
@@ -43,10 +45,10 @@ vector<string> arguments;
 
 EXAMM *examm;
 
-vector< vector< vector<double> > > training_inputs;
-vector< vector< vector<double> > > training_outputs;
-vector< vector< vector<double> > > validation_inputs;
-vector< vector< vector<double> > > validation_outputs;
+SeriesViews training_inputs;
+SeriesViews training_outputs;
+SeriesViews validation_inputs;
+SeriesViews validation_outputs;
 
 void send_work_request(int target) {
     int work_request_message[1];
@@ -255,12 +257,8 @@ int main(int argc, char** argv) {
 
     TimeSeriesSets *time_series_sets = NULL;
     
-    if (rank == 0) {
-        //only have the master process be verbose
-        time_series_sets = TimeSeriesSets::generate_from_arguments(arguments, true);
-    } else {
-        time_series_sets = TimeSeriesSets::generate_from_arguments(arguments, false);
-    }
+    //only have the master process be verbose
+    time_series_sets = generate_node_shared_time_series_sets(arguments, rank == 0);
 
     int32_t time_offset = 1;
     get_argument(arguments, "--time_offset", true, time_offset);
@@ -365,6 +363,8 @@ int main(int argc, char** argv) {
         slice_times_file.close();
     }
 
+    free_node_shared_time_series_sets(time_series_sets);
+
     MPI_Finalize();
 
     return 0;
@@ -46,6 +46,8 @@ typedef struct stat Stat;
 
 #include "time_series/time_series.hxx"
 
+#include "shared_time_series.hxx"
+
 #define WORK_REQUEST_TAG 1
 #define JOB_TAG 2
 #define TERMINATE_TAG 3
@@ -213,6 +215,127 @@ int mkpath(const char *path, mode_t mode) {
 
 
 
+RNN_Genome* create_genome(string rnn_type, int number_inputs, int number_outputs) {
+    RNN_Genome *genome = NULL;
+    if (rnn_type == "one_layer_lstm") {
+        genome = create_lstm(number_inputs, 1, number_inputs, number_outputs, 1);
+
+    } else if (rnn_type == "two_layer_lstm") {
+        genome = create_lstm(number_inputs, 2, number_inputs, number_outputs, 1);
+
+    } else if (rnn_type == "one_layer_delta") {
+        genome = create_delta(number_inputs, 1, number_inputs, number_outputs, 1);
+
+    } else if (rnn_type == "two_layer_delta") {
+        genome = create_delta(number_inputs, 2, number_inputs, number_outputs, 1);
+
+    } else if (rnn_type == "one_layer_gru") {
+        genome = create_gru(number_inputs, 1, number_inputs, number_outputs, 1);
+
+    } else if (rnn_type == "two_layer_gru") {
+        genome = create_gru(number_inputs, 2, number_inputs, number_outputs, 1);
+
+    } else if (rnn_type == "one_layer_mgu") {
+        genome = create_mgu(number_inputs, 1, number_inputs, number_outputs, 1);
+
+    } else if (rnn_type == "two_layer_mgu") {
+        genome = create_mgu(number_inputs, 2, number_inputs, number_outputs, 1);
+
+    } else if (rnn_type == "one_layer_delta") {
+        genome = create_delta(number_inputs, 1, number_inputs, number_outputs, 1);
+
+    } else if (rnn_type == "two_layer_delta") {
+        genome = create_delta(number_inputs, 2, number_inputs, number_outputs, 1);
+
+    } else if (rnn_type == "one_layer_ugrnn") {
+        genome = create_ugrnn(number_inputs, 1, number_inputs, number_outputs, 1);
+
+    } else if (rnn_type == "two_layer_ugrnn") {
+        genome = create_ugrnn(number_inputs, 2, number_inputs, number_outputs, 1);
+
+    } else if (rnn_type == "one_layer_ff") {
+        genome = create_ff(number_inputs, 1, number_inputs, number_outputs, 0);
+
+    } else if (rnn_type == "two_layer_ff") {
+        genome = create_ff(number_inputs, 2, number_inputs, number_outputs, 0);
+
+    } else if (rnn_type == "jordan") {
+        genome = create_jordan(number_inputs, 1, number_inputs, number_outputs, 1);
+
+    } else if (rnn_type == "elman") {
+        genome = create_elman(number_inputs, 1, number_inputs, number_outputs, 1);
+    }
+
+    return genome;
+}
+
+//jobs are handed out longest first, so the sweep doesn't end with a few
+//workers still training the largest networks. a job's cost is estimated as
+//the number of weights times the number of training rows, which is scaled
+//by the milliseconds per unit of cost measured for that rnn type as results
+//come in (or over all types, if none of that type have finished yet).
+vector<double> job_costs;
+vector<double> rnn_milliseconds;
+vector<double> rnn_costs;
+
+void estimate_job_costs(int32_t number_jobs) {
+    int32_t number_folds = time_series_sets->get_number_series() / fold_size;
+    int32_t jobs_per_rnn = number_folds * repeats;
+
+    int32_t total_rows = 0;
+    vector<int32_t> fold_rows(number_folds, 0);
+    for (int32_t i = 0; i < number_folds * fold_size; i++) {
+        int32_t rows = time_series_sets->get_number_rows(i) - time_offset;
+        fold_rows[i / fold_size] += rows;
+        total_rows += rows;
+    }
+
+    vector<int32_t> rnn_weights;
+    for (int32_t i = 0; i < (int32_t)rnn_types.size(); i++) {
+        RNN_Genome *genome = create_genome(rnn_types[i], time_series_sets->get_number_inputs(), time_series_sets->get_number_outputs());
+        rnn_weights.push_back(genome->get_number_weights());
+        delete genome;
+    }
+
+    job_costs.resize(number_jobs);
+    for (int32_t job = 0; job < number_jobs; job++) {
+        int32_t j = (job % jobs_per_rnn) / repeats;
+        job_costs[job] = (double)rnn_weights[job / jobs_per_rnn] * (total_rows - fold_rows[j]);
+    }
+
+    rnn_milliseconds.assign(rnn_types.size(), 0.0);
+    rnn_costs.assign(rnn_types.size(), 0.0);
+}
+
+double predict_milliseconds(int32_t job, int32_t jobs_per_rnn) {
+    int32_t rnn = job / jobs_per_rnn;
+    if (rnn_costs[rnn] > 0) return job_costs[job] * rnn_milliseconds[rnn] / rnn_costs[rnn];
+
+    double total_milliseconds = 0.0, total_cost = 0.0;
+    for (int32_t i = 0; i < (int32_t)rnn_types.size(); i++) {
+        total_milliseconds += rnn_milliseconds[i];
+        total_cost += rnn_costs[i];
+    }
+    if (total_cost > 0) return job_costs[job] * total_milliseconds / total_cost;
+
+    return job_costs[job];
+}
+
+int32_t next_job(const vector<bool> &dispatched, int32_t jobs_per_rnn) {
+    int32_t longest_job = -1;
+    double longest_milliseconds = 0.0;
+    for (int32_t job = 0; job < (int32_t)dispatched.size(); job++) {
+        if (dispatched[job]) continue;
+
+        double milliseconds = predict_milliseconds(job, jobs_per_rnn);
+        if (longest_job < 0 || milliseconds > longest_milliseconds) {
+            longest_job = job;
+            longest_milliseconds = milliseconds;
+        }
+    }
+    return longest_job;
+}
+
 void master(int max_rank) {
     process_name = "master";
 
@@ -227,8 +350,12 @@ void master(int max_rank) {
     results = vector<ResultSet>(rnn_types.size() * time_series_sets->get_number_series() * repeats, {-1, 0.0, 0.0, 0.0, 0.0, 0});
 
     int terminates_sent = 0;
-    int current_job = 0;
+    int jobs_sent = 0;
     int last_job = rnn_types.size() * (time_series_sets->get_number_series() / fold_size) * repeats;
+    int32_t jobs_per_rnn = (time_series_sets->get_number_series() / fold_size) * repeats;
+
+    estimate_job_costs(last_job);
+    vector<bool> dispatched(last_job, false);
 
     while (true) {
         //wait for a incoming message
@@ -244,10 +371,8 @@ void master(int max_rank) {
         if (tag == WORK_REQUEST_TAG) {
             receive_work_request_from(message_source);
 
-            if (current_job >= last_job) {
-//            if (current_job >= results.size()) {
-                //no more jobs to process if the current job is >= the result vector
-                //send terminate message
+            if (jobs_sent >= last_job) {
+                //no more jobs to process, send terminate message
                 cout << "[" << setw(10) << process_name << "] terminating worker: " << message_source << endl;
                 send_terminate_to(message_source);
                 terminates_sent++;
@@ -256,25 +381,28 @@ void master(int max_rank) {
                 if (terminates_sent >= max_rank - 1) return;
 
             } else {
-                //send job
-                cout << "[" << setw(10) << process_name << "] sending job to: " << message_source << endl;
+                //send the longest remaining job
+                int32_t current_job = next_job(dispatched, jobs_per_rnn);
+                cout << "[" << setw(10) << process_name << "] sending job to: " << message_source << ", predicted millis: " << predict_milliseconds(current_job, jobs_per_rnn) << endl;
                 send_job_to(message_source, current_job);
 
-                //increment the current job for the next worker
-                current_job++;
+                dispatched[current_job] = true;
+                jobs_sent++;
             }
         } else if (tag == RESULT_TAG) {
             cout << "[" << setw(10) << process_name << "] receiving job from: " << message_source << endl;
             ResultSet result = receive_result_from(message_source);
             results[result.job] = result;
 
-            //TODO:
-            //check and see if this particular set of jobs for rnn_type has completed,
-            //then write the file for that type if it has
-            int32_t jobs_per_rnn = (time_series_sets->get_number_series() / fold_size) * repeats;
-
             //get the particular rnn type this job was for, and which results should be there
             int32_t rnn = result.job / jobs_per_rnn;
+
+            cout << "[" << setw(10) << process_name << "] job " << result.job << " took " << result.milliseconds << " millis, predicted: " << predict_milliseconds(result.job, jobs_per_rnn) << endl;
+            rnn_milliseconds[rnn] += result.milliseconds;
+            rnn_costs[rnn] += job_costs[result.job];
+
+            //check and see if this particular set of jobs for rnn_type has completed,
+            //then write the file for that type if it has
             int32_t rnn_job_start = rnn * jobs_per_rnn;
             int32_t rnn_job_end = (rnn + 1) * jobs_per_rnn;
 
@@ -348,10 +476,10 @@ ResultSet handle_job(int current_job) {
     time_series_sets->set_training_indexes(training_indexes);
     time_series_sets->set_test_indexes(test_indexes);
 
-    vector< vector< vector<double> > > training_inputs;
-    vector< vector< vector<double> > > training_outputs;
-    vector< vector< vector<double> > > validation_inputs;
-    vector< vector< vector<double> > > validation_outputs;
+    SeriesViews training_inputs;
+    SeriesViews training_outputs;
+    SeriesViews validation_inputs;
+    SeriesViews validation_outputs;
 
     time_series_sets->export_training_series(time_offset, training_inputs, training_outputs);
     time_series_sets->export_test_series(time_offset, validation_inputs, validation_outputs);
@@ -359,55 +487,7 @@ ResultSet handle_job(int current_job) {
     int number_inputs = time_series_sets->get_number_inputs();
     int number_outputs = time_series_sets->get_number_outputs();
 
-    RNN_Genome *genome = NULL;
-    if (rnn_type == "one_layer_lstm") {
-        genome = create_lstm(number_inputs, 1, number_inputs, number_outputs, 1);
-
-    } else if (rnn_type == "two_layer_lstm") {
-        genome = create_lstm(number_inputs, 2, number_inputs, number_outputs, 1);
-
-    } else if (rnn_type == "one_layer_delta") {
-        genome = create_delta(number_inputs, 1, number_inputs, number_outputs, 1);
-
-    } else if (rnn_type == "two_layer_delta") {
-        genome = create_delta(number_inputs, 2, number_inputs, number_outputs, 1);
-
-    } else if (rnn_type == "one_layer_gru") {
-        genome = create_gru(number_inputs, 1, number_inputs, number_outputs, 1);
-
-    } else if (rnn_type == "two_layer_gru") {
-        genome = create_gru(number_inputs, 2, number_inputs, number_outputs, 1);
-
-    } else if (rnn_type == "one_layer_mgu") {
-        genome = create_mgu(number_inputs, 1, number_inputs, number_outputs, 1);
-
-    } else if (rnn_type == "two_layer_mgu") {
-        genome = create_mgu(number_inputs, 2, number_inputs, number_outputs, 1);
-
-    } else if (rnn_type == "one_layer_delta") {
-        genome = create_delta(number_inputs, 1, number_inputs, number_outputs, 1);
-
-    } else if (rnn_type == "two_layer_delta") {
-        genome = create_delta(number_inputs, 2, number_inputs, number_outputs, 1);
-
-    } else if (rnn_type == "one_layer_ugrnn") {
-        genome = create_ugrnn(number_inputs, 1, number_inputs, number_outputs, 1);
-
-    } else if (rnn_type == "two_layer_ugrnn") {
-        genome = create_ugrnn(number_inputs, 2, number_inputs, number_outputs, 1);
-
-    } else if (rnn_type == "one_layer_ff") {
-        genome = create_ff(number_inputs, 1, number_inputs, number_outputs, 0);
-
-    } else if (rnn_type == "two_layer_ff") {
-        genome = create_ff(number_inputs, 2, number_inputs, number_outputs, 0);
-
-    } else if (rnn_type == "jordan") {
-        genome = create_jordan(number_inputs, 1, number_inputs, number_outputs, 1);
-
-    } else if (rnn_type == "elman") {
-        genome = create_elman(number_inputs, 1, number_inputs, number_outputs, 1);
-    }
+    RNN_Genome *genome = create_genome(rnn_type, number_inputs, number_outputs);
 
     RNN* rnn = genome->get_rnn();
 
@@ -526,12 +606,8 @@ int main(int argc, char **argv) {
     get_argument(arguments, "--fold_size", true, fold_size);
 
 
-    if (rank == 0) {
-        //only print verbose info from the master process
-        time_series_sets = TimeSeriesSets::generate_from_arguments(arguments, true);
-    } else {
-        time_series_sets = TimeSeriesSets::generate_from_arguments(arguments, false);
-    }
+    //only print verbose info from the master process
+    time_series_sets = generate_node_shared_time_series_sets(arguments, rank == 0);
 
     //MPI_Barrier(MPI_COMM_WORLD);
 
@@ -541,5 +617,7 @@ int main(int argc, char **argv) {
         worker(rank);
     }
 
+    free_node_shared_time_series_sets(time_series_sets);
+
     MPI_Finalize();
 }
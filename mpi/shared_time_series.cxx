@@ -0,0 +1,135 @@
+#include <cstring>
+
+#include <iostream>
+using std::ios_base;
+using std::istream;
+
+#include <sstream>
+using std::ostringstream;
+
+#include <streambuf>
+using std::streambuf;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "mpi.h"
+
+#include "common/arguments.hxx"
+
+#include "shared_time_series.hxx"
+#include "time_series/time_series.hxx"
+
+//reads straight out of the shared window without copying it first. the
+//series seek past their values (and tell where they are) when they are used
+//in place, so this has to be seekable.
+class WindowBuffer : public streambuf {
+    public:
+        WindowBuffer(char *bytes, int64_t length) {
+            setg(bytes, bytes, bytes + length);
+        }
+
+    protected:
+        pos_type seekoff(off_type offset, ios_base::seekdir direction, ios_base::openmode which) {
+            char *position = gptr();
+            if (direction == ios_base::beg) position = eback() + offset;
+            else if (direction == ios_base::cur) position = gptr() + offset;
+            else if (direction == ios_base::end) position = egptr() + offset;
+
+            if (position < eback() || position > egptr()) return pos_type(off_type(-1));
+
+            setg(eback(), position, egptr());
+            return pos_type(position - eback());
+        }
+
+        pos_type seekpos(pos_type position, ios_base::openmode which) {
+            return seekoff(off_type(position), ios_base::beg, which);
+        }
+};
+
+//the window the sets were read from, whose memory their series point into
+static MPI_Win shared_window = MPI_WIN_NULL;
+static MPI_Comm shared_node_comm = MPI_COMM_NULL;
+
+TimeSeriesSets* generate_node_shared_time_series_sets(const vector<string> &arguments, bool verbose) {
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+
+    int node_rank;
+    MPI_Comm_rank(node_comm, &node_rank);
+
+    TimeSeriesSets *time_series_sets = NULL;
+
+    if (argument_exists(arguments, "--stream_time_series")) {
+        //the ranks each map the cache, which the OS only keeps one copy of.
+        //the lowest rank goes first so it can (re)write the cache if needed.
+        if (node_rank == 0) time_series_sets = TimeSeriesSets::generate_from_arguments(arguments, verbose);
+        MPI_Barrier(node_comm);
+        if (node_rank != 0) time_series_sets = TimeSeriesSets::generate_from_arguments(arguments, false);
+
+        MPI_Comm_free(&node_comm);
+        return time_series_sets;
+    }
+
+    string bytes;
+    long long length = 0;
+
+    if (node_rank == 0) {
+        time_series_sets = TimeSeriesSets::generate_from_arguments(arguments, verbose);
+
+        //aligned so the values can be used where they are in the window
+        ostringstream out;
+        time_series_sets->write_to_stream(out, true);
+        bytes = out.str();
+        length = bytes.size();
+
+        //the lowest rank uses the window like the others, so there is only
+        //one copy of the values on the node
+        delete time_series_sets;
+    }
+    MPI_Bcast(&length, 1, MPI_LONG_LONG, 0, node_comm);
+
+    char *window_bytes;
+    MPI_Win window;
+    MPI_Win_allocate_shared(node_rank == 0 ? length : 0, 1, MPI_INFO_NULL, node_comm, &window_bytes, &window);
+
+    MPI_Win_fence(0, window);
+    if (node_rank == 0) memcpy(window_bytes, bytes.data(), length);
+    MPI_Win_fence(0, window);
+
+    bytes.clear();
+    bytes.shrink_to_fit();
+
+    MPI_Aint segment_length;
+    int displacement_unit;
+    char *segment;
+    MPI_Win_shared_query(window, 0, &segment_length, &displacement_unit, &segment);
+
+    WindowBuffer buffer(segment, segment_length);
+    istream in(&buffer);
+
+    time_series_sets = new TimeSeriesSets();
+    time_series_sets->read_from_stream(in, true, segment);
+
+    //the window is only written before this, so nothing else needs to be
+    //synchronized while it is read
+    shared_window = window;
+    shared_node_comm = node_comm;
+
+    return time_series_sets;
+}
+
+void free_node_shared_time_series_sets(TimeSeriesSets *time_series_sets) {
+    delete time_series_sets;
+
+    if (shared_window != MPI_WIN_NULL) {
+        MPI_Win_free(&shared_window);
+        MPI_Comm_free(&shared_node_comm);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef EXAMM_SHARED_TIME_SERIES_HXX
+#define EXAMM_SHARED_TIME_SERIES_HXX
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "time_series/time_series.hxx"
+
+//loads the time series sets once per node instead of once per rank. the
+//lowest rank on each node parses (and normalizes) the files as
+//TimeSeriesSets::generate_from_arguments does, and writes them into an MPI
+//shared memory window which the series of every rank on the node then use
+//in place. with --stream_time_series each rank maps the cache instead. this
+//must be called by every rank in MPI_COMM_WORLD.
+TimeSeriesSets* generate_node_shared_time_series_sets(const vector<string> &arguments, bool verbose);
+
+//deletes the sets and frees the window they were read from. like the
+//above, every rank has to call this (before MPI_Finalize).
+void free_node_shared_time_series_sets(TimeSeriesSets *time_series_sets);
+
+#endif
@@ -1,5 +1,10 @@
+#include <atomic>
+using std::atomic;
+
 #include <chrono>
 
+#include <csignal>
+
 #include <condition_variable>
 using std::condition_variable;
 
@@ -11,9 +16,6 @@ using std::cerr;
 using std::cout;
 using std::endl;
 
-#include <mutex>
-using std::mutex;
-
 #include <string>
 using std::string;
 
@@ -24,54 +26,86 @@ using std::thread;
 using std::vector;
 
 #include "common/arguments.hxx"
+#include "common/file_writer.hxx"
 
 #include "rnn/examm.hxx"
 #include "rnn/rec_depth_dist.hxx"
 #include "time_series/time_series.hxx"
 
 
-mutex examm_mutex;
-
 vector<string> arguments;
 
 EXAMM *examm;
 
 
-bool finished = false;
+atomic<bool> finished(false);
+
+
+SeriesViews training_inputs;
+SeriesViews training_outputs;
+SeriesViews validation_inputs;
+SeriesViews validation_outputs;
+
+//truncated backpropagation through time is off with a window of 0
+int32_t bptt_window = 0;
+int32_t bptt_stride = 0;
+
+//genomes are never stopped early with a grace period of 0
+int32_t early_stop_grace = 0;
+
+string checkpoint_file = "";
+int32_t checkpoint_interval = 300;
 
+//set by SIGUSR1 (write a checkpoint) or SIGTERM (write a checkpoint and exit)
+volatile sig_atomic_t checkpoint_signal = 0;
 
-vector< vector< vector<double> > > training_inputs;
-vector< vector< vector<double> > > training_outputs;
-vector< vector< vector<double> > > validation_inputs;
-vector< vector< vector<double> > > validation_outputs;
+void checkpoint_signal_handler(int signal) {
+    checkpoint_signal = signal;
+}
+
+void checkpoint_thread() {
+    std::chrono::time_point<std::chrono::steady_clock> last_checkpoint = std::chrono::steady_clock::now();
+
+    while (!finished) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        int signal = checkpoint_signal;
+        std::chrono::time_point<std::chrono::steady_clock> now = std::chrono::steady_clock::now();
+        if (signal == 0 && std::chrono::duration_cast<std::chrono::seconds>(now - last_checkpoint).count() < checkpoint_interval) continue;
+
+        checkpoint_signal = 0;
+        examm->write_checkpoint(checkpoint_file);
+        last_checkpoint = now;
+
+        if (signal == SIGTERM) {
+            //make sure the checkpoint is on disk before terminating
+            FileWriter::get_shared()->flush();
+            cout << "terminating after writing checkpoint" << endl;
+            std::signal(SIGTERM, SIG_DFL);
+            std::raise(SIGTERM);
+        }
+    }
+}
 
 
 void examm_thread(int id) {
 
+    //EXAMM locks its own islands, so threads only wait on each other
+    //when they generate from or insert into the same island
     while (true) {
-        examm_mutex.lock();
         RNN_Genome *genome = examm->generate_genome();
-        examm_mutex.unlock();
-        
-        double prev_fitness = genome->get_fitness();
 
         if (genome == NULL) break;  //generate_individual returns NULL when the search is done
 
+        double prev_fitness = genome->get_fitness();
+
+        genome->set_truncated_bptt(bptt_window, bptt_stride);
+
         //genome->backpropagate(training_inputs, training_outputs, validation_inputs, validation_outputs);
         genome->backpropagate_stochastic(training_inputs, training_outputs, validation_inputs, validation_outputs);
 
-        examm_mutex.lock();
-        
-        if (prev_fitness > genome->get_fitness() && genome->new_rec_depth.has_value()) {
-            int32_t depth = genome->new_rec_depth.value();
-            if (examm->rec_sampling_population == ISLAND_POPULATION)
-                examm->rec_sampling_pheromone_dists[genome->get_island()].deposit(depth);
-            else
-                examm->rec_sampling_pheromone_dists[0].deposit(depth);
-        }
+        examm->deposit_rec_depth_pheromone(genome, prev_fitness);
         examm->insert_genome(genome);
-        
-        examm_mutex.unlock();
 
         delete genome;
     }
@@ -151,6 +185,34 @@ int main(int argc, char** argv) {
 
     double baseline_pheromone = 0;
     get_argument(arguments, "--rec_depth_pheromone_baseline", false, baseline_pheromone);
+
+    if (get_argument(arguments, "--bptt_window", false, bptt_window)) {
+        bptt_stride = bptt_window;
+        get_argument(arguments, "--bptt_stride", false, bptt_stride);
+    }
+
+    get_argument(arguments, "--early_stop_grace", false, early_stop_grace);
+
+    double halving_bp_fraction = 0.0;
+    get_argument(arguments, "--halving_bp_fraction", false, halving_bp_fraction);
+
+    double halving_series_fraction = 1.0;
+    get_argument(arguments, "--halving_series_fraction", false, halving_series_fraction);
+
+    double halving_promote_fraction = 0.5;
+    get_argument(arguments, "--halving_promote_fraction", false, halving_promote_fraction);
+
+    int32_t halving_rung_size = 4;
+    get_argument(arguments, "--halving_rung_size", false, halving_rung_size);
+
+    get_argument(arguments, "--checkpoint_file", false, checkpoint_file);
+    get_argument(arguments, "--checkpoint_interval", false, checkpoint_interval);
+    bool resume = argument_exists(arguments, "--resume");
+
+    if (resume && checkpoint_file == "") {
+        cerr << "ERROR: --resume requires a --checkpoint_file to resume from" << endl;
+        exit(1);
+    }
     
     examm = new EXAMM(population_size, number_islands, max_genomes, num_genomes_check_on_island, check_on_island_method, 
             time_series_sets->get_input_parameter_names(), 
@@ -169,6 +231,17 @@ int main(int argc, char** argv) {
     if (possible_node_types.size() > 0)  {
         examm->set_possible_node_types(possible_node_types);
     }
+    examm->set_early_stop_grace(early_stop_grace);
+    examm->set_successive_halving(halving_bp_fraction, halving_series_fraction, halving_promote_fraction, halving_rung_size);
+
+    if (resume) examm->read_checkpoint(checkpoint_file);
+
+    thread checkpointer;
+    if (checkpoint_file != "") {
+        std::signal(SIGUSR1, checkpoint_signal_handler);
+        std::signal(SIGTERM, checkpoint_signal_handler);
+        checkpointer = thread(checkpoint_thread);
+    }
 
     vector<thread> threads;
     for (int32_t i = 0; i < number_threads; i++) {
@@ -180,6 +253,7 @@ int main(int argc, char** argv) {
     }
 
     finished = true;
+    if (checkpointer.joinable()) checkpointer.join();
 
     cout << "completed!" << endl;
 
@@ -43,10 +43,10 @@ bool finished = false;
 
 string output_directory = "";
 
-vector< vector< vector<double> > > training_inputs;
-vector< vector< vector<double> > > training_outputs;
-vector< vector< vector<double> > > validation_inputs;
-vector< vector< vector<double> > > validation_outputs;
+SeriesViews training_inputs;
+SeriesViews training_outputs;
+SeriesViews validation_inputs;
+SeriesViews validation_outputs;
 
 void examm_thread(int id) {
 
@@ -50,13 +50,13 @@ void Delta_Node::initialize_randomly(minstd_rand0 &generator, NormalDistribution
 double Delta_Node::get_gradient(string gradient_name) {
     double gradient_sum = 0.0;
 
-    for (uint32_t i = 0; i < series_length; i++ ) {
+    for (int32_t i = 0; i < series_length * batch_size; i++) {
         if (gradient_name == "alpha") {
             gradient_sum += d_alpha[i];
         } else if (gradient_name == "beta1") {
             gradient_sum += d_beta1[i];
         } else if (gradient_name == "beta2") {
-            gradient_sum += d_beta2[i];
+            gradient_sum += d_z_hat_bias[i] * input_values[i];
         } else if (gradient_name == "v") {
             gradient_sum += d_v[i];
         } else if (gradient_name == "r_bias") {
@@ -76,130 +76,130 @@ void Delta_Node::print_gradient(string gradient_name) {
     cout << "\tgradient['" << gradient_name << "']: " << get_gradient(gradient_name) << endl;
 }
 
-void Delta_Node::input_fired(int time, double incoming_output) {
-    inputs_fired[time]++;
+void Delta_Node::project_inputs(int32_t start_time, int32_t end_time) {
+    //beta2 is centered around 1, see forward_pass
+    double beta2_value = beta2 + 1;
+    double z_hat_bias_value = z_hat_bias;
+    double r_bias_value = r_bias;
 
-    input_values[time] += incoming_output;
+    //z_cap holds the input terms of z_hat_sum until forward_pass adds the
+    //recurrent terms and applies the activation function, the r gate only
+    //depends on the input so it is finished here
+    for (int32_t i = start_time * batch_size; i < end_time * batch_size; i++) {
+        double d2 = input_values[i];
 
-    if (inputs_fired[time] < total_inputs) return;
-    else if (inputs_fired[time] > total_inputs) {
-        cerr << "ERROR: inputs_fired on Delta_Node " << innovation_number << " at time " << time << " is " << inputs_fired[time] << " and total_inputs is " << total_inputs << endl;
-        exit(1);
+        z_cap[i] = d2 * beta2_value + z_hat_bias_value;
+
+        r[i] = sigmoid(d2 + r_bias_value);
+        ld_r[i] = sigmoid_derivative(r[i]);
     }
+}
 
-    //update alpha, beta1, beta2 so they're centered around 2, 1 and 1
+void Delta_Node::forward_pass(int32_t time) {
+    //update alpha, beta1 so they're centered around 2 and 1
     alpha += 2;
     beta1 += 1;
-    beta2 += 1;
-
 
-    //cout << "PROPAGATING FORWARD" << endl;
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        int32_t current = (time * batch_size) + lane;
 
-    double d2 = input_values[time];
-    //cout << "node " << innovation_number << " - input value[" << time << "] (d2): " << d2 << endl;
+        //cout << "PROPAGATING FORWARD" << endl;
 
-    double z_prev = 0.0;
-    if (time > 0) z_prev = output_values[time - 1];
-    //cout << "node " << innovation_number << " - prev_output_value[" << time << "] (z_prev): " << z_prev << endl;
+        double d2 = input_values[current];
+        //cout << "node " << innovation_number << " - input value[" << time << "] (d2): " << d2 << endl;
 
-    //cout << "r_bias: " << r_bias << endl;
+        double z_prev = output_values[current - batch_size];
+        //cout << "node " << innovation_number << " - prev_output_value[" << time << "] (z_prev): " << z_prev << endl;
 
-    double d1 = v * z_prev;
+        //cout << "r_bias: " << r_bias << endl;
 
-    double z_hat_1 = d1 * d2 * alpha;
-    double z_hat_2 = d1 * beta1;
+        double d1 = v * z_prev;
 
-    double z_hat_3 = d2 * beta2;
-    double z_hat_sum = z_hat_1 + z_hat_2 + z_hat_3 + z_hat_bias;
-    z_cap[time] = tanh(z_hat_sum);
-    ld_z_cap[time] = tanh_derivative(z_cap[time]);
+        double z_hat_1 = d1 * d2 * alpha;
+        double z_hat_2 = d1 * beta1;
 
-    double input_r_bias = d2 + r_bias;
-    r[time] = sigmoid(input_r_bias);
-    ld_r[time] = sigmoid_derivative(r[time]);
+        double z_hat_sum = z_hat_1 + z_hat_2 + z_cap[current];
+        z_cap[current] = tanh(z_hat_sum);
+        ld_z_cap[current] = tanh_derivative(z_cap[current]);
 
-    double z_1 = z_cap[time] * (1 - r[time]);
-    double z_2 = r[time] * z_prev;
+        double z_1 = z_cap[current] * (1 - r[current]);
+        double z_2 = r[current] * z_prev;
 
-    //TODO:
-    //try this with RELU(0 to 6)) or identity
+        //TODO:
+        //try this with RELU(0 to 6)) or identity
 
-    output_values[time] = tanh(z_1 + z_2);
-    ld_z[time] = tanh_derivative(output_values[time]);
+        output_values[current] = tanh(z_1 + z_2);
+        ld_z[current] = tanh_derivative(output_values[current]);
+    }
 
-    //reset alpha, beta1, beta2 so they don't mess with mean/stddev calculations for
+    //reset alpha, beta1 so they don't mess with mean/stddev calculations for
     //parameter generation
     alpha -= 2.0;
     beta1 -= 1.0;
-    beta2 -= 1.0;
 
     //cout << "node " << innovation_number << " - output_values[" << time << "]: " << output_values[time] << endl;
 }
 
-void Delta_Node::try_update_deltas(int time) {
-    if (outputs_fired[time] < total_outputs) return;
-    else if (outputs_fired[time] > total_outputs) {
-        cerr << "ERROR: outputs_fired on Delta_Node " << innovation_number << " at time " << time << " is " << outputs_fired[time] << " and total_outputs is " << total_outputs << endl;
-        exit(1);
-    }
-
+void Delta_Node::backward_pass(int32_t time, const double *deltas) {
     //cout << "PROPAGATING BACKWARDS" << endl;
     //update the alpha and betas to be their actual value
     alpha += 2.0;
     beta1 += 1.0;
     beta2 += 1.0;
 
-    double error = error_values[time];
-    //cout << "error_values[time]: " << error << endl;
-    double d2 = input_values[time];
-    //cout << "input value[" << time << "]:" << d2 << endl;
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        int32_t current = (time * batch_size) + lane;
+
+        double error = deltas[lane];
+        //cout << "error_values[time]: " << error << endl;
+        double d2 = input_values[current];
+        //cout << "input value[" << time << "]:" << d2 << endl;
 
-    double z_prev = 0.0;
-    if (time > 0) z_prev = output_values[time - 1];
-    //cout << "z_prev[" << (time - 1) << "]: " << z_prev << endl;
+        double z_prev = output_values[current - batch_size];
+        //cout << "z_prev[" << (time - 1) << "]: " << z_prev << endl;
 
 
-    //backprop output gate
-    double d_z = error;
-    if (time < (series_length - 1)) d_z += d_z_prev[time + 1];
-    //get the error into the output (z), it's the error from ahead in the network
-    //as well as from the previous output of the cell
+        //backprop output gate
+        double d_z = error;
+        if (time < (series_length - 1)) d_z += d_z_prev[current + batch_size];
+        //get the error into the output (z), it's the error from ahead in the network
+        //as well as from the previous output of the cell
 
-    //cout << "d_z: " << d_z << endl;
-    //cout << "ld_z_cap[" << time << "]: " << ld_z_cap[time] << endl;
+        //cout << "d_z: " << d_z << endl;
+        //cout << "ld_z_cap[" << time << "]: " << ld_z_cap[time] << endl;
 
-    d_z *= ld_z[time];
+        d_z *= ld_z[current];
 
-    d_z_prev[time] = d_z * r[time];
+        d_z_prev[current] = d_z * r[current];
 
-    double d_r = ((d_z * z_cap[time] * -1) + (d_z * z_prev)) * ld_r[time];
-    d_r_bias[time] = d_r;
-    d_input[time] = d_r;
+        double d_r = ((d_z * z_cap[current] * -1) + (d_z * z_prev)) * ld_r[current];
+        d_r_bias[current] = d_r;
+        d_input[current] = d_r;
 
-    double d_z_cap = d_z * ld_z_cap[time] * (1 - r[time]);
-    //d_z_hat_bias route
-    d_z_hat_bias[time] = d_z_cap;
-    //cout << "d_z_hat_bias[" << time << "]: " << d_z_hat_bias[time] << endl;
+        double d_z_cap = d_z * ld_z_cap[current] * (1 - r[current]);
+        //d_z_hat_bias route
+        d_z_hat_bias[current] = d_z_cap;
+        //cout << "d_z_hat_bias[" << time << "]: " << d_z_hat_bias[time] << endl;
 
-    //z_hat_3 route
-    d_input[time] += d_z_cap * beta2;
-    d_beta2[time] = d_z_cap * d2;
+        //z_hat_3 route
+        d_input[current] += d_z_cap * beta2;
 
-    //z_hat_1 route
-    double d1 = v * z_prev;
-    d_input[time] += d_z_cap * alpha * d1;
-    d_alpha[time] = d_z_cap * d2 * d1;
+        //z_hat_1 route
+        double d1 = v * z_prev;
+        d_input[current] += d_z_cap * alpha * d1;
+        d_alpha[current] = d_z_cap * d2 * d1;
 
-    //z_hat_2 route
-    d_beta1[time] = d_z_cap * d1;
-    double d_d1 = (d_z_cap * beta1) + (d2 * alpha * d_z_cap);
-    d_v[time] = d_d1 * z_prev;
-    d_z_prev[time] += d_d1 * v;
+        //z_hat_2 route
+        d_beta1[current] = d_z_cap * d1;
+        double d_d1 = (d_z_cap * beta1) + (d2 * alpha * d_z_cap);
+        d_v[current] = d_d1 * z_prev;
+        d_z_prev[current] += d_d1 * v;
 
-    //cout << "d_input: " << d_input[time] << endl;
-    //cout << "d_beta2: " << d_beta2[time] << endl;
+        //cout << "d_input: " << d_input[time] << endl;
+        //cout << "d_beta2: " << d_beta2[time] << endl;
 
-    //cout << endl << endl;
+        //cout << endl << endl;
+    }
 
     //reset the alpha/betas to be around 0
     alpha -= 2.0;
@@ -207,22 +207,6 @@ void Delta_Node::try_update_deltas(int time) {
     beta2 -= 1.0;
 }
 
-void Delta_Node::error_fired(int time, double error) {
-    outputs_fired[time]++;
-
-    error_values[time] *= error;
-
-    try_update_deltas(time);
-}
-
-void Delta_Node::output_fired(int time, double delta) {
-    outputs_fired[time]++;
-
-    error_values[time] += delta;
-
-    try_update_deltas(time);
-}
-
 
 void Delta_Node::print_cell_values() {
     /*
@@ -291,10 +275,10 @@ void Delta_Node::get_gradients(vector<double> &gradients) {
         gradients[i] = 0.0;
     }
 
-    for (uint32_t i = 0; i < series_length; i++) {
+    for (int32_t i = 0; i < series_length * batch_size; i++) {
         gradients[0] += d_alpha[i];
         gradients[1] += d_beta1[i];
-        gradients[2] += d_beta2[i];
+        gradients[2] += d_z_hat_bias[i] * input_values[i];
         gradients[3] += d_v[i];
 
         gradients[4] += d_r_bias[i];
@@ -304,29 +288,23 @@ void Delta_Node::get_gradients(vector<double> &gradients) {
 
 void Delta_Node::reset(int _series_length) {
     series_length = _series_length;
+}
 
-    d_alpha.assign(series_length, 0.0);
-    d_beta1.assign(series_length, 0.0);
-    d_beta2.assign(series_length, 0.0);
-    d_v.assign(series_length, 0.0);
-    d_r_bias.assign(series_length, 0.0);
-    d_z_hat_bias.assign(series_length, 0.0);
-    d_z_prev.assign(series_length, 0.0);
-
-    r.assign(series_length, 0.0);
-    ld_r.assign(series_length, 0.0);
-    z_cap.assign(series_length, 0.0);
-    ld_z_cap.assign(series_length, 0.0);
-    ld_z.assign(series_length, 0.0);
-
-    d_input.assign(series_length, 0.0);
-    error_values.assign(series_length, 0.0);
-
-    input_values.assign(series_length, 0.0);
-    output_values.assign(series_length, 0.0);
-
-    inputs_fired.assign(series_length, 0);
-    outputs_fired.assign(series_length, 0);
+void Delta_Node::get_series_arrays(vector<double**> &arrays) {
+    RNN_Node_Interface::get_series_arrays(arrays);
+
+    arrays.push_back(&d_alpha);
+    arrays.push_back(&d_beta1);
+    arrays.push_back(&d_v);
+    arrays.push_back(&d_r_bias);
+    arrays.push_back(&d_z_hat_bias);
+    arrays.push_back(&d_z_prev);
+
+    arrays.push_back(&r);
+    arrays.push_back(&ld_r);
+    arrays.push_back(&z_cap);
+    arrays.push_back(&ld_z_cap);
+    arrays.push_back(&ld_z);
 }
 
 RNN_Node_Interface* Delta_Node::copy() const {
@@ -335,30 +313,11 @@ RNN_Node_Interface* Delta_Node::copy() const {
     //cout << "COPYING!" << endl;
 
     //copy Delta_Node values
-    n->d_alpha = d_alpha;
-    n->d_beta1 = d_beta1;
-    n->d_beta2 = d_beta2;
-    n->d_v = d_v;
-    n->d_r_bias = d_r_bias;
-    n->d_z_hat_bias = d_z_hat_bias;
-    n->d_z_prev = d_z_prev;
-
-    n->r = r;
-    n->ld_r = ld_r;
-    n->z_cap = z_cap;
-    n->ld_z_cap = ld_z_cap;
-    n->ld_z = ld_z;
 
     //copy RNN_Node_Interface values
     n->series_length = series_length;
-    n->input_values = input_values;
-    n->output_values = output_values;
-    n->error_values = error_values;
-    n->d_input = d_input;
 
-    n->inputs_fired = inputs_fired;
     n->total_inputs = total_inputs;
-    n->outputs_fired = outputs_fired;
     n->total_outputs = total_outputs;
     n->enabled = enabled;
     n->forward_reachable = forward_reachable;
@@ -25,19 +25,18 @@ class Delta_Node : public RNN_Node_Interface {
         double r_bias;
         double z_hat_bias;
 
-        vector<double> d_alpha;
-        vector<double> d_beta1;
-        vector<double> d_beta2;
-        vector<double> d_v;
-        vector<double> d_r_bias;
-        vector<double> d_z_hat_bias;
-        vector<double> d_z_prev;
-
-        vector<double> r;
-        vector<double> ld_r;
-        vector<double> z_cap;
-        vector<double> ld_z_cap;
-        vector<double> ld_z;
+        double *d_alpha;
+        double *d_beta1;
+        double *d_v;
+        double *d_r_bias;
+        double *d_z_hat_bias;
+        double *d_z_prev;
+
+        double *r;
+        double *ld_r;
+        double *z_cap;
+        double *ld_z_cap;
+        double *ld_z;
 
     public:
 
@@ -49,11 +48,9 @@ class Delta_Node : public RNN_Node_Interface {
         double get_gradient(string gradient_name);
         void print_gradient(string gradient_name);
 
-        void input_fired(int time, double incoming_output);
-
-        void try_update_deltas(int time);
-        void error_fired(int time, double error);
-        void output_fired(int time, double delta);
+        void project_inputs(int32_t start_time, int32_t end_time);
+        void forward_pass(int32_t time);
+        void backward_pass(int32_t time, const double *deltas);
 
         uint32_t get_number_weights() const;
 
@@ -66,6 +63,7 @@ class Delta_Node : public RNN_Node_Interface {
         void get_gradients(vector<double> &gradients);
 
         void reset(int _series_length);
+        void get_series_arrays(vector<double**> &arrays);
 
         void print_cell_values();
 
@@ -1,10 +1,16 @@
 #include <algorithm>
 using std::sort;
 
+#include <atomic>
+using std::atomic;
+
 #include <chrono>
+#include <cstdint>
 #include <cstring>
 
 #include <fstream>
+using std::ifstream;
+using std::ios;
 using std::ofstream;
 
 #include <iomanip>
@@ -15,15 +21,29 @@ using std::setprecision;
 using std::cerr;
 using std::cout;
 using std::endl;
+using std::istream;
+
+#include <mutex>
+using std::lock_guard;
+using std::mutex;
+using std::unique_lock;
 
 #include <random>
 using std::minstd_rand0;
+using std::seed_seq;
 using std::uniform_real_distribution;
 
+#include <sstream>
+using std::istringstream;
+using std::ostringstream;
+
 #include <string>
 using std::string;
 using std::to_string;
 
+#include <vector>
+using std::vector;
+
 #include "examm.hxx"
 #include "rnn_genome.hxx"
 #include "generate_nn.hxx"
@@ -31,6 +51,32 @@ using std::to_string;
 
 #include "common/files.hxx"
 
+//every search takes a new epoch when it is created and when it resumes, so a
+//thread's generator is reseeded whenever it was seeded for another search or
+//before a resume
+static atomic<int32_t> next_generator_epoch(0);
+
+minstd_rand0& EXAMM::generator() {
+    static thread_local minstd_rand0 thread_generator;
+    static thread_local int32_t thread_epoch = -1;
+
+    if (thread_epoch != generator_epoch) {
+        thread_epoch = generator_epoch;
+
+        uint64_t stream = generator_streams++;
+        seed_seq seq{(uint32_t)generator_seed, (uint32_t)(generator_seed >> 32), (uint32_t)stream, (uint32_t)(stream >> 32)};
+        thread_generator.seed(seq);
+    }
+
+    return thread_generator;
+}
+static thread_local uniform_real_distribution<double> rng_0_1(0.0, 1.0);
+
+//static thread_local uniform_real_distribution<double> rng_crossover_weight(0.0, 0.0);
+//static thread_local uniform_real_distribution<double> rng_crossover_weight(-0.10, 0.1);
+static thread_local uniform_real_distribution<double> rng_crossover_weight(-0.5, 1.5);
+//static thread_local uniform_real_distribution<double> rng_crossover_weight(0.45, 0.55);
+
 EXAMM::~EXAMM() {
     RNN_Genome *genome;
     for (int32_t i = 0; i < genomes.size(); i++) {
@@ -40,6 +86,16 @@ EXAMM::~EXAMM() {
             delete genome;
         }
     }
+
+    for (uint32_t i = 0; i < halving_rung.size(); i++) {
+        delete halving_rung[i];
+    }
+
+    for (uint32_t i = 0; i < promoted_genomes.size(); i++) {
+        delete promoted_genomes[i];
+    }
+
+    writer->flush();
 }
 
 EXAMM::EXAMM(int32_t _population_size, int32_t _number_islands, int32_t _max_genomes, int32_t _num_genomes_check_on_island, string _check_on_island_method,
@@ -79,23 +135,34 @@ int mkpath(const char *path, mode_t mode);
 
     inserted_genomes = 0;
     generated_genomes = 0;
+    migrated_genomes = 0;
     total_bp_epochs = 0;
 
+    early_stop_grace = 0;
+
+    halving_bp_fraction = 0.0;
+    halving_series_fraction = 1.0;
+    halving_promote_fraction = 0.5;
+    halving_rung_size = 4;
+    partial_genomes = 0;
+
+    island_check_count = 0;
+
     edge_innovation_count = 0;
     node_innovation_count = 0;
 
+    generator_seed = std::chrono::system_clock::now().time_since_epoch().count();
+    generator_streams = 0;
+    generator_epoch = next_generator_epoch++;
+    innovation_offset = 0;
+
     //update to now have islands of genomes
+    island_mutexes = vector<mutex>(number_islands);
     genomes = vector< vector<RNN_Genome*> >(number_islands);
+    genome_hashes = vector< unordered_multimap<uint64_t, RNN_Genome*> >(number_islands);
+    checkpointed_genomes = vector< unordered_map<RNN_Genome*, string> >(number_islands);
     island_states = vector<int32_t>(number_islands, ISLAND_INITIALIZING);
-
-    uint16_t seed = std::chrono::system_clock::now().time_since_epoch().count();
-    generator = minstd_rand0(seed);
-    rng_0_1 = uniform_real_distribution<double>(0.0, 1.0);
-
-    //rng_crossover_weight = uniform_real_distribution<double>(0.0, 0.0);
-    //rng_crossover_weight = uniform_real_distribution<double>(-0.10, 0.1);
-    rng_crossover_weight = uniform_real_distribution<double>(-0.5, 1.5);
-    //rng_crossover_weight = uniform_real_distribution<double>(0.45, 0.55);
+    island_clears = vector<int32_t>(number_islands, 0);
 
     min_recurrent_depth = _min_recurrent_depth;
     max_recurrent_depth = _max_recurrent_depth;
@@ -114,12 +181,13 @@ int mkpath(const char *path, mode_t mode);
     auto ndists = rec_sampling_population == GLOBAL_POPULATION ? 1 : number_islands;    
     
     if (_rec_sampling_distribution.compare("normal") == 0) {
-        rec_sampling_population = NORMAL_DISTRIBUTION;
+        rec_sampling_distribution = NORMAL_DISTRIBUTION;
     } else if (_rec_sampling_distribution.compare("histogram") == 0) {
-        rec_sampling_population = HISTOGRAM_DISTRIBUTION;
+        rec_sampling_distribution = HISTOGRAM_DISTRIBUTION;
     } else if (_rec_sampling_distribution.compare("uniform") == 0) {
-        rec_sampling_population = UNIFORM_DISTRIBUTION;
+        rec_sampling_distribution = UNIFORM_DISTRIBUTION;
     } else if (_rec_sampling_distribution.compare("pheromone") == 0) {
+        rec_sampling_distribution = PHEROMONE_DISTRIBUTION;
         rec_sampling_pheromone_dists = vector<RecDepthPheromoneDist>();
         for (int32_t i = 0; i < ndists; i += 1)
             rec_sampling_pheromone_dists.push_back(
@@ -182,94 +250,389 @@ int mkpath(const char *path, mode_t mode);
         merge_node_rate = 0.0;
     }
 
+    writer = FileWriter::get_shared();
+    fitness_log_started = false;
+
     if (output_directory != "") {
         mkpath(output_directory.c_str(), 0777);
-        log_file = new ofstream(output_directory + "/" + "fitness_log.csv");
-        (*log_file) << "Inserted Genomes, Total BP Epochs, Time, Best Val. MAE, Best Val. MSE, Enabled Nodes, Enabled Edges, Enabled Rec. Edges" << endl;
         memory_log << "Inserted Genomes, Total BP Epochs, Time, Best Val. MAE, Best Val. MSE, Enabled Nodes, Enabled Edges, Enabled Rec. Edges" << endl;
-    } else {
-        log_file = NULL;
     }
 
     startClock = std::chrono::system_clock::now();
 }
 
 void EXAMM::print_population() {
-    cout << "POPULATIONS: " << endl;
+    //each island is written to the snapshot under its own lock, the snapshot
+    //is then printed and logged without holding any of them
+    ostringstream populations;
+    ostringstream best_statistics;
+    ostringstream depth_frequencies;
+    double best_fitness = EXAMM_MAX_DOUBLE;
+
+    populations << "POPULATIONS: " << endl;
     for (int32_t i = 0; i < (int32_t)genomes.size(); i++) {
-        cout << "\tPOPULATION " << i << ":" << endl;
+        lock_guard<mutex> island_lock(island_mutexes[i]);
+
+        populations << "\tPOPULATION " << i << ":" << endl;
 
-        cout << "\t" << RNN_Genome::print_statistics_header() << endl;
+        populations << "\t" << RNN_Genome::print_statistics_header() << endl;
 
         for (int32_t j = 0; j < (int32_t)genomes[i].size(); j++) {
-            cout << "\t" << genomes[i][j]->print_statistics() << endl;
+            populations << "\t" << genomes[i][j]->print_statistics() << endl;
         }
-    }
-
-    cout << endl << endl;
 
-    if (log_file != NULL) {
+        if (output_directory == "") continue;
 
-        //make sure the log file is still good
-        if (!log_file->good()) {
-            log_file->close();
-            delete log_file;
+        if (genomes[i].size() > 0 && genomes[i][0]->get_fitness() <= best_fitness) {
+            RNN_Genome *best_genome = genomes[i][0];
+            best_fitness = best_genome->get_fitness();
 
-            string output_file = output_directory + "/fitness_log.csv";
-            log_file = new ofstream(output_file, std::ios_base::app);
+            best_statistics.str("");
+            best_statistics << "," << best_genome->best_validation_mae
+                << "," << best_genome->best_validation_mse
+                << "," << best_genome->get_enabled_node_count()
+                << "," << best_genome->get_enabled_edge_count()
+                << "," << best_genome->get_enabled_recurrent_edge_count();
+        }
 
-            if (!log_file->is_open()) {
-                cerr << "ERROR, could not open EXAMM output log: '" << output_file << "'" << endl;
-                exit(1);
-            }
+        // stores the frequency table of rec connection depth for each island
+        RecDepthFrequencyTable freqs(genomes[i], min_recurrent_depth, max_recurrent_depth);
+        for (int32_t d = min_recurrent_depth; d <= max_recurrent_depth; d += 1) {
+            depth_frequencies << freqs[d];
+            if (d == max_recurrent_depth) continue;
+            depth_frequencies << ";";
         }
+        depth_frequencies << "$";
+    }
 
-        RNN_Genome *best_genome = get_best_genome();
+    populations << endl << endl;
+
+    lock_guard<mutex> log_lock(log_mutex);
+
+    writer->print(populations.str());
+
+    if (output_directory != "") {
+        if (!fitness_log_started) {
+            writer->write(output_directory + "/fitness_log.csv", "Inserted Genomes, Total BP Epochs, Time, Best Val. MAE, Best Val. MSE, Enabled Nodes, Enabled Edges, Enabled Rec. Edges\n");
+            fitness_log_started = true;
+        }
 
         std::chrono::time_point<std::chrono::system_clock> currentClock = std::chrono::system_clock::now();
         long milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(currentClock - startClock).count();
 
-        (*log_file) << inserted_genomes
+        ostringstream log_line;
+        log_line << inserted_genomes
             << "," << total_bp_epochs
             << "," << milliseconds
-            << "," << best_genome->best_validation_mae
-            << "," << best_genome->best_validation_mse
-            << "," << best_genome->get_enabled_node_count()
-            << "," << best_genome->get_enabled_edge_count()
-            << "," << best_genome->get_enabled_recurrent_edge_count()
-         // Commented out to prevent unecessary data collection - 
-         // stores the frequency table of rec connection depth for each island
-            << ",";
-        for (int32_t i = 0; i < genomes.size(); i += 1) {
-            RecDepthFrequencyTable freqs(genomes[i], min_recurrent_depth, max_recurrent_depth);
-            for (int32_t d = min_recurrent_depth; d <= max_recurrent_depth; d += 1) {
-                (*log_file) << freqs[d];
-                if (d == max_recurrent_depth) continue;
-                (*log_file) << ";";
-            }
-            if (i != genomes.size()) 
-                (*log_file) << "$";
-        }
-
-        (*log_file) << endl;
+            << best_statistics.str()
+            << "," << depth_frequencies.str() << endl;
+        writer->append(output_directory + "/fitness_log.csv", log_line.str());
         
         memory_log << inserted_genomes
             << "," << total_bp_epochs
             << "," << milliseconds
-            << "," << best_genome->best_validation_mae
-            << "," << best_genome->best_validation_mse
-            << "," << best_genome->get_enabled_node_count()
-            << "," << best_genome->get_enabled_edge_count()
-            << "," << best_genome->get_enabled_recurrent_edge_count() << endl;
+            << best_statistics.str() << endl;
     }
 }
 
 void EXAMM::write_memory_log(string filename) {
+    lock_guard<mutex> lock(log_mutex);
+
     ofstream log_file(filename);
     log_file << memory_log.str();
     log_file.close();
 }
 
+void EXAMM::write_checkpoint(string filename) {
+    ostringstream checkpoint;
+
+    int32_t version = EXAMM_CHECKPOINT_VERSION;
+    checkpoint.write((char*)&version, sizeof(int32_t));
+    checkpoint.write((char*)&number_islands, sizeof(int32_t));
+
+    int32_t counts[8] = {generated_genomes, inserted_genomes, total_bp_epochs, island_check_count, edge_innovation_count, node_innovation_count, 0, migrated_genomes};
+
+    std::chrono::time_point<std::chrono::system_clock> currentClock = std::chrono::system_clock::now();
+    int64_t milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(currentClock - startClock).count();
+
+    int64_t streams = generator_streams;
+
+    for (int32_t i = 0; i < number_islands; i++) {
+        lock_guard<mutex> lock(island_mutexes[i]);
+
+        int32_t island_size = genomes[i].size();
+        checkpoint.write((char*)&island_states[i], sizeof(int32_t));
+        checkpoint.write((char*)&island_clears[i], sizeof(int32_t));
+        checkpoint.write((char*)&island_size, sizeof(int32_t));
+
+        for (int32_t j = 0; j < island_size; j++) {
+            auto cached = checkpointed_genomes[i].find(genomes[i][j]);
+
+            if (cached == checkpointed_genomes[i].end()) {
+                ostringstream genome_bytes;
+                genomes[i][j]->write_to_stream(genome_bytes);
+                cached = checkpointed_genomes[i].insert( {genomes[i][j], genome_bytes.str()} ).first;
+            }
+
+            write_binary_string(checkpoint, cached->second, "genome", false);
+        }
+    }
+
+    {
+        lock_guard<mutex> lock(log_mutex);
+
+        ostringstream generated_from;
+        write_map(generated_from, generated_from_map);
+        write_binary_string(checkpoint, generated_from.str(), "generated_from_map", false);
+
+        ostringstream inserted_from;
+        write_map(inserted_from, inserted_from_map);
+        write_binary_string(checkpoint, inserted_from.str(), "inserted_from_map", false);
+    }
+
+    {
+        //genomes out for partial training are lost, but the ones already
+        //ranked or promoted are kept
+        lock_guard<mutex> lock(halving_mutex);
+        counts[6] = partial_genomes;
+
+        vector<RNN_Genome*> *halving_genomes[2] = {&halving_rung, NULL};
+        vector<RNN_Genome*> promoted(promoted_genomes.begin(), promoted_genomes.end());
+        halving_genomes[1] = &promoted;
+
+        for (int32_t i = 0; i < 2; i++) {
+            int32_t number_genomes = halving_genomes[i]->size();
+            checkpoint.write((char*)&number_genomes, sizeof(int32_t));
+
+            //the compact format keeps the optimizer state, with the number of
+            //island clears each genome was generated at
+            for (int32_t j = 0; j < number_genomes; j++) {
+                RNN_Genome *genome = (*halving_genomes[i])[j];
+                auto generated_clears = halving_island_clears.find(genome->get_generation_id());
+                int32_t clears = generated_clears == halving_island_clears.end() ? 0 : generated_clears->second;
+                checkpoint.write((char*)&clears, sizeof(int32_t));
+
+                ostringstream genome_bytes;
+                genome->write_to_compact_stream(genome_bytes, true);
+                write_binary_string(checkpoint, genome_bytes.str(), "genome", false);
+            }
+        }
+    }
+
+    {
+        lock_guard<mutex> lock(pheromone_mutex);
+
+        int32_t number_dists = rec_sampling_pheromone_dists.size();
+        checkpoint.write((char*)&number_dists, sizeof(int32_t));
+        for (int32_t i = 0; i < number_dists; i++) {
+            rec_sampling_pheromone_dists[i].write_to_stream(checkpoint);
+        }
+    }
+
+    checkpoint.write((char*)counts, sizeof(int32_t) * 8);
+    checkpoint.write((char*)&innovation_offset, sizeof(int32_t));
+    checkpoint.write((char*)&milliseconds, sizeof(int64_t));
+    checkpoint.write((char*)&generator_seed, sizeof(uint64_t));
+    checkpoint.write((char*)&streams, sizeof(int64_t));
+
+    writer->write(filename, checkpoint.str());
+
+    cout << "wrote checkpoint of " << counts[1] << " inserted genomes to '" << filename << "'" << endl;
+}
+
+void check_checkpoint(istream &in, string filename, string name) {
+    if (!in.good()) {
+        cerr << "ERROR: EXAMM checkpoint '" << filename << "' is truncated, could not read its " << name << endl;
+        exit(1);
+    }
+}
+
+void read_checkpoint_string(istream &in, int64_t file_size, string &s, string filename, string name) {
+    int32_t n;
+    in.read((char*)&n, sizeof(int32_t));
+    check_checkpoint(in, filename, name + " length");
+
+    if (n < 0 || n > file_size - (int64_t)in.tellg()) {
+        cerr << "ERROR: EXAMM checkpoint '" << filename << "' has a " << name << " of " << n << " bytes, but only " << (file_size - (int64_t)in.tellg()) << " bytes are left" << endl;
+        exit(1);
+    }
+
+    s.resize(n);
+    in.read(&s[0], n);
+    check_checkpoint(in, filename, name);
+}
+
+void EXAMM::read_checkpoint(string filename) {
+    ifstream infile(filename, ios::in | ios::binary);
+    if (!infile.good()) {
+        cerr << "ERROR: could not open EXAMM checkpoint '" << filename << "'" << endl;
+        exit(1);
+    }
+
+    infile.seekg(0, ios::end);
+    int64_t file_size = infile.tellg();
+    infile.seekg(0, ios::beg);
+
+    int32_t version, checkpoint_islands;
+    infile.read((char*)&version, sizeof(int32_t));
+    check_checkpoint(infile, filename, "version");
+    infile.read((char*)&checkpoint_islands, sizeof(int32_t));
+    check_checkpoint(infile, filename, "number of islands");
+
+    if (version != EXAMM_CHECKPOINT_VERSION) {
+        cerr << "ERROR: EXAMM checkpoint '" << filename << "' has version " << version << ", expected " << EXAMM_CHECKPOINT_VERSION << endl;
+        exit(1);
+    }
+
+    if (checkpoint_islands != number_islands) {
+        cerr << "ERROR: EXAMM checkpoint '" << filename << "' has " << checkpoint_islands << " islands but the search has " << number_islands << endl;
+        exit(1);
+    }
+
+    for (int32_t i = 0; i < number_islands; i++) {
+        lock_guard<mutex> lock(island_mutexes[i]);
+
+        for (int32_t j = 0; j < (int32_t)genomes[i].size(); j++) delete genomes[i][j];
+        genomes[i].clear();
+        genome_hashes[i].clear();
+        checkpointed_genomes[i].clear();
+
+        int32_t island_size;
+        infile.read((char*)&island_states[i], sizeof(int32_t));
+        check_checkpoint(infile, filename, "island state");
+        infile.read((char*)&island_clears[i], sizeof(int32_t));
+        check_checkpoint(infile, filename, "island clears");
+        infile.read((char*)&island_size, sizeof(int32_t));
+        check_checkpoint(infile, filename, "island size");
+
+        if (island_size < 0 || island_size > population_size) {
+            cerr << "ERROR: EXAMM checkpoint '" << filename << "' has " << island_size << " genomes on island " << i << " but the population size is " << population_size << endl;
+            exit(1);
+        }
+
+        for (int32_t j = 0; j < island_size; j++) {
+            string genome_bytes;
+            read_checkpoint_string(infile, file_size, genome_bytes, filename, "genome");
+
+            istringstream genome_iss(genome_bytes);
+            RNN_Genome *genome = new RNN_Genome(genome_iss);
+
+            //genomes were written in fitness order
+            genomes[i].push_back(genome);
+            genome_hashes[i].insert( {genome->get_structural_hash(), genome} );
+            checkpointed_genomes[i].insert( {genome, genome_bytes} );
+        }
+    }
+
+    {
+        lock_guard<mutex> lock(log_mutex);
+
+        string generated_from, inserted_from;
+        read_checkpoint_string(infile, file_size, generated_from, filename, "generated_from_map");
+        read_checkpoint_string(infile, file_size, inserted_from, filename, "inserted_from_map");
+
+        istringstream generated_from_iss(generated_from);
+        generated_from_map.clear();
+        read_map(generated_from_iss, generated_from_map);
+
+        istringstream inserted_from_iss(inserted_from);
+        inserted_from_map.clear();
+        read_map(inserted_from_iss, inserted_from_map);
+
+        fitness_log_started = true;
+    }
+
+    {
+        lock_guard<mutex> lock(halving_mutex);
+
+        for (int32_t i = 0; i < 2; i++) {
+            int32_t number_genomes;
+            infile.read((char*)&number_genomes, sizeof(int32_t));
+            check_checkpoint(infile, filename, "number of successive halving genomes");
+
+            //neither the rung nor the promoted genomes outgrow the rung size
+            if (number_genomes < 0 || number_genomes > halving_rung_size) {
+                cerr << "ERROR: EXAMM checkpoint '" << filename << "' has " << number_genomes << " successive halving genomes but the rung size is " << halving_rung_size << endl;
+                exit(1);
+            }
+
+            for (int32_t j = 0; j < number_genomes; j++) {
+                int32_t clears;
+                infile.read((char*)&clears, sizeof(int32_t));
+                check_checkpoint(infile, filename, "island clears of a successive halving genome");
+
+                string genome_bytes;
+                read_checkpoint_string(infile, file_size, genome_bytes, filename, "genome");
+
+                istringstream genome_iss(genome_bytes);
+                RNN_Genome *genome = new RNN_Genome(genome_iss);
+                halving_island_clears[genome->get_generation_id()] = clears;
+
+                if (i == 0) halving_rung.push_back(genome);
+                else promoted_genomes.push_back(genome);
+            }
+        }
+    }
+
+    {
+        lock_guard<mutex> lock(pheromone_mutex);
+
+        int32_t number_dists;
+        infile.read((char*)&number_dists, sizeof(int32_t));
+        check_checkpoint(infile, filename, "number of pheromone distributions");
+        if (number_dists != (int32_t)rec_sampling_pheromone_dists.size()) {
+            cerr << "ERROR: EXAMM checkpoint '" << filename << "' has " << number_dists << " pheromone distributions but the search has " << rec_sampling_pheromone_dists.size() << endl;
+            exit(1);
+        }
+
+        for (int32_t i = 0; i < number_dists; i++) {
+            rec_sampling_pheromone_dists[i].read_from_stream(infile);
+            check_checkpoint(infile, filename, "pheromone distribution");
+        }
+    }
+
+    int32_t counts[8];
+    int32_t checkpoint_innovation_offset;
+    int64_t milliseconds;
+    uint64_t seed;
+    int64_t streams;
+    infile.read((char*)counts, sizeof(int32_t) * 8);
+    check_checkpoint(infile, filename, "counts");
+    infile.read((char*)&checkpoint_innovation_offset, sizeof(int32_t));
+    check_checkpoint(infile, filename, "innovation offset");
+
+    //the innovation numbers in the checkpoint are from this offset's range
+    if (checkpoint_innovation_offset != innovation_offset) {
+        cerr << "ERROR: EXAMM checkpoint '" << filename << "' has innovation offset " << checkpoint_innovation_offset << " but the search has " << innovation_offset << ", a hierarchical search has to be resumed with the same number of sub-masters" << endl;
+        exit(1);
+    }
+    infile.read((char*)&milliseconds, sizeof(int64_t));
+    check_checkpoint(infile, filename, "run time");
+    infile.read((char*)&seed, sizeof(uint64_t));
+    check_checkpoint(infile, filename, "generator seed");
+    infile.read((char*)&streams, sizeof(int64_t));
+    check_checkpoint(infile, filename, "generator streams");
+
+    generated_genomes = counts[0];
+    inserted_genomes = counts[1];
+    total_bp_epochs = counts[2];
+    island_check_count = counts[3];
+    edge_innovation_count = counts[4];
+    node_innovation_count = counts[5];
+    partial_genomes = counts[6];
+    migrated_genomes = counts[7];
+
+    //keep the times in the fitness log counting from the original start
+    startClock = std::chrono::system_clock::now() - std::chrono::milliseconds(milliseconds);
+
+    //every thread reseeds its generator the next time it uses it
+    generator_seed = seed;
+    generator_streams = streams;
+    generator_epoch = next_generator_epoch++;
+
+    cout << "resumed from checkpoint '" << filename << "' with " << inserted_genomes << " inserted genomes" << endl;
+}
+
 void EXAMM::set_possible_node_types(vector<string> possible_node_type_strings) {
     possible_node_types.clear();
 
@@ -292,18 +655,65 @@ void EXAMM::set_possible_node_types(vector<string> possible_node_type_strings) {
     }
 }
 
+void EXAMM::set_early_stop_grace(int32_t _early_stop_grace) {
+    early_stop_grace = _early_stop_grace;
+}
+
+void EXAMM::set_successive_halving(double _halving_bp_fraction, double _halving_series_fraction, double _halving_promote_fraction, int32_t _halving_rung_size) {
+    halving_bp_fraction = _halving_bp_fraction;
+    halving_series_fraction = _halving_series_fraction;
+    halving_promote_fraction = _halving_promote_fraction;
+    halving_rung_size = _halving_rung_size;
+}
+
+void EXAMM::set_innovation_offset(int32_t _innovation_offset) {
+    innovation_offset = _innovation_offset;
+}
+
+int32_t EXAMM::get_partial_bp_iterations() const {
+    int32_t partial_bp_iterations = bp_iterations * halving_bp_fraction;
+    if (partial_bp_iterations < 1) partial_bp_iterations = 1;
+    return partial_bp_iterations;
+}
+
+double EXAMM::get_island_fitness_threshold(int32_t island) {
+    lock_guard<mutex> lock(island_mutexes[island]);
+
+    //insert_genome only rejects genomes worse than the worst member of a full island
+    if ((int32_t)genomes[island].size() < population_size) return EXAMM_MAX_DOUBLE;
+    return genomes[island].back()->get_fitness();
+}
+
 int32_t EXAMM::population_contains(RNN_Genome* genome, int32_t island) {
-    for (int32_t j = 0; j < (int32_t)genomes[island].size(); j++) {
-        if (genomes[island][j]->equals(genome)) {
-            return j;
+    auto matches = genome_hashes[island].equal_range(genome->get_structural_hash());
+
+    for (auto it = matches.first; it != matches.second; it++) {
+        if (!it->second->equals(genome)) continue;
+
+        for (int32_t j = 0; j < (int32_t)genomes[island].size(); j++) {
+            if (genomes[island][j] == it->second) return j;
         }
     }
 
     return -1;
 }
 
-bool EXAMM::populations_full() const {
+void EXAMM::remove_indexed_genome(int32_t island, RNN_Genome* genome) {
+    checkpointed_genomes[island].erase(genome);
+
+    auto matches = genome_hashes[island].equal_range(genome->get_structural_hash());
+
+    for (auto it = matches.first; it != matches.second; it++) {
+        if (it->second == genome) {
+            genome_hashes[island].erase(it);
+            return;
+        }
+    }
+}
+
+bool EXAMM::populations_full() {
     for (int32_t i = 0; i < (int32_t)genomes.size(); i++) {
+        lock_guard<mutex> lock(island_mutexes[i]);
         if (genomes[i].size() < population_size) return false;
     }
 
@@ -356,15 +766,69 @@ RNN_Genome* EXAMM::get_worst_genome() {
 
 
 double EXAMM::get_best_fitness() {
-    RNN_Genome *best_genome = get_best_genome();
-    if (best_genome == NULL) return EXAMM_MAX_DOUBLE;
-    else return best_genome->get_fitness();
+    double best_fitness = EXAMM_MAX_DOUBLE;
+
+    for (int32_t i = 0; i < (int32_t)genomes.size(); i++) {
+        lock_guard<mutex> lock(island_mutexes[i]);
+        if (genomes[i].size() > 0 && genomes[i][0]->get_fitness() < best_fitness) {
+            best_fitness = genomes[i][0]->get_fitness();
+        }
+    }
+
+    return best_fitness;
 }
 
 double EXAMM::get_worst_fitness() {
-    RNN_Genome *worst_genome = get_worst_genome();
-    if (worst_genome == NULL) return EXAMM_MAX_DOUBLE;
-    else return worst_genome->get_fitness();
+    double worst_fitness = -EXAMM_MAX_DOUBLE;
+
+    for (int32_t i = 0; i < (int32_t)genomes.size(); i++) {
+        lock_guard<mutex> lock(island_mutexes[i]);
+        if (genomes[i].size() > 0 && genomes[i].back()->get_fitness() > worst_fitness) {
+            worst_fitness = genomes[i].back()->get_fitness();
+        }
+    }
+
+    if (worst_fitness == -EXAMM_MAX_DOUBLE) return EXAMM_MAX_DOUBLE;
+    else return worst_fitness;
+}
+
+RNN_Genome* EXAMM::copy_random_genome(int32_t island) {
+    lock_guard<mutex> lock(island_mutexes[island]);
+    if (genomes[island].size() == 0) return NULL;
+
+    int32_t genome_position = genomes[island].size() * rng_0_1(generator());
+    return genomes[island][genome_position]->copy();
+}
+
+RNN_Genome* EXAMM::copy_best_genome(int32_t island) {
+    lock_guard<mutex> lock(island_mutexes[island]);
+    if (genomes[island].size() == 0) return NULL;
+
+    return genomes[island][0]->copy();
+}
+
+bool EXAMM::copy_crossover_parents(int32_t island, RNN_Genome* &p1, RNN_Genome* &p2) {
+    lock_guard<mutex> lock(island_mutexes[island]);
+
+    p1 = NULL;
+    p2 = NULL;
+    if (genomes[island].size() < 2) return false;
+
+    //select two distinct parent genomes in the same island
+    int32_t p1_position = genomes[island].size() * rng_0_1(generator());
+    int32_t p2_position = (genomes[island].size() - 1) * rng_0_1(generator());
+    if (p2_position >= p1_position) p2_position++;
+
+    //swap so the first parent is the more fit parent
+    if (p1_position > p2_position) {
+        int32_t tmp = p1_position;
+        p1_position = p2_position;
+        p2_position = tmp;
+    }
+
+    p1 = genomes[island][p1_position]->copy();
+    p2 = genomes[island][p2_position]->copy();
+    return true;
 }
 
 //this will insert a COPY, original needs to be deleted
@@ -375,47 +839,124 @@ bool EXAMM::insert_genome(RNN_Genome* genome) {
     }
 
     int32_t island = genome->get_island();
-    double new_fitness = genome->get_fitness();
 
-    bool was_inserted = true;
+    {
+        lock_guard<mutex> lock(halving_mutex);
+        if (partial_generation_ids.erase(genome->get_generation_id()) > 0) {
+            rank_partial_genome(genome);
+            return false;
+        }
 
-    inserted_genomes++;
-    total_bp_epochs += genome->get_bp_iterations();
+        auto generated_clears = halving_island_clears.find(genome->get_generation_id());
+        if (generated_clears != halving_island_clears.end()) {
+            int32_t clears = generated_clears->second;
+            halving_island_clears.erase(generated_clears);
+
+            lock_guard<mutex> island_lock(island_mutexes[island]);
+            if (island_clears[island] != clears) {
+                cout << "ignoring promoted genome " << genome->get_generation_id() << ", island " << island << " was cleared since it was generated" << endl;
+                return false;
+            }
+        }
+    }
+
+    double new_fitness = genome->get_fitness();
+
+    //migrants were trained (and counted) by the search they came from
+    bool migrant = genome->get_generation_id() < 0;
+    int32_t insert_number = migrant ? (int32_t)inserted_genomes : ++inserted_genomes;
+    if (!migrant) total_bp_epochs += genome->get_bp_iterations();
 
-    genome->update_generation_map(generated_from_map);
+    {
+        lock_guard<mutex> lock(log_mutex);
+        genome->update_generation_map(generated_from_map);
+    }
 
-    cout << "genomes evaluated: " << setw(10) << inserted_genomes << ", inserting: " << parse_fitness(genome->get_fitness()) << " to island " << island << endl;
+    cout << "genomes evaluated: " << setw(10) << insert_number << ", inserting: " << parse_fitness(genome->get_fitness()) << " to island " << island << endl;
 
-    if (genomes[island].size() >= population_size  && new_fitness > genomes[island].back()->get_fitness()) {
-        cout << "ignoring genome, fitness: " << new_fitness << " > worst population[" << island << "] fitness: " << genomes[island].back()->get_fitness() << endl;
+    double island_threshold = get_island_fitness_threshold(island);
+    if (new_fitness > island_threshold) {
+        cout << "ignoring genome, fitness: " << new_fitness << " > worst population[" << island << "] fitness: " << island_threshold << endl;
         print_population();
         return false;
     }
 
-    int32_t duplicate_genome = population_contains(genome, island);
+    //copy the genome (and hash it) before taking the island lock, as this is
+    //the slowest part of inserting it
+    RNN_Genome *copy = genome->copy();
+    copy->get_structural_hash();
+    cout << "created copy with island: " << copy->get_island() << endl;
+
+    double best_fitness = get_best_fitness();
+
+    int32_t duplicate_genome = -1;
+    double duplicate_fitness = 0.0;
+    RNN_Genome *replaced_duplicate = NULL;
+    RNN_Genome *worst = NULL;
+    bool was_inserted = false;
+    bool island_was_empty = false;
+
+    {
+        lock_guard<mutex> lock(island_mutexes[island]);
+
+        duplicate_genome = population_contains(copy, island);
+        if (duplicate_genome >= 0) {
+            duplicate_fitness = genomes[island][duplicate_genome]->get_fitness();
+
+            //if fitness is better, replace this genome with new one
+            if (duplicate_fitness > new_fitness) {
+                replaced_duplicate = genomes[island][duplicate_genome];
+                genomes[island].erase(genomes[island].begin() + duplicate_genome);
+                remove_indexed_genome(island, replaced_duplicate);
+            }
+        }
+
+        if ((duplicate_genome < 0 || replaced_duplicate != NULL) && ((int32_t)genomes[island].size() < population_size || genomes[island].back()->get_fitness() > new_fitness)) {
+            //this genome will be inserted
+            was_inserted = true;
+            island_was_empty = genomes[island].size() == 0;
+
+            //inorder insert the new individual
+            genomes[island].insert( upper_bound(genomes[island].begin(), genomes[island].end(), copy, sort_genomes_by_fitness()), copy);
+            genome_hashes[island].insert( {copy->get_structural_hash(), copy} );
+
+            if ((int32_t)genomes[island].size() >= population_size) {
+                island_states[island] = ISLAND_FILLED;
+            }
+
+            //delete the worst individual if we've reached the population size
+            if ((int32_t)genomes[island].size() > population_size) {
+                worst = genomes[island].back();
+                genomes[island].pop_back();
+                remove_indexed_genome(island, worst);
+            }
+        }
+    }
+
     if (duplicate_genome >= 0) {
-        //if fitness is better, replace this genome with new one
         cout << "found duplicate at position: " << duplicate_genome << endl;
 
-        RNN_Genome *duplicate = genomes[island][duplicate_genome];
-        if (duplicate->get_fitness() > new_fitness) {
-            //erase the genome with loewr fitness from the vector;
-            cout << "REPLACING DUPLICATE GENOME, fitness of genome in search: " << parse_fitness(duplicate->get_fitness()) << ", new fitness: " << parse_fitness(genome->get_fitness()) << endl;
-            genomes[island].erase(genomes[island].begin() + duplicate_genome);
-            delete duplicate;
+        if (replaced_duplicate != NULL) {
+            cout << "REPLACING DUPLICATE GENOME, fitness of genome in search: " << parse_fitness(duplicate_fitness) << ", new fitness: " << parse_fitness(genome->get_fitness()) << endl;
+            delete replaced_duplicate;
 
         } else {
             cerr << "\tpopulation already contains genome! not inserting." << endl;
+            delete copy;
             print_population();
             return false;
         }
     }
 
-    if (genomes[island].size() < population_size || genomes[island].back()->get_fitness() > new_fitness) {
-        //this genome will be inserted
-        was_inserted = true;
+    if (was_inserted) {
+        cout << "inserted new genome to island " << island << endl;
+
+        if (worst != NULL) {
+            cout << "deleted worst genome" << endl;
+            delete worst;
+        }
 
-        if (genomes[island].size() == 0 || genome->get_fitness() < get_best_genome()->get_fitness()) {
+        if (island_was_empty || new_fitness < best_fitness) {
             cout << "new best fitness!" << endl;
 
             if (genome->get_fitness() != EXAMM_MAX_DOUBLE) {
@@ -425,35 +966,20 @@ bool EXAMM::insert_genome(RNN_Genome* genome) {
                 genome->set_weights(best_parameters);
             }
 
-            genome->write_graphviz(output_directory + "/rnn_genome_" + to_string(inserted_genomes) + ".gv");
-            genome->write_to_file(output_directory + "/rnn_genome_" + to_string(inserted_genomes) + ".bin", true);
+            //the genome is serialized here, the writer only has to put it on disk
+            ostringstream graphviz;
+            genome->write_graphviz(graphviz);
+            writer->write(output_directory + "/rnn_genome_" + to_string(insert_number) + ".gv", graphviz.str());
 
+            ostringstream genome_bytes;
+            genome->write_to_stream(genome_bytes, true);
+            writer->write(output_directory + "/rnn_genome_" + to_string(insert_number) + ".bin", genome_bytes.str());
         }
 
+        lock_guard<mutex> lock(log_mutex);
         genome->update_generation_map(inserted_from_map);
-
-        cout << "inserting new genome to island " << island << endl;
-        //inorder insert the new individual
-        RNN_Genome *copy = genome->copy();
-        cout << "created copy with island: " << copy->get_island() << endl;
-
-        genomes[island].insert( upper_bound(genomes[island].begin(), genomes[island].end(), copy, sort_genomes_by_fitness()), copy);
-        cout << "finished insert" << endl;
-
-        if (genomes[island].size() >= population_size) {
-            island_states[island] = ISLAND_FILLED;
-        }
-
-        //delete the worst individual if we've reached the population size
-        if ((int32_t)genomes[island].size() > population_size) {
-            cout << "deleting worst genome" << endl;
-            RNN_Genome *worst = genomes[island].back();
-            genomes[island].pop_back();
-
-            delete worst;
-        }
     } else {
-        was_inserted = false;
+        delete copy;
         cout << "not inserting genome due to poor fitness" << endl;
     }
 
@@ -464,17 +990,40 @@ bool EXAMM::insert_genome(RNN_Genome* genome) {
     return was_inserted;
 }
 
+//inserts an already evaluated genome from another search into a random
+//island. it is given a new generation id from this search, so it can't be
+//mistaken for one of this search's (possibly partially trained) genomes,
+//and counts as a generated and an inserted genome.
+bool EXAMM::insert_migrant(RNN_Genome* genome) {
+    int32_t island = number_islands * rng_0_1(generator());
+    if (island >= number_islands) island = number_islands - 1;
+
+    //migrants are numbered apart from the generated genomes (counting down
+    //from -1), so they neither count towards max_genomes nor shift which
+    //island the next generated genome goes to
+    genome->set_island(island);
+    genome->set_generation_id(-(++migrated_genomes));
+    genome->clear_generated_by();
+    genome->set_generated_by("migration");
+
+    return insert_genome(genome);
+}
+
 int32_t EXAMM::check_on_island() {
     if (check_on_island_method == "") {
         return -1;
     }
 
     // only run this function every n inserted genomes
+    int32_t inserted = inserted_genomes;
     if (   num_genomes_check_on_island == 0 
-        || inserted_genomes % num_genomes_check_on_island != 0) {
+        || inserted % num_genomes_check_on_island != 0) {
         return -1;
     }
 
+    //more than one genome can be generated before the next insert, only check once
+    if (island_check_count.exchange(inserted) == inserted) return -1;
+
     if (check_on_island_method == "clear_island_with_worst_best_genome") {
         return clear_island_with_worst_best_genome();
     }
@@ -489,6 +1038,7 @@ int32_t EXAMM::clear_island_with_worst_best_genome() {
     // find the best genome for each island and identify the 
     //island with the worst best genome
     for (int32_t i = 0; i < (int32_t)genomes.size(); i++) {
+        lock_guard<mutex> lock(island_mutexes[i]);
         double best_fitness = EXAMM_MAX_DOUBLE;
 
         for (int32_t j = 0; j < (int32_t)genomes[i].size(); j++) {
@@ -515,13 +1065,20 @@ int32_t EXAMM::clear_island_with_worst_best_genome() {
         }
         */
 
-        while (genomes[worst_island].size() > 0) {
-            RNN_Genome *genome = genomes[worst_island][0];
-            genomes[worst_island].erase(genomes[worst_island].begin());
-            delete genome;
+        vector<RNN_Genome*> cleared_genomes;
+        {
+            lock_guard<mutex> lock(island_mutexes[worst_island]);
+            cleared_genomes.swap(genomes[worst_island]);
+            genome_hashes[worst_island].clear();
+            checkpointed_genomes[worst_island].clear();
+
+            island_states[worst_island] = ISLAND_REPOPULATING;
+            island_clears[worst_island]++;
         }
 
-        island_states[worst_island] = ISLAND_REPOPULATING;
+        for (int32_t i = 0; i < (int32_t)cleared_genomes.size(); i++) {
+            delete cleared_genomes[i];
+        }
     }
 
     return worst_island;
@@ -536,9 +1093,62 @@ void EXAMM::initialize_genome_parameters(RNN_Genome* genome) {
     if (use_dropout) genome->enable_dropout(dropout_probability);
 }
 
+//must be called holding the halving_mutex
+void EXAMM::rank_partial_genome(RNN_Genome* genome) {
+    partial_genomes++;
+    total_bp_epochs += genome->get_bp_iterations();
+
+    //the caller owns the genome, and copies lose their generation id
+    RNN_Genome *copy = genome->copy();
+    copy->set_generation_id(genome->get_generation_id());
+    halving_rung.push_back(copy);
+
+    cout << "partially trained genomes: " << setw(10) << partial_genomes << ", ranking: " << parse_fitness(genome->get_fitness()) << " (" << halving_rung.size() << " of " << halving_rung_size << ")" << endl;
+
+    if ((int32_t)halving_rung.size() < halving_rung_size) return;
+
+    sort(halving_rung.begin(), halving_rung.end(), sort_genomes_by_fitness());
+
+    int32_t number_promoted = halving_rung.size() * halving_promote_fraction + 0.5;
+    if (number_promoted < 1) number_promoted = 1;
+
+    for (int32_t i = 0; i < (int32_t)halving_rung.size(); i++) {
+        if (i < number_promoted) {
+            promoted_genomes.push_back(halving_rung[i]);
+        } else {
+            halving_island_clears.erase(halving_rung[i]->get_generation_id());
+            delete halving_rung[i];
+        }
+    }
+    halving_rung.clear();
+}
+
 RNN_Genome* EXAMM::generate_genome() {
     if (inserted_genomes > max_genomes) return NULL;
 
+    RNN_Genome *promoted = NULL;
+    {
+        lock_guard<mutex> lock(halving_mutex);
+        if (promoted_genomes.size() > 0) {
+            promoted = promoted_genomes.front();
+            promoted_genomes.pop_front();
+        }
+    }
+
+    if (promoted != NULL) {
+        //pick up training where the partial training left off, its optimizer
+        //state is only kept until then
+        RNN_Genome *genome = promoted;
+
+        genome->initial_parameters = genome->get_best_parameters();
+        genome->set_bp_iterations(bp_iterations - get_partial_bp_iterations());
+        genome->set_training_series_fraction(1.0);
+        genome->set_keep_optimizer_state(false);
+        if (early_stop_grace > 0) genome->set_early_stop(get_island_fitness_threshold(genome->get_island()), early_stop_grace);
+
+        return genome;
+    }
+
     //check_on_island returns -1 if no island was killed, or the island number otherwise
     int32_t revisit_island = check_on_island();
     
@@ -546,15 +1156,19 @@ RNN_Genome* EXAMM::generate_genome() {
     //an island in a round robin manner
     //int32_t island = revisit_island != -1 ? revisit_island : generated_genomes % number_islands;
 
-    int32_t island = generated_genomes % number_islands;
-
-    generated_genomes++;
+    int32_t generation_id = ++generated_genomes;
+    int32_t island = (generation_id - 1) % number_islands;
 
     RNN_Genome *genome = NULL;
 
-    if (island_states[island] == ISLAND_INITIALIZING) {
+    island_mutexes[island].lock();
+    int32_t island_state = island_states[island];
+    bool island_empty = genomes[island].size() == 0;
+    island_mutexes[island].unlock();
 
-        if (genomes[island].size() == 0) {
+    if (island_state == ISLAND_INITIALIZING) {
+
+        if (island_empty) {
             //this is the first genome to be generated
             //generate minimal genome, insert it into the population
             genome = create_ff(number_inputs, 0, 0, number_outputs, 0);
@@ -562,8 +1176,12 @@ RNN_Genome* EXAMM::generate_genome() {
             genome->set_parameter_names(input_parameter_names, output_parameter_names);
             genome->set_normalize_bounds(normalize_mins, normalize_maxs);
 
-            edge_innovation_count = genome->edges.size() + genome->recurrent_edges.size();
-            node_innovation_count = genome->nodes.size();
+            //every island starts from this same minimal genome, so the counts
+            //only need setting if no thread has created innovations yet
+            int32_t no_innovations = 0;
+            edge_innovation_count.compare_exchange_strong(no_innovations, innovation_offset + genome->edges.size() + genome->recurrent_edges.size());
+            no_innovations = 0;
+            node_innovation_count.compare_exchange_strong(no_innovations, innovation_offset + genome->nodes.size());
 
             genome->set_generated_by("initial");
             initialize_genome_parameters(genome);
@@ -583,8 +1201,9 @@ RNN_Genome* EXAMM::generate_genome() {
             insert_genome(genome->copy());
         } else {
             while (genome == NULL) {
-                int32_t genome_position = genomes[island].size() * rng_0_1(generator);
-                genome = genomes[island][genome_position]->copy();
+                genome = copy_random_genome(island);
+                //the island was cleared since its state was read
+                if (genome == NULL) break;
                 mutate(genome);
 
                 genome->set_normalize_bounds(normalize_mins, normalize_maxs);
@@ -597,83 +1216,92 @@ RNN_Genome* EXAMM::generate_genome() {
                 }
             }
 
-            //the population hasn't been filled yet, so insert a copy of
-            //the genome into the population so it can be further mutated
-            RNN_Genome *copy = genome->copy();
-            copy->initialize_randomly();
-            double _mu, _sigma;
-            cout << "getting mu/sigma after random initialization of copy!" << endl;
-            genome->get_mu_sigma(genome->best_parameters, _mu, _sigma);
-
-            insert_genome(copy);
-
-            //also randomly initialize this genome as
-            //what it was generated from was also randomly
-            //initialized as the population hasn't been
-            //filled
-            genome->initialize_randomly();
-            cout << "getting mu/sigma after random initialization due to genomes.size() < population_size!" << endl;
-            genome->get_mu_sigma(genome->best_parameters, _mu, _sigma);
+            if (genome != NULL) {
+                //the population hasn't been filled yet, so insert a copy of
+                //the genome into the population so it can be further mutated
+                RNN_Genome *copy = genome->copy();
+                copy->initialize_randomly();
+                double _mu, _sigma;
+                cout << "getting mu/sigma after random initialization of copy!" << endl;
+                genome->get_mu_sigma(genome->best_parameters, _mu, _sigma);
+
+                insert_genome(copy);
+
+                //also randomly initialize this genome as
+                //what it was generated from was also randomly
+                //initialized as the population hasn't been
+                //filled
+                genome->initialize_randomly();
+                cout << "getting mu/sigma after random initialization due to genomes.size() < population_size!" << endl;
+                genome->get_mu_sigma(genome->best_parameters, _mu, _sigma);
+            }
         }
 
-    } else if (island_states[island] == ISLAND_FILLED) {
+    } else if (island_state == ISLAND_FILLED) {
         //generate a genome via crossover or mutation
 
-        cout << "generating new genome, genomes[" << island << "].size(): " << genomes[island].size() << ", population_size: " << population_size << ", crossover_rate: " << crossover_rate << endl;
+        cout << "generating new genome for island " << island << ", population_size: " << population_size << ", crossover_rate: " << crossover_rate << endl;
 
         while (genome == NULL) {
             //if we haven't filled the island populations yet, only
             //use mutation
             //otherwise do mutation at %, crossover at %, and island crossover at %
 
-            double r = rng_0_1(generator);
+            double r = rng_0_1(generator());
+            //parents are copied out of the populations, so mutation and
+            //crossover run without holding any island lock
             if (!populations_full() || r < mutation_rate) {
-                int32_t genome_position = genomes[island].size() * rng_0_1(generator);
-                genome = genomes[island][genome_position]->copy();
+                genome = copy_random_genome(island);
+                if (genome == NULL) break;
                 mutate(genome);
 
                 genome->set_normalize_bounds(normalize_mins, normalize_maxs);
                 genome->set_island(island);
             } else if (r < crossover_rate || number_islands == 1) {
                 //intra-island crossover
-
-                //select two distinct parent genomes in the same island
-                int32_t p1 = genomes[island].size() * rng_0_1(generator);
-                int32_t p2 = (genomes[island].size() - 1) * rng_0_1(generator);
-                if (p2 >= p1) p2++;
-
-                //swap so the first parent is the more fit parent
-                if (p1 > p2) {
-                    int32_t tmp = p1;
-                    p1 = p2;
-                    p2 = tmp;
+                RNN_Genome *p1, *p2;
+                if (copy_crossover_parents(island, p1, p2)) {
+                    genome = crossover(p1, p2);
+
+                    delete p1;
+                    delete p2;
+                } else {
+                    //too few genomes left in the island to cross over
+                    genome = copy_random_genome(island);
+                    if (genome == NULL) break;
+                    mutate(genome);
                 }
 
-                genome = crossover(genomes[island][p1], genomes[island][p2]);
                 genome->set_normalize_bounds(normalize_mins, normalize_maxs);
                 genome->set_island(island);
             } else {
                 //inter-island crossover
 
-                //select two distinct parent genomes in the same island
-                int32_t p1 = genomes[island].size() * rng_0_1(generator);
-
                 //select a different island randomly
-                //int32_t other_island = rng_0_1(generator) * (number_islands - 1);
+                //int32_t other_island = rng_0_1(generator()) * (number_islands - 1);
                 //if (other_island >= island) other_island++;
 
                 int other_island = -1;
                 double best_other_fitness = EXAMM_MAX_DOUBLE;
                 for (int32_t i = 0; i < genomes.size(); i++) {
                     if (i == island) continue;
-                    if (genomes[i][0]->get_fitness() < best_other_fitness) {
+
+                    lock_guard<mutex> lock(island_mutexes[i]);
+                    if (genomes[i].size() > 0 && genomes[i][0]->get_fitness() < best_other_fitness) {
                         other_island = i;
                         best_other_fitness = genomes[i][0]->get_fitness();
                     }
                 }
 
-                RNN_Genome *g1 = genomes[island][p1];
-                RNN_Genome *g2 = genomes[other_island][0];
+                //the other island may have been cleared since it was looked at
+                RNN_Genome *g2 = other_island < 0 ? NULL : copy_best_genome(other_island);
+                if (g2 == NULL) continue;
+
+                RNN_Genome *g1 = copy_random_genome(island);
+                if (g1 == NULL) {
+                    delete g2;
+                    break;
+                }
 
                 //swap so the first parent is the more fit parent
                 if (g1->get_fitness() > g2->get_fitness()) {
@@ -686,6 +1314,9 @@ RNN_Genome* EXAMM::generate_genome() {
                 genome->set_normalize_bounds(normalize_mins, normalize_maxs);
                 genome->set_island(island);
                 //genome->set_bp_iterations(2 * bp_iterations);
+
+                delete g1;
+                delete g2;
             }
 
             if (genome->outputs_unreachable()) {
@@ -695,7 +1326,7 @@ RNN_Genome* EXAMM::generate_genome() {
             }
         }
 
-    } else if (island_states[island] == ISLAND_REPOPULATING) {
+    } else if (island_state == ISLAND_REPOPULATING) {
         //here's where you put your repopulation code
         //select two other islands (non-overlapping) at random, and select genomes
         //from within those islands and generate a child via crossover
@@ -703,25 +1334,58 @@ RNN_Genome* EXAMM::generate_genome() {
         //note: don't kill an island if you still are repopulating an island
 
     } else {
-        cerr << "ERROR: unknown island state (" << island_states[island] << ")" << endl;
+        cerr << "ERROR: unknown island state (" << island_state << ")" << endl;
         cerr << "This should never happen!" << endl;
         exit(1);
     }
 
+    if (genome == NULL && island_state != ISLAND_REPOPULATING) {
+        //check_on_island cleared the island while this genome was being
+        //generated, so start over from its new state
+        return generate_genome();
+    }
+
     //genome->write_graphviz(output_directory + "/rnn_genome_" + to_string(generated_genomes) + ".gv");
     //genome->write_to_file(output_directory + "/rnn_genome_" + to_string(generated_genomes) + ".bin");
 
     if (!epigenetic_weights) genome->initialize_randomly();
 
-    genome->set_generation_id(generated_genomes);
+    if (early_stop_grace > 0) genome->set_early_stop(get_island_fitness_threshold(island), early_stop_grace);
+
+    genome->set_generation_id(generation_id);
+
+    if (halving_bp_fraction > 0.0) {
+        genome->set_bp_iterations(get_partial_bp_iterations());
+        genome->set_training_series_fraction(halving_series_fraction);
+        genome->set_keep_optimizer_state(true);
+
+        int32_t clears;
+        {
+            lock_guard<mutex> lock(island_mutexes[island]);
+            clears = island_clears[island];
+        }
+
+        lock_guard<mutex> lock(halving_mutex);
+        partial_generation_ids.insert(generation_id);
+        halving_island_clears[generation_id] = clears;
+    }
+
     return genome;
 }
 
 int EXAMM::get_random_node_type() {
-    return possible_node_types[rng_0_1(generator) * possible_node_types.size()];
+    return possible_node_types[rng_0_1(generator()) * possible_node_types.size()];
 }
 
 Distribution *EXAMM::get_recurrent_depth_dist(int32_t island_index) {
+    //the normal and histogram dists are built from the populations
+    vector< unique_lock<mutex> > locks;
+    if (rec_sampling_distribution == NORMAL_DISTRIBUTION || rec_sampling_distribution == HISTOGRAM_DISTRIBUTION) {
+        for (int32_t i = 0; i < number_islands; i++) {
+            if (rec_sampling_population == GLOBAL_POPULATION || i == island_index) locks.push_back( unique_lock<mutex>(island_mutexes[i]) );
+        }
+    }
+
     Distribution *d = NULL;
     if (rec_sampling_distribution != UNIFORM_DISTRIBUTION) {
         if (rec_sampling_distribution == NORMAL_DISTRIBUTION) {
@@ -735,7 +1399,7 @@ Distribution *EXAMM::get_recurrent_depth_dist(int32_t island_index) {
             else
                 d = new RecDepthHistDist(genomes, min_recurrent_depth, max_recurrent_depth);
         } else { // Must be pheromone dist
-            if (rec_sampling_distribution == ISLAND_POPULATION)
+            if (rec_sampling_population == ISLAND_POPULATION)
                 d = &rec_sampling_pheromone_dists[island_index];
             else
                 d = &rec_sampling_pheromone_dists[0];
@@ -746,6 +1410,19 @@ Distribution *EXAMM::get_recurrent_depth_dist(int32_t island_index) {
     return d;
 }
 
+void EXAMM::deposit_rec_depth_pheromone(RNN_Genome *genome, double prev_fitness) {
+    //only recurrent depths which improved on the parent get pheromone
+    if (rec_sampling_distribution != PHEROMONE_DISTRIBUTION || !(prev_fitness > genome->get_fitness()) || !genome->new_rec_depth.has_value()) return;
+
+    int32_t depth = genome->new_rec_depth.value();
+
+    lock_guard<mutex> lock(pheromone_mutex);
+    if (rec_sampling_population == ISLAND_POPULATION)
+        rec_sampling_pheromone_dists[genome->get_island()].deposit(depth);
+    else
+        rec_sampling_pheromone_dists[0].deposit(depth);
+}
+
 void EXAMM::mutate(RNN_Genome *g) {
     double total = clone_rate + add_edge_rate + add_recurrent_edge_rate + enable_edge_rate + disable_edge_rate + split_edge_rate + add_node_rate + enable_node_rate + disable_node_rate + split_node_rate + merge_node_rate;
 
@@ -773,7 +1450,7 @@ void EXAMM::mutate(RNN_Genome *g) {
 
     while (!modified) {
         g->assign_reachability();
-        double rng = rng_0_1(generator) * total;
+        double rng = rng_0_1(generator()) * total;
         int new_node_type = get_random_node_type();
         string node_type_str = NODE_TYPES[new_node_type];
         cout << "rng: " << rng << ", total: " << total << ", new node type: " << new_node_type << " (" << node_type_str << ")" << endl;
@@ -796,14 +1473,17 @@ void EXAMM::mutate(RNN_Genome *g) {
 
         if (rng < add_recurrent_edge_rate) {
             Distribution *dist = get_recurrent_depth_dist(g->island);
-            modified = g->add_recurrent_edge(mu, sigma, dist, edge_innovation_count);
 
             // Only delete if it is not a pheromone dist,
             // because the pheromone dist has some state information that must remain
             // across iterations
             if (rec_sampling_distribution != PHEROMONE_DISTRIBUTION) {
+                modified = g->add_recurrent_edge(mu, sigma, dist, edge_innovation_count);
                 delete dist;
             } else {
+                lock_guard<mutex> lock(pheromone_mutex);
+                modified = g->add_recurrent_edge(mu, sigma, dist, edge_innovation_count);
+
                 RecDepthPheromoneDist* d = (RecDepthPheromoneDist *) dist;
                 d->decay();
             }
@@ -942,7 +1622,7 @@ void EXAMM::attempt_edge_insert(vector<RNN_Edge*> &child_edges, vector<RNN_Node_
     vector<double> new_input_weights, new_output_weights;
     double new_weight = 0.0;
     if (second_edge != NULL) {
-        double crossover_value = rng_crossover_weight(generator);
+        double crossover_value = rng_crossover_weight(generator());
         new_weight = crossover_value * (second_edge->weight - edge->weight) + edge->weight;
 
         //cout << "EDGE WEIGHT CROSSOVER :: " << "better: " << edge->weight << ", worse: " << second_edge->weight << ", crossover_value: " << crossover_value << ", new_weight: " << new_weight << endl;
@@ -1017,7 +1697,7 @@ void EXAMM::attempt_recurrent_edge_insert(vector<RNN_Recurrent_Edge*> &child_rec
     vector<double> new_input_weights, new_output_weights;
     double new_weight = 0.0;
     if (second_edge != NULL) {
-        double crossover_value = rng_crossover_weight(generator);
+        double crossover_value = rng_crossover_weight(generator());
         new_weight = crossover_value * (second_edge->weight - recurrent_edge->weight) + recurrent_edge->weight;
 
         //cout << "RECURRENT EDGE WEIGHT CROSSOVER :: " << "better: " << recurrent_edge->weight << ", worse: " << second_edge->weight << ", crossover_value: " << crossover_value << ", new_weight: " << new_weight << endl;
@@ -1130,7 +1810,7 @@ RNN_Genome* EXAMM::crossover(RNN_Genome *p1, RNN_Genome *p2) {
             p1_position++;
             p2_position++;
         } else if (p1_innovation < p2_innovation) {
-            bool set_enabled = rng_0_1(generator) < more_fit_crossover_rate;
+            bool set_enabled = rng_0_1(generator()) < more_fit_crossover_rate;
             if (p1_edge->is_reachable()) set_enabled = true;
             else set_enabled = false;
 
@@ -1138,7 +1818,7 @@ RNN_Genome* EXAMM::crossover(RNN_Genome *p1, RNN_Genome *p2) {
 
             p1_position++;
         } else {
-            bool set_enabled = rng_0_1(generator) < less_fit_crossover_rate;
+            bool set_enabled = rng_0_1(generator()) < less_fit_crossover_rate;
             if (p2_edge->is_reachable()) set_enabled = true;
             else set_enabled = false;
 
@@ -1151,7 +1831,7 @@ RNN_Genome* EXAMM::crossover(RNN_Genome *p1, RNN_Genome *p2) {
     while (p1_position < (int32_t)p1_edges.size()) {
         RNN_Edge* p1_edge = p1_edges[p1_position];
 
-        bool set_enabled = rng_0_1(generator) < more_fit_crossover_rate;
+        bool set_enabled = rng_0_1(generator()) < more_fit_crossover_rate;
         if (p1_edge->is_reachable()) set_enabled = true;
         else set_enabled = false;
 
@@ -1163,7 +1843,7 @@ RNN_Genome* EXAMM::crossover(RNN_Genome *p1, RNN_Genome *p2) {
     while (p2_position < (int32_t)p2_edges.size()) {
         RNN_Edge* p2_edge = p2_edges[p2_position];
 
-        bool set_enabled = rng_0_1(generator) < less_fit_crossover_rate;
+        bool set_enabled = rng_0_1(generator()) < less_fit_crossover_rate;
         if (p2_edge->is_reachable()) set_enabled = true;
         else set_enabled = false;
 
@@ -1190,7 +1870,7 @@ RNN_Genome* EXAMM::crossover(RNN_Genome *p1, RNN_Genome *p2) {
             p1_position++;
             p2_position++;
         } else if (p1_innovation < p2_innovation) {
-            bool set_enabled = rng_0_1(generator) < more_fit_crossover_rate;
+            bool set_enabled = rng_0_1(generator()) < more_fit_crossover_rate;
             if (p1_recurrent_edge->is_reachable()) set_enabled = true;
             else set_enabled = false;
 
@@ -1198,7 +1878,7 @@ RNN_Genome* EXAMM::crossover(RNN_Genome *p1, RNN_Genome *p2) {
 
             p1_position++;
         } else {
-            bool set_enabled = rng_0_1(generator) < less_fit_crossover_rate;
+            bool set_enabled = rng_0_1(generator()) < less_fit_crossover_rate;
             if (p2_recurrent_edge->is_reachable()) set_enabled = true;
             else set_enabled = false;
 
@@ -1211,7 +1891,7 @@ RNN_Genome* EXAMM::crossover(RNN_Genome *p1, RNN_Genome *p2) {
     while (p1_position < (int32_t)p1_recurrent_edges.size()) {
         RNN_Recurrent_Edge* p1_recurrent_edge = p1_recurrent_edges[p1_position];
 
-        bool set_enabled = rng_0_1(generator) < more_fit_crossover_rate;
+        bool set_enabled = rng_0_1(generator()) < more_fit_crossover_rate;
         if (p1_recurrent_edge->is_reachable()) set_enabled = true;
         else set_enabled = false;
 
@@ -1223,7 +1903,7 @@ RNN_Genome* EXAMM::crossover(RNN_Genome *p1, RNN_Genome *p2) {
     while (p2_position < (int32_t)p2_recurrent_edges.size()) {
         RNN_Recurrent_Edge* p2_recurrent_edge = p2_recurrent_edges[p2_position];
 
-        bool set_enabled = rng_0_1(generator) < less_fit_crossover_rate;
+        bool set_enabled = rng_0_1(generator()) < less_fit_crossover_rate;
         if (p2_recurrent_edge->is_reachable()) set_enabled = true;
         else set_enabled = false;
 
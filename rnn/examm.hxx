@@ -1,12 +1,28 @@
 #ifndef EXAMM_HXX
 #define EXAMM_HXX
 
+#include <atomic>
+using std::atomic;
+
 #include <fstream>
+using std::istream;
 using std::ofstream;
 
+#include <deque>
+using std::deque;
+
 #include <map>
 using std::map;
 
+#include <mutex>
+using std::mutex;
+
+#include <random>
+using std::minstd_rand0;
+
+#include <set>
+using std::set;
+
 #include <sstream>
 using std::ostringstream;
 
@@ -14,11 +30,17 @@ using std::ostringstream;
 using std::string;
 using std::to_string;
 
+#include <unordered_map>
+using std::unordered_map;
+using std::unordered_multimap;
+
 #include <vector>
 using std::vector;
 
 #include "rnn_genome.hxx"
 
+#include "common/file_writer.hxx"
+
 #define ISLAND_INITIALIZING 0
 #define ISLAND_FILLED 1
 #define ISLAND_REPOPULATING 2
@@ -31,6 +53,14 @@ using std::vector;
 #define NORMAL_DISTRIBUTION 2
 #define PHEROMONE_DISTRIBUTION 3
 
+#define EXAMM_CHECKPOINT_VERSION 4
+
+//for reading checkpoints, these exit with an error naming what couldn't be
+//read if the file is truncated. a string's length is checked against the
+//rest of the file before anything is allocated for it
+void check_checkpoint(istream &in, string filename, string name);
+void read_checkpoint_string(istream &in, int64_t file_size, string &s, string filename, string name);
+
 // Forward declare this
 class RecDepthPheromoneDist;
 
@@ -39,20 +69,46 @@ class EXAMM {
         int32_t population_size;
         int32_t number_islands;
 
+        //island_states[i], island_clears[i], genomes[i] and genome_hashes[i]
+        //are guarded by island_mutexes[i]. code that needs more than one
+        //island at a time either takes them one after another or takes all
+        //of them in order
+        vector<mutex> island_mutexes;
         vector<int32_t> island_states;
+        //how many times each island has been cleared by check_on_island
+        vector<int32_t> island_clears;
         vector< vector<RNN_Genome*> > genomes;
 
+        //the genomes of each island by structural hash, so looking for a
+        //duplicate only calls equals on genomes with the same hash
+        vector< unordered_multimap<uint64_t, RNN_Genome*> > genome_hashes;
+
+        //the serialized genomes of each island, so that checkpoints only have
+        //to serialize the genomes inserted since the previous one
+        vector< unordered_map<RNN_Genome*, string> > checkpointed_genomes;
+
         int32_t max_genomes;
-        int32_t generated_genomes;
-        int32_t inserted_genomes;
-        int32_t total_bp_epochs;
+        atomic<int32_t> generated_genomes;
+        //migrants inserted from other searches, these don't count towards max_genomes
+        atomic<int32_t> migrated_genomes;
+        atomic<int32_t> inserted_genomes;
+        atomic<int32_t> total_bp_epochs;
 
         int32_t num_genomes_check_on_island;
         string check_on_island_method;
+        //the number of inserted genomes the islands were last checked at
+        atomic<int32_t> island_check_count;
+
+        atomic<int32_t> edge_innovation_count;
+        atomic<int32_t> node_innovation_count;
 
-        int32_t edge_innovation_count;
-        int32_t node_innovation_count;
+        //where this search's new innovation numbers start after the ones used
+        //by the minimal genome, so searches exchanging genomes can each be
+        //given their own range
+        int32_t innovation_offset;
 
+        //guards the generation maps, the fitness logs and printing the populations
+        mutex log_mutex;
         map<string, int32_t> inserted_from_map;
         map<string, int32_t> generated_from_map;
 
@@ -70,9 +126,28 @@ class EXAMM {
         bool use_dropout;
         double dropout_probability;
 
-        minstd_rand0 generator;
-        uniform_real_distribution<double> rng_0_1;
-        uniform_real_distribution<double> rng_crossover_weight;
+        //iterations a genome trains for before it can be stopped early, 0 disables
+        int32_t early_stop_grace;
+
+        //successive halving: genomes are first trained for a fraction of the
+        //bp iterations (on a fraction of the series), and once halving_rung_size
+        //of them are done the best halving_promote_fraction continue training
+        //where they left off, optimizer state included. a bp fraction of 0
+        //trains every genome fully
+        double halving_bp_fraction;
+        double halving_series_fraction;
+        double halving_promote_fraction;
+        int32_t halving_rung_size;
+
+        mutex halving_mutex;
+        int32_t partial_genomes;
+        set<int32_t> partial_generation_ids;
+        //the number of times its island had been cleared when each partial
+        //genome was generated, a promoted genome isn't inserted into an
+        //island which has been cleared since
+        map<int32_t, int32_t> halving_island_clears;
+        vector<RNN_Genome*> halving_rung;
+        deque<RNN_Genome*> promoted_genomes;
 
         int32_t min_recurrent_depth;
         int32_t max_recurrent_depth;
@@ -102,7 +177,14 @@ class EXAMM {
         vector<int> possible_node_types;
 
         string output_directory;
-        ofstream *log_file;
+
+        //best genomes, the fitness log and the populations are written out
+        //by a background thread so inserting genomes doesn't wait on them
+        FileWriter *writer;
+
+        //the fitness log is started on the first write so resuming from a
+        //checkpoint appends to it instead
+        bool fitness_log_started;
 
         vector<string> input_parameter_names;
         vector<string> output_parameter_names;
@@ -113,6 +195,25 @@ class EXAMM {
         ostringstream memory_log;
 
         std::chrono::time_point<std::chrono::system_clock> startClock;
+
+        //every thread generating genomes draws from its own generator, so
+        //mutation and crossover don't need a lock. each generator is seeded
+        //from the search seed and the number of generators seeded before it;
+        //both are checkpointed, so a resumed search gives its threads streams
+        //it hasn't used yet.
+        uint64_t generator_seed;
+        atomic<int64_t> generator_streams;
+        atomic<int32_t> generator_epoch;
+
+        minstd_rand0& generator();
+
+        //the pheromone dists are sampled, decayed and deposited to by
+        //every thread generating or inserting genomes
+        mutex pheromone_mutex;
+
+        RNN_Genome* copy_random_genome(int32_t island);
+        RNN_Genome* copy_best_genome(int32_t island);
+        bool copy_crossover_parents(int32_t island, RNN_Genome* &p1, RNN_Genome* &p2);
     
     public:
         int32_t rec_sampling_population;
@@ -140,13 +241,23 @@ class EXAMM {
         void write_memory_log(string filename);
 
         void set_possible_node_types(vector<string> possible_node_type_strings);
+        void set_early_stop_grace(int32_t _early_stop_grace);
+        void set_successive_halving(double _halving_bp_fraction, double _halving_series_fraction, double _halving_promote_fraction, int32_t _halving_rung_size);
+        void set_innovation_offset(int32_t _innovation_offset);
+
+        double get_island_fitness_threshold(int32_t island);
 
         int32_t population_contains(RNN_Genome* genome, int32_t island);
-        bool populations_full() const;
+        void remove_indexed_genome(int32_t island, RNN_Genome* genome);
+        bool populations_full();
 
         bool insert_genome(RNN_Genome* genome);
+        bool insert_migrant(RNN_Genome* genome);
+        void rank_partial_genome(RNN_Genome* genome);
+        int32_t get_partial_bp_iterations() const;
 
         Distribution *get_recurrent_depth_dist(int32_t island);
+        void deposit_rec_depth_pheromone(RNN_Genome *genome, double prev_fitness);
 
         int get_random_node_type();
 
@@ -163,6 +274,8 @@ class EXAMM {
         void attempt_recurrent_edge_insert(vector<RNN_Recurrent_Edge*> &child_recurrent_edges, vector<RNN_Node_Interface*> &child_nodes, RNN_Recurrent_Edge *recurrent_edge, RNN_Recurrent_Edge *second_edge, bool set_enabled);
         RNN_Genome* crossover(RNN_Genome *p1, RNN_Genome *p2);
 
+        //these return genomes still in the populations, so they should not
+        //be used while other threads may be inserting genomes
         RNN_Genome* get_best_genome();
         RNN_Genome* get_worst_genome();
 
@@ -170,6 +283,11 @@ class EXAMM {
         double get_worst_fitness();
 
         string get_output_directory() const;
+
+        //checkpoints can be written while other threads generate and insert
+        //genomes, they should be read before the search starts
+        void write_checkpoint(string filename);
+        void read_checkpoint(string filename);
 };
 
 #endif
@@ -55,21 +55,21 @@ void GRU_Node::initialize_randomly(minstd_rand0 &generator, NormalDistribution &
 double GRU_Node::get_gradient(string gradient_name) {
     double gradient_sum = 0.0;
 
-    for (uint32_t i = 0; i < series_length; i++ ) {
+    for (int32_t i = 0; i < series_length * batch_size; i++) {
         if (gradient_name == "zw") {
-            gradient_sum += d_zw[i];
+            gradient_sum += d_z_bias[i] * input_values[i];
         } else if (gradient_name == "zu") {
             gradient_sum += d_zu[i];
         } else if (gradient_name == "z_bias") {
             gradient_sum += d_z_bias[i];
         } else if (gradient_name == "rw") {
-            gradient_sum += d_rw[i];
+            gradient_sum += d_r_bias[i] * input_values[i];
         } else if (gradient_name == "ru") {
             gradient_sum += d_ru[i];
         } else if (gradient_name == "r_bias") {
             gradient_sum += d_r_bias[i];
         } else if (gradient_name == "hw") {
-            gradient_sum += d_hw[i];
+            gradient_sum += d_h_bias[i] * input_values[i];
         } else if (gradient_name == "hu") {
             gradient_sum += d_hu[i];
         } else if (gradient_name == "h_bias") {
@@ -87,146 +87,128 @@ void GRU_Node::print_gradient(string gradient_name) {
     cout << "\tgradient['" << gradient_name << "']: " << get_gradient(gradient_name) << endl;
 }
 
-void GRU_Node::input_fired(int time, double incoming_output) {
-    inputs_fired[time]++;
+void GRU_Node::project_inputs(int32_t start_time, int32_t end_time) {
+    double z_weight = zw;
+    double r_weight = rw;
+    double h_weight = hw;
 
-    input_values[time] += incoming_output;
+    double z_bias_value = z_bias;
+    double r_bias_value = r_bias;
+    double h_bias_value = h_bias;
 
-    if (inputs_fired[time] < total_inputs) return;
-    else if (inputs_fired[time] > total_inputs) {
-        cerr << "ERROR: inputs_fired on GRU_Node " << innovation_number << " at time " << time << " is " << inputs_fired[time] << " and total_inputs is " << total_inputs << endl;
-        exit(1);
+    //z, r and h_tanh start out as the input part of their sums
+    for (int32_t i = start_time * batch_size; i < end_time * batch_size; i++) {
+        double x = input_values[i];
+
+        z[i] = z_bias_value + x * z_weight;
+        r[i] = r_bias_value + x * r_weight;
+        h_tanh[i] = h_bias_value + x * h_weight;
     }
+}
 
-    //update the reset gate bias so its centered around 1
-    //r_bias += 1;
+void GRU_Node::forward_pass(int32_t time) {
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        int32_t current = (time * batch_size) + lane;
 
-    //cout << "PROPAGATING FORWARD" << endl;
+        //update the reset gate bias so its centered around 1
+        //r_bias += 1;
 
-    double x = input_values[time];
-    //cout << "node " << innovation_number << " - input value[" << time << "] (x): " << x << endl;
+        //cout << "PROPAGATING FORWARD" << endl;
 
-    double h_prev = 0.0;
-    if (time > 0) h_prev = output_values[time - 1];
-    //cout << "node " << innovation_number << " - prev_output_value[" << time << "] (h_prev): " << h_prev << endl;
+        double h_prev = output_values[current - batch_size];
+        //cout << "node " << innovation_number << " - prev_output_value[" << time << "] (h_prev): " << h_prev << endl;
 
-    //cout << "r_bias: " << r_bias << endl;
+        //cout << "r_bias: " << r_bias << endl;
 
-    double hzu = h_prev * zu;
-    double xzw = x * zw;
-    double z_sum = z_bias + hzu + xzw;
+        double hzu = h_prev * zu;
+        double z_sum = z[current] + hzu;
 
-    z[time] = sigmoid(z_sum);
-    ld_z[time] = sigmoid_derivative(z[time]);
+        z[current] = sigmoid(z_sum);
+        ld_z[current] = sigmoid_derivative(z[current]);
 
-    double z_h_prev = h_prev * z[time];
+        double z_h_prev = h_prev * z[current];
 
-    double xhw = x * hw;
-    double xrw = x * rw;
-    double hru = h_prev * ru;
+        double hru = h_prev * ru;
 
-    double r_sum = r_bias + xrw + hru;
+        double r_sum = r[current] + hru;
 
-    r[time] = sigmoid(r_sum);
-    ld_r[time] = sigmoid_derivative(r[time]);
+        r[current] = sigmoid(r_sum);
+        ld_r[current] = sigmoid_derivative(r[current]);
 
-    double hu_r_h_prev = hu * r[time] * h_prev;
+        double hu_r_h_prev = hu * r[current] * h_prev;
 
-    double h_sum = h_bias + xhw + hu_r_h_prev;
+        double h_sum = h_tanh[current] + hu_r_h_prev;
 
-    h_tanh[time] = tanh(h_sum);
-    ld_h_tanh[time] = tanh_derivative(h_tanh[time]);
+        h_tanh[current] = tanh(h_sum);
+        ld_h_tanh[current] = tanh_derivative(h_tanh[current]);
 
-    output_values[time] = z_h_prev + (1 - z[time]) * h_tanh[time];
+        output_values[current] = z_h_prev + (1 - z[current]) * h_tanh[current];
 
-    //reset alpha, beta1, beta2 so they don't mess with mean/stddev calculations for
-    //parameter generation
-    //r_bias -= 1.0;
+        //reset alpha, beta1, beta2 so they don't mess with mean/stddev calculations for
+        //parameter generation
+        //r_bias -= 1.0;
 
-    //cout << "node " << innovation_number << " - output_values[" << time << "]: " << output_values[time] << endl;
-}
-
-void GRU_Node::try_update_deltas(int time) {
-    if (outputs_fired[time] < total_outputs) return;
-    else if (outputs_fired[time] > total_outputs) {
-        cerr << "ERROR: outputs_fired on GRU_Node " << innovation_number << " at time " << time << " is " << outputs_fired[time] << " and total_outputs is " << total_outputs << endl;
-        exit(1);
+        //cout << "node " << innovation_number << " - output_values[" << time << "]: " << output_values[time] << endl;
     }
+}
 
-    //cout << "PROPAGATING BACKWARDS" << endl;
-    //update the reset gate bias so its centered around 1   
-    //r_bias += 1.0;
-
-    double error = error_values[time];
-    //cout << "error_values[time]: " << error << endl;
-    double x = input_values[time];
-    //cout << "input value[" << time << "]:" << x << endl;
-
-    double h_prev = 0.0;
-    if (time > 0) h_prev = output_values[time - 1];
-    //cout << "h_prev[" << (time - 1) << "]: " << h_prev << endl;
+void GRU_Node::backward_pass(int32_t time, const double *deltas) {
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        int32_t current = (time * batch_size) + lane;
 
+        //cout << "PROPAGATING BACKWARDS" << endl;
+        //update the reset gate bias so its centered around 1   
+        //r_bias += 1.0;
 
-    //backprop output gate
-    double d_h = error;
-    if (time < (series_length - 1)) d_h += d_h_prev[time + 1];
-    //get the error into the output (z), it's the error from ahead in the network
-    //as well as from the previous output of the cell
+        double error = deltas[lane];
+        //cout << "error_values[time]: " << error << endl;
 
-    //cout << "d_z: " << d_z << endl;
-    //cout << "ld_z_cap[" << time << "]: " << ld_z_cap[time] << endl;
+        double h_prev = output_values[current - batch_size];
+        //cout << "h_prev[" << (time - 1) << "]: " << h_prev << endl;
 
-    d_h_prev[time] = d_h * z[time];
 
-    double d_z = ((d_h * h_prev) - (d_h * h_tanh[time])) * ld_z[time];
-    d_z_bias[time] = d_z;
-    d_zu[time] = d_z * h_prev;
-    d_h_prev[time] += d_z * zu;
-    d_zw[time] = d_z * x;
-    d_input[time] = d_z * zw;
+        //backprop output gate
+        double d_h = error;
+        if (time < (series_length - 1)) d_h += d_h_prev[current + batch_size];
+        //get the error into the output (z), it's the error from ahead in the network
+        //as well as from the previous output of the cell
 
-    double d_h_tanh = (1 - z[time]) * d_h * ld_h_tanh[time];
+        //cout << "d_z: " << d_z << endl;
+        //cout << "ld_z_cap[" << time << "]: " << ld_z_cap[time] << endl;
 
-    d_input[time] += d_h_tanh * hw;
-    d_hw[time] = d_h_tanh * x;
+        d_h_prev[current] = d_h * z[current];
 
-    d_h_bias[time] = d_h_tanh;
+        double d_z = ((d_h * h_prev) - (d_h * h_tanh[current])) * ld_z[current];
+        d_z_bias[current] = d_z;
+        d_zu[current] = d_z * h_prev;
+        d_h_prev[current] += d_z * zu;
+        d_input[current] = d_z * zw;
 
-    d_hu[time] = d_h_tanh * r[time] * h_prev;
-    double d_r = d_h_tanh * hu * h_prev * ld_r[time];
+        double d_h_tanh = (1 - z[current]) * d_h * ld_h_tanh[current];
 
-    d_h_prev[time] += d_h_tanh * hu * r[time];
+        d_input[current] += d_h_tanh * hw;
 
-    d_r_bias[time] = d_r;
-    d_ru[time] = d_r * h_prev;
-    d_h_prev[time] += d_r * ru;
+        d_h_bias[current] = d_h_tanh;
 
-    d_rw[time] = d_r * x;
-    d_input[time] += d_r * rw;
+        d_hu[current] = d_h_tanh * r[current] * h_prev;
+        double d_r = d_h_tanh * hu * h_prev * ld_r[current];
 
-    //cout << "d_input: " << d_input[time] << endl;
-    //cout << "d_beta2: " << d_beta2[time] << endl;
+        d_h_prev[current] += d_h_tanh * hu * r[current];
 
-    //cout << endl << endl;
+        d_r_bias[current] = d_r;
+        d_ru[current] = d_r * h_prev;
+        d_h_prev[current] += d_r * ru;
 
-    //reset the reset gate bias to be around 0
-    //r_bias -= 1.0;
-}
+        d_input[current] += d_r * rw;
 
-void GRU_Node::error_fired(int time, double error) {
-    outputs_fired[time]++;
+        //cout << "d_input: " << d_input[time] << endl;
+        //cout << "d_beta2: " << d_beta2[time] << endl;
 
-    error_values[time] *= error;
-
-    try_update_deltas(time);
-}
+        //cout << endl << endl;
 
-void GRU_Node::output_fired(int time, double delta) {
-    outputs_fired[time]++;
-
-    error_values[time] += delta;
-
-    try_update_deltas(time);
+        //reset the reset gate bias to be around 0
+        //r_bias -= 1.0;
+    }
 }
 
 
@@ -306,16 +288,16 @@ void GRU_Node::get_gradients(vector<double> &gradients) {
         gradients[i] = 0.0;
     }
 
-    for (uint32_t i = 0; i < series_length; i++) {
-        gradients[0] += d_zw[i];
+    for (int32_t i = 0; i < series_length * batch_size; i++) {
+        gradients[0] += d_z_bias[i] * input_values[i];
         gradients[1] += d_zu[i];
         gradients[2] += d_z_bias[i];
 
-        gradients[3] += d_rw[i];
+        gradients[3] += d_r_bias[i] * input_values[i];
         gradients[4] += d_ru[i];
         gradients[5] += d_r_bias[i];
 
-        gradients[6] += d_hw[i];
+        gradients[6] += d_h_bias[i] * input_values[i];
         gradients[7] += d_hu[i];
         gradients[8] += d_h_bias[i];
     }
@@ -323,37 +305,26 @@ void GRU_Node::get_gradients(vector<double> &gradients) {
 
 void GRU_Node::reset(int _series_length) {
     series_length = _series_length;
+}
 
-    d_zw.assign(series_length, 0.0);
-    d_zu.assign(series_length, 0.0);
-    d_z_bias.assign(series_length, 0.0);
-
-    d_rw.assign(series_length, 0.0);
-    d_ru.assign(series_length, 0.0);
-    d_r_bias.assign(series_length, 0.0);
-
-    d_hw.assign(series_length, 0.0);
-    d_hu.assign(series_length, 0.0);
-    d_h_bias.assign(series_length, 0.0);
-
-    d_h_prev.assign(series_length, 0.0);
-
-    z.assign(series_length, 0.0);
-    ld_z.assign(series_length, 0.0);
-    r.assign(series_length, 0.0);
-    ld_r.assign(series_length, 0.0);
-    h_tanh.assign(series_length, 0.0);
-    ld_h_tanh.assign(series_length, 0.0);
+void GRU_Node::get_series_arrays(vector<double**> &arrays) {
+    RNN_Node_Interface::get_series_arrays(arrays);
 
-    //reset values from rnn_node_interface
-    d_input.assign(series_length, 0.0);
-    error_values.assign(series_length, 0.0);
+    arrays.push_back(&d_zu);
+    arrays.push_back(&d_z_bias);
+    arrays.push_back(&d_ru);
+    arrays.push_back(&d_r_bias);
+    arrays.push_back(&d_hu);
+    arrays.push_back(&d_h_bias);
 
-    input_values.assign(series_length, 0.0);
-    output_values.assign(series_length, 0.0);
+    arrays.push_back(&d_h_prev);
 
-    inputs_fired.assign(series_length, 0);
-    outputs_fired.assign(series_length, 0);
+    arrays.push_back(&z);
+    arrays.push_back(&ld_z);
+    arrays.push_back(&r);
+    arrays.push_back(&ld_r);
+    arrays.push_back(&h_tanh);
+    arrays.push_back(&ld_h_tanh);
 }
 
 RNN_Node_Interface* GRU_Node::copy() const {
@@ -372,35 +343,10 @@ RNN_Node_Interface* GRU_Node::copy() const {
     n->hu = hu;
     n->h_bias = h_bias;
 
-    n->d_zw = d_zw;
-    n->d_zu = d_zu;
-    n->d_z_bias = d_z_bias;
-    n->d_rw = d_rw;
-    n->d_ru = d_ru;
-    n->d_r_bias = d_r_bias;
-    n->d_hw = d_hw;
-    n->d_hu = d_hu;
-    n->d_h_bias = d_h_bias;
-
-    n->d_h_prev = d_h_prev;
-
-    n->z = z;
-    n->ld_z = ld_z;
-    n->r = r;
-    n->ld_r = ld_r;
-    n->h_tanh = h_tanh;
-    n->ld_h_tanh = ld_h_tanh;
-
     //copy RNN_Node_Interface values
     n->series_length = series_length;
-    n->input_values = input_values;
-    n->output_values = output_values;
-    n->error_values = error_values;
-    n->d_input = d_input;
 
-    n->inputs_fired = inputs_fired;
     n->total_inputs = total_inputs;
-    n->outputs_fired = outputs_fired;
     n->total_outputs = total_outputs;
     n->enabled = enabled;
     n->forward_reachable = forward_reachable;
@@ -29,24 +29,21 @@ class GRU_Node : public RNN_Node_Interface {
         double hu;
         double h_bias;
 
-        vector<double> d_zw;
-        vector<double> d_zu;
-        vector<double> d_z_bias;
-        vector<double> d_rw;
-        vector<double> d_ru;
-        vector<double> d_r_bias;
-        vector<double> d_hw;
-        vector<double> d_hu;
-        vector<double> d_h_bias;
-
-        vector<double> d_h_prev;
-
-        vector<double> z;
-        vector<double> ld_z;
-        vector<double> r;
-        vector<double> ld_r;
-        vector<double> h_tanh;
-        vector<double> ld_h_tanh;
+        double *d_zu;
+        double *d_z_bias;
+        double *d_ru;
+        double *d_r_bias;
+        double *d_hu;
+        double *d_h_bias;
+
+        double *d_h_prev;
+
+        double *z;
+        double *ld_z;
+        double *r;
+        double *ld_r;
+        double *h_tanh;
+        double *ld_h_tanh;
 
     public:
 
@@ -58,11 +55,9 @@ class GRU_Node : public RNN_Node_Interface {
         double get_gradient(string gradient_name);
         void print_gradient(string gradient_name);
 
-        void input_fired(int time, double incoming_output);
-
-        void try_update_deltas(int time);
-        void error_fired(int time, double error);
-        void output_fired(int time, double delta);
+        void project_inputs(int32_t start_time, int32_t end_time);
+        void forward_pass(int32_t time);
+        void backward_pass(int32_t time, const double *deltas);
 
         uint32_t get_number_weights() const;
 
@@ -75,6 +70,7 @@ class GRU_Node : public RNN_Node_Interface {
         void get_gradients(vector<double> &gradients);
 
         void reset(int _series_length);
+        void get_series_arrays(vector<double**> &arrays);
 
         void print_cell_values();
 
@@ -60,27 +60,27 @@ void LSTM_Node::initialize_randomly(minstd_rand0 &generator, NormalDistribution
 double LSTM_Node::get_gradient(string gradient_name) {
     double gradient_sum = 0.0;
 
-    for (uint32_t i = 0; i < series_length; i++ ) {
+    for (int32_t i = 0; i < series_length * batch_size; i++) {
         if (gradient_name == "output_gate_update_weight") {
             gradient_sum += d_output_gate_update_weight[i];
         } else if (gradient_name == "output_gate_weight") {
-            gradient_sum += d_output_gate_weight[i];
+            gradient_sum += d_output_gate_bias[i] * input_values[i];
         } else if (gradient_name == "output_gate_bias") {
             gradient_sum += d_output_gate_bias[i];
         } else if (gradient_name == "input_gate_update_weight") {
             gradient_sum += d_input_gate_update_weight[i];
         } else if (gradient_name == "input_gate_weight") {
-            gradient_sum += d_input_gate_weight[i];
+            gradient_sum += d_input_gate_bias[i] * input_values[i];
         } else if (gradient_name == "input_gate_bias") {
             gradient_sum += d_input_gate_bias[i];
         } else if (gradient_name == "forget_gate_update_weight") {
             gradient_sum += d_forget_gate_update_weight[i];
         } else if (gradient_name == "forget_gate_weight") {
-            gradient_sum += d_forget_gate_weight[i];
+            gradient_sum += d_forget_gate_bias[i] * input_values[i];
         } else if (gradient_name == "forget_gate_bias") {
             gradient_sum += d_forget_gate_bias[i];
         } else if (gradient_name == "cell_weight") {
-            gradient_sum += d_cell_weight[i];
+            gradient_sum += d_cell_bias[i] * input_values[i];
         } else if (gradient_name == "cell_bias") {
             gradient_sum += d_cell_bias[i];
         } else {
@@ -96,61 +96,74 @@ void LSTM_Node::print_gradient(string gradient_name) {
     cout << "\tgradient['" << gradient_name << "']: " << get_gradient(gradient_name) << endl;
 }
 
-void LSTM_Node::input_fired(int time, double incoming_output) {
-    inputs_fired[time]++;
+void LSTM_Node::project_inputs(int32_t start_time, int32_t end_time) {
+    //copy the weights so the compiler knows the stores below can't change them
+    double output_weight = output_gate_weight;
+    double input_weight = input_gate_weight;
+    double forget_weight = forget_gate_weight;
 
-    input_values[time] += incoming_output;
+    double output_bias = output_gate_bias;
+    double input_bias = input_gate_bias;
+    //forget gate bias should be around 1.0 intead of 0, but we do it here to not throw
+    //off the mu/sigma of the parameters
+    double forget_bias = forget_gate_bias + 1.0;
 
-    if (inputs_fired[time] < total_inputs) return;
-    else if (inputs_fired[time] > total_inputs) {
-        cerr << "ERROR: inputs_fired on LSTM_Node " << innovation_number << " at time " << time << " is " << inputs_fired[time] << " and total_inputs is " << total_inputs << endl;
-        exit(1);
-    }
+    double in_weight = cell_weight;
+    double in_bias = cell_bias;
 
-    double input_value = input_values[time];
-    //cout << "node " << innovation_number << " - input value[" << time << "]:" << input_value << endl;
+    int32_t start = start_time * batch_size;
+    int32_t end = end_time * batch_size;
 
-    double previous_cell_value = 0.0;
-    if (time > 0) previous_cell_value = cell_values[time - 1];
-    //previous_cell_value = 0.33;
-    //cout << "previous_cell_value[" << i << "]: " << previous_cell_value << endl;
+    //the gate arrays hold the input terms until forward_pass adds the
+    //recurrent term and applies the activation function
+    for (int32_t i = start; i < end; i++) {
+        output_gate_values[i] = output_weight * input_values[i] + output_bias;
+        input_gate_values[i] = input_weight * input_values[i] + input_bias;
+        forget_gate_values[i] = forget_weight * input_values[i] + forget_bias;
+    }
 
-    //forget gate bias should be around 1.0 intead of 0, but we do it here to not throw
-    //off the mu/sigma of the parameters
-    forget_gate_bias = forget_gate_bias + 1.0;
+    for (int32_t i = start; i < end; i++) {
+        cell_in_tanh[i] = tanh(in_weight * input_values[i] + in_bias);
+        ld_cell_in[i] = tanh_derivative(cell_in_tanh[i]);
+    }
+}
 
-    output_gate_values[time] = sigmoid(output_gate_weight * input_value + output_gate_update_weight * previous_cell_value + output_gate_bias);
-    input_gate_values[time] = sigmoid(input_gate_weight * input_value + input_gate_update_weight * previous_cell_value + input_gate_bias);
-    forget_gate_values[time] = sigmoid(forget_gate_weight * input_value + forget_gate_update_weight * previous_cell_value + forget_gate_bias);
+void LSTM_Node::forward_pass(int32_t time) {
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        int32_t current = (time * batch_size) + lane;
 
-    ld_output_gate[time] = sigmoid_derivative(output_gate_values[time]);
-    ld_input_gate[time] = sigmoid_derivative(input_gate_values[time]);
-    ld_forget_gate[time] = sigmoid_derivative(forget_gate_values[time]);
+        double previous_cell_value = cell_values[current - batch_size];
+        //previous_cell_value = 0.33;
+        //cout << "previous_cell_value[" << i << "]: " << previous_cell_value << endl;
 
-    /*
-       output_gate_values[time] = output_gate_weight * input_value + output_gate_update_weight * previous_cell_value + output_gate_bias;
-       input_gate_values[time] = input_gate_weight * input_value + input_gate_update_weight * previous_cell_value + input_gate_bias;
-       forget_gate_values[time] = forget_gate_weight * input_value + forget_gate_update_weight * previous_cell_value + forget_gate_bias;
+        output_gate_values[current] = sigmoid(output_gate_values[current] + output_gate_update_weight * previous_cell_value);
+        input_gate_values[current] = sigmoid(input_gate_values[current] + input_gate_update_weight * previous_cell_value);
+        forget_gate_values[current] = sigmoid(forget_gate_values[current] + forget_gate_update_weight * previous_cell_value);
 
-       ld_output_gate[time] = 1.0;
-       ld_input_gate[time] = 1.0;
-       ld_forget_gate[time] = 1.0;
-       */
+        ld_output_gate[current] = sigmoid_derivative(output_gate_values[current]);
+        ld_input_gate[current] = sigmoid_derivative(input_gate_values[current]);
+        ld_forget_gate[current] = sigmoid_derivative(forget_gate_values[current]);
 
-    cell_in_tanh[time] = tanh(cell_weight * input_value + cell_bias);
-    ld_cell_in[time] = tanh_derivative(cell_in_tanh[time]);
+        /*
+           output_gate_values[time] = output_gate_weight * input_value + output_gate_update_weight * previous_cell_value + output_gate_bias;
+           input_gate_values[time] = input_gate_weight * input_value + input_gate_update_weight * previous_cell_value + input_gate_bias;
+           forget_gate_values[time] = forget_gate_weight * input_value + forget_gate_update_weight * previous_cell_value + forget_gate_bias;
 
-    cell_values[time] = (forget_gate_values[time] * previous_cell_value) + (input_gate_values[time] * cell_in_tanh[time]);
+           ld_output_gate[time] = 1.0;
+           ld_input_gate[time] = 1.0;
+           ld_forget_gate[time] = 1.0;
+           */
 
-    //The original is a hyperbolic tangent, but the peephole[clarification needed] LSTM paper suggests the activation function be linear -- activation(x) = x
-    cell_out_tanh[time] = cell_values[time];
-    ld_cell_out[time] = 1.0;
-    //cell_out_tanh[time] = tanh(cell_values[time]);
-    //ld_cell_out[time] = tanh_derivative(cell_out_tanh[time]);
+        cell_values[current] = (forget_gate_values[current] * previous_cell_value) + (input_gate_values[current] * cell_in_tanh[current]);
 
-    output_values[time] = output_gate_values[time] * cell_out_tanh[time];
+        //The original is a hyperbolic tangent, but the peephole[clarification needed] LSTM paper suggests the activation function be linear -- activation(x) = x
+        cell_out_tanh[current] = cell_values[current];
+        ld_cell_out[current] = 1.0;
+        //cell_out_tanh[time] = tanh(cell_values[time]);
+        //ld_cell_out[time] = tanh_derivative(cell_out_tanh[time]);
 
-    forget_gate_bias -= 1.0;
+        output_values[current] = output_gate_values[current] * cell_out_tanh[current];
+    }
 }
 
 
@@ -164,77 +177,52 @@ void LSTM_Node::print_cell_values() {
     */
 }
 
-void LSTM_Node::try_update_deltas(int time) {
-    if (outputs_fired[time] < total_outputs) return;
-    else if (outputs_fired[time] > total_outputs) {
-        cerr << "ERROR: outputs_fired on LSTM_Node " << innovation_number << " at time " << time << " is " << outputs_fired[time] << " and total_outputs is " << total_outputs << endl;
-        exit(1);
-    }
+void LSTM_Node::backward_pass(int32_t time, const double *deltas) {
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        int32_t current = (time * batch_size) + lane;
 
-    double error = error_values[time];
-    double input_value = input_values[time];
-    //cout << "input value[" << i << "]:" << input_value << endl;
-
-    double previous_cell_value = 0.00;
-    if (time > 0) previous_cell_value = cell_values[time - 1];
-    //previous_cell_value = 0.33;
-    //cout << "previous_cell_value[" << i << "]: " << previous_cell_value << endl;
-
-
-    //backprop output gate
-    double d_output_gate = error * cell_out_tanh[time] * ld_output_gate[time];
-    d_output_gate_bias[time] = d_output_gate;
-    d_output_gate_update_weight[time] = d_output_gate * previous_cell_value;
-    d_output_gate_weight[time] = d_output_gate * input_value;
-    d_prev_cell[time] += d_output_gate * output_gate_update_weight;
-    d_input[time] += d_output_gate * output_gate_weight;
-
-    //backprop the cell path
-
-    double d_cell_out = error * output_gate_values[time] * ld_cell_out[time];
-    //propagate error back from the next cell value if there is one
-    if (time < (series_length - 1)) d_cell_out += d_prev_cell[time + 1];
-
-    //backprop forget gate
-    d_prev_cell[time] += d_cell_out * forget_gate_values[time];
-
-    double d_forget_gate = d_cell_out * previous_cell_value * ld_forget_gate[time];
-    d_forget_gate_bias[time] = d_forget_gate;
-    d_forget_gate_update_weight[time] = d_forget_gate * previous_cell_value;
-    d_forget_gate_weight[time] = d_forget_gate * input_value;
-    d_prev_cell[time] += d_forget_gate * forget_gate_update_weight;
-    d_input[time] += d_forget_gate * forget_gate_weight;
-
-    //backprob input gate
-    double d_input_gate = d_cell_out * cell_in_tanh[time] * ld_input_gate[time];
-    d_input_gate_bias[time] = d_input_gate;
-    d_input_gate_update_weight[time] = d_input_gate * previous_cell_value;
-    d_input_gate_weight[time] = d_input_gate * input_value;
-    d_prev_cell[time] += d_input_gate * input_gate_update_weight;
-    d_input[time] += d_input_gate * input_gate_weight;
-
-
-    //backprop cell input
-    double d_cell_in = d_cell_out * input_gate_values[time] * ld_cell_in[time];
-    d_cell_bias[time] = d_cell_in;
-    d_cell_weight[time] = d_cell_in * input_value;
-    d_input[time] += d_cell_in * cell_weight;
-}
+        double error = deltas[lane];
 
-void LSTM_Node::error_fired(int time, double error) {
-    outputs_fired[time]++;
+        double previous_cell_value = cell_values[current - batch_size];
+        //previous_cell_value = 0.33;
+        //cout << "previous_cell_value[" << i << "]: " << previous_cell_value << endl;
 
-    error_values[time] *= error;
 
-    try_update_deltas(time);
-}
+        //backprop output gate
+        double d_output_gate = error * cell_out_tanh[current] * ld_output_gate[current];
+        d_output_gate_bias[current] = d_output_gate;
+        d_output_gate_update_weight[current] = d_output_gate * previous_cell_value;
+        d_prev_cell[current] += d_output_gate * output_gate_update_weight;
+        d_input[current] += d_output_gate * output_gate_weight;
+
+        //backprop the cell path
+
+        double d_cell_out = error * output_gate_values[current] * ld_cell_out[current];
+        //propagate error back from the next cell value if there is one
+        if (time < (series_length - 1)) d_cell_out += d_prev_cell[current + batch_size];
 
-void LSTM_Node::output_fired(int time, double delta) {
-    outputs_fired[time]++;
+        //backprop forget gate
+        d_prev_cell[current] += d_cell_out * forget_gate_values[current];
 
-    error_values[time] += delta;
+        double d_forget_gate = d_cell_out * previous_cell_value * ld_forget_gate[current];
+        d_forget_gate_bias[current] = d_forget_gate;
+        d_forget_gate_update_weight[current] = d_forget_gate * previous_cell_value;
+        d_prev_cell[current] += d_forget_gate * forget_gate_update_weight;
+        d_input[current] += d_forget_gate * forget_gate_weight;
 
-    try_update_deltas(time);
+        //backprob input gate
+        double d_input_gate = d_cell_out * cell_in_tanh[current] * ld_input_gate[current];
+        d_input_gate_bias[current] = d_input_gate;
+        d_input_gate_update_weight[current] = d_input_gate * previous_cell_value;
+        d_prev_cell[current] += d_input_gate * input_gate_update_weight;
+        d_input[current] += d_input_gate * input_gate_weight;
+
+
+        //backprop cell input
+        double d_cell_in = d_cell_out * input_gate_values[current] * ld_cell_in[current];
+        d_cell_bias[current] = d_cell_in;
+        d_input[current] += d_cell_in * cell_weight;
+    }
 }
 
 uint32_t LSTM_Node::get_number_weights() const {
@@ -307,66 +295,59 @@ void LSTM_Node::get_gradients(vector<double> &gradients) {
         gradients[i] = 0.0;
     }
 
-    for (uint32_t i = 0; i < series_length; i++) {
+    //the gradient of an input weight is its gate's delta times the input,
+    //so it is summed here instead of being stored for every time step
+    for (int32_t i = 0; i < series_length * batch_size; i++) {
         gradients[0] += d_output_gate_update_weight[i];
-        gradients[1] += d_output_gate_weight[i];
+        gradients[1] += d_output_gate_bias[i] * input_values[i];
         gradients[2] += d_output_gate_bias[i];
 
         gradients[3] += d_input_gate_update_weight[i];
-        gradients[4] += d_input_gate_weight[i];
+        gradients[4] += d_input_gate_bias[i] * input_values[i];
         gradients[5] += d_input_gate_bias[i];
 
         gradients[6] += d_forget_gate_update_weight[i];
-        gradients[7] += d_forget_gate_weight[i];
+        gradients[7] += d_forget_gate_bias[i] * input_values[i];
         gradients[8] += d_forget_gate_bias[i];
 
-        gradients[9] += d_cell_weight[i];
+        gradients[9] += d_cell_bias[i] * input_values[i];
         gradients[10] += d_cell_bias[i];
     }
 }
 
 void LSTM_Node::reset(int _series_length) {
     series_length = _series_length;
+}
 
-    ld_output_gate.assign(series_length, 0.0);
-    ld_input_gate.assign(series_length, 0.0);
-    ld_forget_gate.assign(series_length, 0.0);
-
-    cell_in_tanh.assign(series_length, 0.0);
-    cell_out_tanh.assign(series_length, 0.0);
-    ld_cell_in.assign(series_length, 0.0);
-    ld_cell_out.assign(series_length, 0.0);
-
-    d_input.assign(series_length, 0.0);
-    d_prev_cell.assign(series_length, 0.0);
+void LSTM_Node::get_series_arrays(vector<double**> &arrays) {
+    RNN_Node_Interface::get_series_arrays(arrays);
 
-    d_output_gate_update_weight.assign(series_length, 0.0);
-    d_output_gate_weight.assign(series_length, 0.0);
-    d_output_gate_bias.assign(series_length, 0.0);
+    arrays.push_back(&output_gate_values);
+    arrays.push_back(&input_gate_values);
+    arrays.push_back(&forget_gate_values);
+    arrays.push_back(&cell_values);
 
-    d_input_gate_update_weight.assign(series_length, 0.0);
-    d_input_gate_weight.assign(series_length, 0.0);
-    d_input_gate_bias.assign(series_length, 0.0);
+    arrays.push_back(&ld_output_gate);
+    arrays.push_back(&ld_input_gate);
+    arrays.push_back(&ld_forget_gate);
 
-    d_forget_gate_update_weight.assign(series_length, 0.0);
-    d_forget_gate_weight.assign(series_length, 0.0);
-    d_forget_gate_bias.assign(series_length, 0.0);
+    arrays.push_back(&cell_in_tanh);
+    arrays.push_back(&cell_out_tanh);
+    arrays.push_back(&ld_cell_in);
+    arrays.push_back(&ld_cell_out);
 
-    d_cell_weight.assign(series_length, 0.0);
-    d_cell_bias.assign(series_length, 0.0);
+    arrays.push_back(&d_prev_cell);
 
-    output_gate_values.assign(series_length, 0.0);
-    input_gate_values.assign(series_length, 0.0);
-    forget_gate_values.assign(series_length, 0.0);
-    cell_values.assign(series_length, 0.0);
+    arrays.push_back(&d_output_gate_update_weight);
+    arrays.push_back(&d_output_gate_bias);
 
-    error_values.assign(series_length, 0.0);
+    arrays.push_back(&d_input_gate_update_weight);
+    arrays.push_back(&d_input_gate_bias);
 
-    input_values.assign(series_length, 0.0);
-    output_values.assign(series_length, 0.0);
+    arrays.push_back(&d_forget_gate_update_weight);
+    arrays.push_back(&d_forget_gate_bias);
 
-    inputs_fired.assign(series_length, 0);
-    outputs_fired.assign(series_length, 0);
+    arrays.push_back(&d_cell_bias);
 }
 
 RNN_Node_Interface* LSTM_Node::copy() const {
@@ -388,48 +369,10 @@ RNN_Node_Interface* LSTM_Node::copy() const {
     n->cell_weight = cell_weight;
     n->cell_bias = cell_bias;
 
-    n->output_gate_values = output_gate_values;
-    n->input_gate_values = input_gate_values;
-    n->forget_gate_values = forget_gate_values;
-    n->cell_values = cell_values;
-
-    n->ld_output_gate = ld_output_gate;
-    n->ld_input_gate = ld_input_gate;
-    n->ld_forget_gate = ld_forget_gate;
-
-    n->cell_in_tanh = cell_in_tanh;
-    n->cell_out_tanh = cell_out_tanh;
-    n->ld_cell_in = ld_cell_in;
-    n->ld_cell_out = ld_cell_out;
-
-    n->d_prev_cell = d_prev_cell;
-
-    n->d_output_gate_update_weight = d_output_gate_update_weight;
-    n->d_output_gate_weight = d_output_gate_weight;
-    n->d_output_gate_bias = d_output_gate_bias;
-
-    n->d_input_gate_update_weight = d_input_gate_update_weight;
-    n->d_input_gate_weight = d_input_gate_weight;
-    n->d_input_gate_bias = d_input_gate_bias;
-
-    n->d_forget_gate_update_weight = d_forget_gate_update_weight;
-    n->d_forget_gate_weight = d_forget_gate_weight;
-    n->d_forget_gate_bias = d_forget_gate_bias;
-
-    n->d_cell_weight = d_cell_weight;
-    n->d_cell_bias = d_cell_bias;
-
-
     //copy RNN_Node_Interface values
     n->series_length = series_length;
-    n->input_values = input_values;
-    n->output_values = output_values;
-    n->error_values = error_values;
-    n->d_input = d_input;
 
-    n->inputs_fired = inputs_fired;
     n->total_inputs = total_inputs;
-    n->outputs_fired = outputs_fired;
     n->total_outputs = total_outputs;
     n->enabled = enabled;
     n->forward_reachable = forward_reachable;
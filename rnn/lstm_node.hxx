@@ -32,36 +32,32 @@ class LSTM_Node : public RNN_Node_Interface {
         double cell_weight;
         double cell_bias;
 
-        vector<double> output_gate_values;
-        vector<double> input_gate_values;
-        vector<double> forget_gate_values;
-        vector<double> cell_values;
+        double *output_gate_values;
+        double *input_gate_values;
+        double *forget_gate_values;
+        double *cell_values;
 
-        vector<double> ld_output_gate;
-        vector<double> ld_input_gate;
-        vector<double> ld_forget_gate;
+        double *ld_output_gate;
+        double *ld_input_gate;
+        double *ld_forget_gate;
 
-        vector<double> cell_in_tanh;
-        vector<double> cell_out_tanh;
-        vector<double> ld_cell_in;
-        vector<double> ld_cell_out;
+        double *cell_in_tanh;
+        double *cell_out_tanh;
+        double *ld_cell_in;
+        double *ld_cell_out;
 
-        vector<double> d_prev_cell;
+        double *d_prev_cell;
 
-        vector<double> d_output_gate_update_weight;
-        vector<double> d_output_gate_weight;
-        vector<double> d_output_gate_bias;
+        double *d_output_gate_update_weight;
+        double *d_output_gate_bias;
 
-        vector<double> d_input_gate_update_weight;
-        vector<double> d_input_gate_weight;
-        vector<double> d_input_gate_bias;
+        double *d_input_gate_update_weight;
+        double *d_input_gate_bias;
 
-        vector<double> d_forget_gate_update_weight;
-        vector<double> d_forget_gate_weight;
-        vector<double> d_forget_gate_bias;
+        double *d_forget_gate_update_weight;
+        double *d_forget_gate_bias;
 
-        vector<double> d_cell_weight;
-        vector<double> d_cell_bias;
+        double *d_cell_bias;
 
     public:
 
@@ -73,11 +69,9 @@ class LSTM_Node : public RNN_Node_Interface {
         double get_gradient(string gradient_name);
         void print_gradient(string gradient_name);
 
-        void input_fired(int time, double incoming_output);
-
-        void try_update_deltas(int time);
-        void error_fired(int time, double error);
-        void output_fired(int time, double delta);
+        void project_inputs(int32_t start_time, int32_t end_time);
+        void forward_pass(int32_t time);
+        void backward_pass(int32_t time, const double *deltas);
 
         uint32_t get_number_weights() const;
 
@@ -90,6 +84,7 @@ class LSTM_Node : public RNN_Node_Interface {
         void get_gradients(vector<double> &gradients);
 
         void reset(int _series_length);
+        void get_series_arrays(vector<double**> &arrays);
 
         void print_cell_values();
 
@@ -51,15 +51,15 @@ void MGU_Node::initialize_randomly(minstd_rand0 &generator, NormalDistribution &
 double MGU_Node::get_gradient(string gradient_name) {
     double gradient_sum = 0.0;
 
-    for (uint32_t i = 0; i < series_length; i++ ) {
+    for (int32_t i = 0; i < series_length * batch_size; i++) {
         if (gradient_name == "fw") {
-            gradient_sum += d_fw[i];
+            gradient_sum += d_f_bias[i] * input_values[i];
         } else if (gradient_name == "fu") {
             gradient_sum += d_fu[i];
         } else if (gradient_name == "f_bias") {
             gradient_sum += d_f_bias[i];
         } else if (gradient_name == "hw") {
-            gradient_sum += d_hw[i];
+            gradient_sum += d_h_bias[i] * input_values[i];
         } else if (gradient_name == "hu") {
             gradient_sum += d_hu[i];
         } else if (gradient_name == "h_bias") {
@@ -77,98 +77,79 @@ void MGU_Node::print_gradient(string gradient_name) {
     cout << "\tgradient['" << gradient_name << "']: " << get_gradient(gradient_name) << endl;
 }
 
-void MGU_Node::input_fired(int time, double incoming_output) {
-    inputs_fired[time]++;
+void MGU_Node::project_inputs(int32_t start_time, int32_t end_time) {
+    double f_weight = fw;
+    double h_weight = hw;
 
-    input_values[time] += incoming_output;
+    double f_bias_value = f_bias;
+    double h_bias_value = h_bias;
 
-    if (inputs_fired[time] < total_inputs) return;
-    else if (inputs_fired[time] > total_inputs) {
-        cerr << "ERROR: inputs_fired on MGU_Node " << innovation_number << " at time " << time << " is " << inputs_fired[time] << " and total_inputs is " << total_inputs << endl;
-        exit(1);
-    }
-
-    //update the reset gate bias so its centered around 1
-    //r_bias += 1;
-
-    //cout << "PROPAGATING FORWARD" << endl;
-
-    double x = input_values[time];
-
-    double h_prev = 0.0;
-    if (time > 0) h_prev = output_values[time - 1];
-
-    double hfu = h_prev * fu;
-    double xfw = x * fw;
-    double f_sum = f_bias + hfu + xfw;
-    f[time] = sigmoid(f_sum);
-    ld_f[time] = sigmoid_derivative(f[time]);
+    //f and h_tanh start out as the input part of their sums
+    for (int32_t i = start_time * batch_size; i < end_time * batch_size; i++) {
+        double x = input_values[i];
 
-    double xhw = x * hw;
-    double hu_f_h_prev = hu * f[time] * h_prev;
-    double h_sum = h_bias + xhw + hu_f_h_prev;
-
-    h_tanh[time] = tanh(h_sum);
-    ld_h_tanh[time] = tanh_derivative(h_tanh[time]);
-
-    output_values[time] = (1 - f[time]) * h_prev   +   f[time] * h_tanh[time];
+        f[i] = f_bias_value + x * f_weight;
+        h_tanh[i] = h_bias_value + x * h_weight;
+    }
 }
 
-void MGU_Node::try_update_deltas(int time) {
-    if (outputs_fired[time] < total_outputs) return;
-    else if (outputs_fired[time] > total_outputs) {
-        cerr << "ERROR: outputs_fired on MGU_Node " << innovation_number << " at time " << time << " is " << outputs_fired[time] << " and total_outputs is " << total_outputs << endl;
-        exit(1);
-    }
+void MGU_Node::forward_pass(int32_t time) {
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        int32_t current = (time * batch_size) + lane;
 
-    double error = error_values[time];
+        //update the reset gate bias so its centered around 1
+        //r_bias += 1;
 
-    double x = input_values[time];
+        //cout << "PROPAGATING FORWARD" << endl;
 
-    double h_prev = 0.0;
-    if (time > 0) h_prev = output_values[time - 1];
+        double h_prev = output_values[current - batch_size];
 
-    //backprop output gate
-    double d_out = error;
-    if (time < (series_length - 1)) d_out += d_h_prev[time + 1];
+        double hfu = h_prev * fu;
+        double f_sum = f[current] + hfu;
+        f[current] = sigmoid(f_sum);
+        ld_f[current] = sigmoid_derivative(f[current]);
 
+        double hu_f_h_prev = hu * f[current] * h_prev;
+        double h_sum = h_tanh[current] + hu_f_h_prev;
 
-    d_h_prev[time] = d_out * (1-f[time]);
+        h_tanh[current] = tanh(h_sum);
+        ld_h_tanh[current] = tanh_derivative(h_tanh[current]);
 
-    double d_h_tanh  = d_out * f[time] * ld_h_tanh[time];
-    d_h_bias[time]   = d_h_tanh;
-    d_hw[time]       = d_h_tanh * x;
-    d_hu[time]       = d_h_tanh * f[time] * h_prev;
-    d_input[time]    += d_h_tanh * hw;
-    d_h_prev[time]   += d_h_tanh * hu * f[time];
+        output_values[current] = (1 - f[current]) * h_prev   +   f[current] * h_tanh[current];
+    }
+}
 
-    double d_f_sigmoid  = ((d_out * h_tanh[time]) - (d_out * h_prev));
-    d_f_sigmoid         += d_h_tanh * hu * h_prev;
+void MGU_Node::backward_pass(int32_t time, const double *deltas) {
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        int32_t current = (time * batch_size) + lane;
 
-    double d_f = d_f_sigmoid * ld_f[time];
+        double error = deltas[lane];
 
-    d_f_bias[time]  = d_f;
-    d_fu[time]      = d_f * h_prev;
-    d_fw[time]      = d_f * x;
-    d_input[time]   += d_f * fw;
-    d_h_prev[time]  += d_f * fu;
+        double h_prev = output_values[current - batch_size];
 
-}
+        //backprop output gate
+        double d_out = error;
+        if (time < (series_length - 1)) d_out += d_h_prev[current + batch_size];
 
-void MGU_Node::error_fired(int time, double error) {
-    outputs_fired[time]++;
 
-    error_values[time] *= error;
+        d_h_prev[current] = d_out * (1-f[current]);
 
-    try_update_deltas(time);
-}
+        double d_h_tanh  = d_out * f[current] * ld_h_tanh[current];
+        d_h_bias[current]   = d_h_tanh;
+        d_hu[current]       = d_h_tanh * f[current] * h_prev;
+        d_input[current]    += d_h_tanh * hw;
+        d_h_prev[current]   += d_h_tanh * hu * f[current];
 
-void MGU_Node::output_fired(int time, double delta) {
-    outputs_fired[time]++;
+        double d_f_sigmoid  = ((d_out * h_tanh[current]) - (d_out * h_prev));
+        d_f_sigmoid         += d_h_tanh * hu * h_prev;
 
-    error_values[time] += delta;
+        double d_f = d_f_sigmoid * ld_f[current];
 
-    try_update_deltas(time);
+        d_f_bias[current]  = d_f;
+        d_fu[current]      = d_f * h_prev;
+        d_input[current]   += d_f * fw;
+        d_h_prev[current]  += d_f * fu;
+    }
 }
 
 
@@ -240,11 +221,11 @@ void MGU_Node::get_gradients(vector<double> &gradients) {
         gradients[i] = 0.0;
     }
 
-    for (uint32_t i = 0; i < series_length; i++) {
-        gradients[0] += d_fw[i];
+    for (int32_t i = 0; i < series_length * batch_size; i++) {
+        gradients[0] += d_f_bias[i] * input_values[i];
         gradients[1] += d_fu[i];
         gradients[2] += d_f_bias[i];
-        gradients[3] += d_hw[i];
+        gradients[3] += d_h_bias[i] * input_values[i];
         gradients[4] += d_hu[i];
         gradients[5] += d_h_bias[i];
     }
@@ -252,31 +233,22 @@ void MGU_Node::get_gradients(vector<double> &gradients) {
 
 void MGU_Node::reset(int _series_length) {
     series_length = _series_length;
+}
 
-    d_fw.assign(series_length, 0.0);
-    d_fu.assign(series_length, 0.0);
-    d_f_bias.assign(series_length, 0.0);
-
-    d_hw.assign(series_length, 0.0);
-    d_hu.assign(series_length, 0.0);
-    d_h_bias.assign(series_length, 0.0);
-
-    d_h_prev.assign(series_length, 0.0);
-
-    f.assign(series_length, 0.0);
-    ld_f.assign(series_length, 0.0);
-    h_tanh.assign(series_length, 0.0);
-    ld_h_tanh.assign(series_length, 0.0);
+void MGU_Node::get_series_arrays(vector<double**> &arrays) {
+    RNN_Node_Interface::get_series_arrays(arrays);
 
-    //reset values from rnn_node_interface
-    d_input.assign(series_length, 0.0);
-    error_values.assign(series_length, 0.0);
+    arrays.push_back(&d_fu);
+    arrays.push_back(&d_f_bias);
+    arrays.push_back(&d_hu);
+    arrays.push_back(&d_h_bias);
 
-    input_values.assign(series_length, 0.0);
-    output_values.assign(series_length, 0.0);
+    arrays.push_back(&d_h_prev);
 
-    inputs_fired.assign(series_length, 0);
-    outputs_fired.assign(series_length, 0);
+    arrays.push_back(&f);
+    arrays.push_back(&ld_f);
+    arrays.push_back(&h_tanh);
+    arrays.push_back(&ld_h_tanh);
 }
 
 RNN_Node_Interface* MGU_Node::copy() const {
@@ -292,30 +264,10 @@ RNN_Node_Interface* MGU_Node::copy() const {
     n->hu = hu;
     n->h_bias = h_bias;
 
-    n->d_fw = d_fw;
-    n->d_fu = d_fu;
-    n->d_f_bias = d_f_bias;
-    n->d_hw = d_hw;
-    n->d_hu = d_hu;
-    n->d_h_bias = d_h_bias;
-
-    n->d_h_prev = d_h_prev;
-
-    n->f = f;
-    n->ld_f = ld_f;
-    n->h_tanh = h_tanh;
-    n->ld_h_tanh = ld_h_tanh;
-
     //copy RNN_Node_Interface values
     n->series_length = series_length;
-    n->input_values = input_values;
-    n->output_values = output_values;
-    n->error_values = error_values;
-    n->d_input = d_input;
 
-    n->inputs_fired = inputs_fired;
     n->total_inputs = total_inputs;
-    n->outputs_fired = outputs_fired;
     n->total_outputs = total_outputs;
     n->enabled = enabled;
     n->forward_reachable = forward_reachable;
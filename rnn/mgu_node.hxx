@@ -25,19 +25,17 @@ class MGU_Node : public RNN_Node_Interface {
         double hu;
         double h_bias;
 
-        vector<double> d_fw;
-        vector<double> d_fu;
-        vector<double> d_f_bias;
-        vector<double> d_hw;
-        vector<double> d_hu;
-        vector<double> d_h_bias;
+        double *d_fu;
+        double *d_f_bias;
+        double *d_hu;
+        double *d_h_bias;
 
-        vector<double> d_h_prev;
+        double *d_h_prev;
 
-        vector<double> f;
-        vector<double> ld_f;
-        vector<double> h_tanh;
-        vector<double> ld_h_tanh;
+        double *f;
+        double *ld_f;
+        double *h_tanh;
+        double *ld_h_tanh;
 
     public:
 
@@ -49,11 +47,9 @@ class MGU_Node : public RNN_Node_Interface {
         double get_gradient(string gradient_name);
         void print_gradient(string gradient_name);
 
-        void input_fired(int time, double incoming_output);
-
-        void try_update_deltas(int time);
-        void error_fired(int time, double error);
-        void output_fired(int time, double delta);
+        void project_inputs(int32_t start_time, int32_t end_time);
+        void forward_pass(int32_t time);
+        void backward_pass(int32_t time, const double *deltas);
 
         uint32_t get_number_weights() const;
 
@@ -66,6 +62,7 @@ class MGU_Node : public RNN_Node_Interface {
         void get_gradients(vector<double> &gradients);
 
         void reset(int _series_length);
+        void get_series_arrays(vector<double**> &arrays);
 
         void print_cell_values();
 
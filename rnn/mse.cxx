@@ -30,8 +30,8 @@ void get_mse(const vector<double> &output_values, const vector<double> &expected
     }
 }
 
-void get_mse(RNN *genome, const vector< vector<double> > &expected, double &mse_sum, vector< vector<double> > &deltas) {
-    deltas.assign(genome->output_nodes.size(), vector<double>(expected[0].size(), 0.0));
+void get_mse(RNN *genome, const SeriesView &expected, double &mse_sum, vector< vector<double> > &deltas) {
+    deltas.assign(genome->output_nodes.size(), vector<double>(expected.get_length(), 0.0));
 
     mse_sum = 0.0;
     double mse;
@@ -39,20 +39,20 @@ void get_mse(RNN *genome, const vector< vector<double> > &expected, double &mse_
 
     for (uint32_t i = 0; i < genome->output_nodes.size(); i++) {
         mse = 0.0;
-        for (uint32_t j = 0; j < expected[i].size(); j++) {
+        for (int32_t j = 0; j < expected.get_length(); j++) {
             error = genome->output_nodes[i]->output_values[j] - expected[i][j];
             deltas[i][j] = error;
 
             mse += error * error;
         }
 
-        mse /= expected[i].size();
+        mse /= expected.get_length();
         mse_sum += mse;
     }
 
-    double d_mse = mse_sum * (1.0 / expected[0].size()) * 2.0;
+    double d_mse = mse_sum * (1.0 / expected.get_length()) * 2.0;
     for (uint32_t i = 0; i < genome->output_nodes.size(); i++) {
-        for (uint32_t j = 0; j < expected[i].size(); j++) {
+        for (int32_t j = 0; j < expected.get_length(); j++) {
             deltas[i][j] *= d_mse;
         }
     }
@@ -83,8 +83,8 @@ void get_mae(const vector<double> &output_values, const vector<double> &expected
     }
 }
 
-void get_mae(RNN *genome, const vector< vector<double> > &expected, double &mae_sum, vector< vector<double> > &deltas) {
-    deltas.assign(genome->output_nodes.size(), vector<double>(expected[0].size(), 0.0));
+void get_mae(RNN *genome, const SeriesView &expected, double &mae_sum, vector< vector<double> > &deltas) {
+    deltas.assign(genome->output_nodes.size(), vector<double>(expected.get_length(), 0.0));
 
     mae_sum = 0.0;
     double mae;
@@ -92,7 +92,7 @@ void get_mae(RNN *genome, const vector< vector<double> > &expected, double &mae_
 
     for (uint32_t i = 0; i < genome->output_nodes.size(); i++) {
         mae = 0.0;
-        for (uint32_t j = 0; j < expected[i].size(); j++) {
+        for (int32_t j = 0; j < expected.get_length(); j++) {
             error = fabs(genome->output_nodes[i]->output_values[j] - expected[i][j]);
             if (error == 0) {
                 deltas[i][j] = 0;
@@ -103,13 +103,13 @@ void get_mae(RNN *genome, const vector< vector<double> > &expected, double &mae_
             mae += error;
         }
 
-        mae /= expected[i].size();
+        mae /= expected.get_length();
         mae_sum += mae;
     }
 
-    double d_mae = mae_sum * (1.0 / expected[0].size());
+    double d_mae = mae_sum * (1.0 / expected.get_length());
     for (uint32_t i = 0; i < genome->output_nodes.size(); i++) {
-        for (uint32_t j = 0; j < expected[i].size(); j++) {
+        for (int32_t j = 0; j < expected.get_length(); j++) {
             deltas[i][j] *= d_mae;
         }
     }
@@ -184,3 +184,28 @@ void RecDepthPheromoneDist::deposit(int32_t ix) {
         dist[i] += 1.0 / d;
     }
 }
+
+void RecDepthPheromoneDist::write_to_stream(ostream &out) {
+    int32_t n = dist.size();
+    out.write((char*)&n, sizeof(int32_t));
+    out.write((char*)&dist[0], sizeof(double) * n);
+
+    ostringstream rng_state;
+    rng_state << rng;
+    write_binary_string(out, rng_state.str(), "pheromone rng", false);
+}
+
+void RecDepthPheromoneDist::read_from_stream(istream &in) {
+    int32_t n;
+    in.read((char*)&n, sizeof(int32_t));
+    if (n != (int32_t)dist.size()) {
+        cerr << "ERROR: reading a pheromone dist with " << n << " depths into one with " << dist.size() << endl;
+        exit(1);
+    }
+    in.read((char*)&dist[0], sizeof(double) * n);
+
+    string rng_state;
+    read_binary_string(in, rng_state, "pheromone rng", false);
+    istringstream rng_iss(rng_state);
+    rng_iss >> rng;
+}
@@ -3,11 +3,21 @@
 
 #include <chrono>
 
+#include <iostream>
+using std::cerr;
+using std::endl;
+using std::istream;
+using std::ostream;
+
 // random included in rnn_genome.hxx
 #include <random>
 using std::normal_distribution;
 using std::mt19937;
 
+#include <sstream>
+using std::istringstream;
+using std::ostringstream;
+
 #include <vector>
 using std::vector;
 
@@ -86,6 +96,9 @@ class RecDepthPheromoneDist : public Distribution {
         int32_t sample() override;
         void decay();
         void deposit(int32_t i);
+
+        void write_to_stream(ostream &out);
+        void read_from_stream(istream &in);
 };
 
 #endif
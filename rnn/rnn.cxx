@@ -1,9 +1,13 @@
 #include <algorithm>
+using std::max;
+using std::min;
 using std::sort;
 using std::upper_bound;
 
 #include <chrono>
 
+#include <cstring>
+
 #include <iostream>
 using std::cout;
 using std::endl;
@@ -55,6 +59,12 @@ RNN::RNN(vector<RNN_Node_Interface*> &_nodes, vector<RNN_Edge*> &_edges) {
             output_nodes.push_back(nodes[i]);
         }
     }
+
+    batch_size = 1;
+    window_start = 0;
+    arena_array_length = 0;
+
+    build_plan();
 }
 
 RNN::RNN(vector<RNN_Node_Interface*> &_nodes, vector<RNN_Edge*> &_edges, vector<RNN_Recurrent_Edge*> &_recurrent_edges) {
@@ -74,6 +84,217 @@ RNN::RNN(vector<RNN_Node_Interface*> &_nodes, vector<RNN_Edge*> &_edges, vector<
     }
 
     //cout << "got RNN with " << nodes.size() << " nodes, " << edges.size() << ", " << recurrent_edges.size() << " recurrent edges" << endl;
+
+    batch_size = 1;
+    window_start = 0;
+    arena_array_length = 0;
+
+    build_plan();
+}
+
+void RNN::build_plan() {
+    vector<int32_t> plan_position(nodes.size(), -1);
+
+    //order the reachable nodes so every node comes after all the nodes
+    //feeding into it through a (non-recurrent) edge
+    vector<int32_t> remaining_inputs(nodes.size(), 0);
+    for (uint32_t i = 0; i < edges.size(); i++) {
+        if (!edges[i]->is_reachable()) continue;
+
+        for (uint32_t j = 0; j < nodes.size(); j++) {
+            if (nodes[j] == edges[i]->output_node) remaining_inputs[j]++;
+        }
+    }
+
+    vector<int32_t> ordered;
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i]->is_reachable() && remaining_inputs[i] == 0) ordered.push_back(i);
+    }
+
+    for (uint32_t current = 0; current < ordered.size(); current++) {
+        RNN_Node_Interface *node = nodes[ordered[current]];
+
+        for (uint32_t i = 0; i < edges.size(); i++) {
+            if (!edges[i]->is_reachable() || edges[i]->input_node != node) continue;
+
+            for (uint32_t j = 0; j < nodes.size(); j++) {
+                if (nodes[j] == edges[i]->output_node) {
+                    remaining_inputs[j]--;
+                    if (remaining_inputs[j] == 0) ordered.push_back(j);
+                }
+            }
+        }
+    }
+
+    plan_nodes.clear();
+    plan_series_index.clear();
+    plan_is_output.clear();
+    for (uint32_t i = 0; i < ordered.size(); i++) {
+        RNN_Node_Interface *node = nodes[ordered[i]];
+        plan_position[ordered[i]] = i;
+        plan_nodes.push_back(node);
+        plan_is_output.push_back(node->layer_type == OUTPUT_LAYER);
+
+        int32_t series_index = -1;
+        for (uint32_t j = 0; j < input_nodes.size(); j++) {
+            if (input_nodes[j] == node) series_index = j;
+        }
+        plan_series_index.push_back(series_index);
+    }
+
+    int32_t reachable_nodes = 0;
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i]->is_reachable()) reachable_nodes++;
+    }
+
+    if (reachable_nodes != (int32_t)plan_nodes.size()) {
+        cerr << "ERROR: could not build the RNN execution plan, the feed forward edges between " << reachable_nodes << " reachable nodes contain a cycle" << endl;
+        exit(1);
+    }
+
+    //recurrent edges come first so their values are summed into a node's
+    //input in the same order as they were when edges fired into nodes
+    plan_edge_source.clear();
+    plan_edge_target.clear();
+    plan_edge_depth.clear();
+    plan_edge_index.clear();
+    for (uint32_t i = 0; i < recurrent_edges.size(); i++) {
+        if (!recurrent_edges[i]->is_reachable()) continue;
+
+        for (uint32_t j = 0; j < nodes.size(); j++) {
+            if (nodes[j] == recurrent_edges[i]->input_node) plan_edge_source.push_back(plan_position[j]);
+            if (nodes[j] == recurrent_edges[i]->output_node) plan_edge_target.push_back(plan_position[j]);
+        }
+        plan_edge_depth.push_back(recurrent_edges[i]->recurrent_depth);
+        plan_edge_index.push_back(i);
+    }
+
+    for (uint32_t i = 0; i < edges.size(); i++) {
+        if (!edges[i]->is_reachable()) continue;
+
+        for (uint32_t j = 0; j < nodes.size(); j++) {
+            if (nodes[j] == edges[i]->input_node) plan_edge_source.push_back(plan_position[j]);
+            if (nodes[j] == edges[i]->output_node) plan_edge_target.push_back(plan_position[j]);
+        }
+        plan_edge_depth.push_back(0);
+        plan_edge_index.push_back(i);
+    }
+
+    int32_t n_plan_edges = plan_edge_index.size();
+
+    plan_input_start.assign(plan_nodes.size() + 1, 0);
+    plan_output_start.assign(plan_nodes.size() + 1, 0);
+    plan_input_edges.clear();
+    plan_output_edges.clear();
+    for (int32_t i = 0; i < (int32_t)plan_nodes.size(); i++) {
+        plan_input_start[i] = plan_input_edges.size();
+        plan_output_start[i] = plan_output_edges.size();
+
+        for (int32_t j = 0; j < n_plan_edges; j++) {
+            if (plan_edge_target[j] == i) plan_input_edges.push_back(j);
+            if (plan_edge_source[j] == i) plan_output_edges.push_back(j);
+        }
+    }
+    plan_input_start[plan_nodes.size()] = plan_input_edges.size();
+    plan_output_start[plan_nodes.size()] = plan_output_edges.size();
+
+    //a recurrent edge into a node at or before its source in the plan means
+    //the nodes between them have to be stepped through time together, any
+    //other node can be run over the whole series on its own
+    vector<int32_t> block_end(plan_nodes.size());
+    for (int32_t i = 0; i < (int32_t)plan_nodes.size(); i++) {
+        block_end[i] = i;
+    }
+
+    vector<bool> stepped(plan_nodes.size(), false);
+    for (int32_t i = 0; i < n_plan_edges; i++) {
+        if (plan_edge_depth[i] > 0 && plan_edge_source[i] >= plan_edge_target[i]) {
+            block_end[plan_edge_target[i]] = max(block_end[plan_edge_target[i]], plan_edge_source[i]);
+            stepped[plan_edge_target[i]] = true;
+        }
+    }
+
+    plan_block_start.clear();
+    plan_block_stepped.clear();
+    for (int32_t i = 0; i < (int32_t)plan_nodes.size();) {
+        int32_t end = block_end[i];
+        bool block_stepped = stepped[i];
+        for (int32_t j = i; j <= end; j++) {
+            end = max(end, block_end[j]);
+            block_stepped = block_stepped || stepped[j];
+        }
+
+        plan_block_start.push_back(i);
+        plan_block_stepped.push_back(block_stepped);
+        i = end + 1;
+    }
+    plan_block_start.push_back(plan_nodes.size());
+
+    //the arena keeps enough time steps before time step 0 for the deepest
+    //recurrent edge and the recurrence inside the nodes
+    arena_history = 1;
+    for (int32_t i = 0; i < n_plan_edges; i++) {
+        arena_history = max(arena_history, plan_edge_depth[i]);
+    }
+
+    plan_edge_gradient.assign(n_plan_edges, 0.0);
+    update_plan_weights();
+
+    plan_input_values.assign(plan_nodes.size(), NULL);
+    plan_output_values.assign(plan_nodes.size(), NULL);
+    plan_d_input.assign(plan_nodes.size(), NULL);
+    plan_error_values.assign(plan_nodes.size(), NULL);
+}
+
+void RNN::allocate_arena(int32_t array_length) {
+    if (arena_arrays.size() == 0) {
+        for (uint32_t i = 0; i < nodes.size(); i++) {
+            nodes[i]->get_series_arrays(arena_arrays);
+        }
+    }
+
+    arena_array_length = array_length;
+    arena.assign(arena_arrays.size() * arena_array_length, 0.0);
+}
+
+void RNN::bind_arena() {
+    //arrays are handed out in node order so each node's state is contiguous,
+    //time step 0 of each comes after the history time steps
+    for (uint32_t i = 0; i < arena_arrays.size(); i++) {
+        *arena_arrays[i] = arena.data() + (i * arena_array_length) + (arena_history * batch_size);
+    }
+
+    for (uint32_t i = 0; i < plan_nodes.size(); i++) {
+        plan_input_values[i] = plan_nodes[i]->input_values;
+        plan_output_values[i] = plan_nodes[i]->output_values;
+        plan_d_input[i] = plan_nodes[i]->d_input;
+        plan_error_values[i] = plan_nodes[i]->error_values;
+    }
+}
+
+void RNN::carry_state(int32_t carry_time) {
+    //the time steps before carry_time of the previous pass become the history
+    //of the next one, the batch size (and so the layout of the arena) stays the same
+    int32_t history_length = arena_history * batch_size;
+
+    for (uint32_t i = 0; i < arena_arrays.size(); i++) {
+        double *values = *arena_arrays[i];
+
+        memmove(values - history_length, values + (carry_time * batch_size) - history_length, history_length * sizeof(double));
+        memset(values, 0, (arena_array_length - history_length) * sizeof(double));
+    }
+}
+
+void RNN::update_plan_weights() {
+    plan_edge_weight.resize(plan_edge_index.size());
+
+    for (uint32_t i = 0; i < plan_edge_index.size(); i++) {
+        if (plan_edge_depth[i] == 0) {
+            plan_edge_weight[i] = edges[plan_edge_index[i]]->weight;
+        } else {
+            plan_edge_weight[i] = recurrent_edges[plan_edge_index[i]]->weight;
+        }
+    }
 }
 
 RNN::~RNN() {
@@ -167,6 +388,7 @@ void RNN::set_weights(const vector<double> &parameters) {
         //if (recurrent_edges[i]->is_reachable()) recurrent_edges[i]->weight = parameters[current++];
     }
 
+    update_plan_weights();
 }
 
 uint32_t RNN::get_number_weights() {
@@ -190,117 +412,270 @@ uint32_t RNN::get_number_weights() {
     return number_weights;
 }
 
-void RNN::forward_pass(const vector< vector<double> > &series_data, bool using_dropout, bool training, double dropout_probability) {
-    series_length = series_data[0].size();
-
-    if (input_nodes.size() != series_data.size()) {
+void RNN::forward_pass(const SeriesView &series_data, bool using_dropout, bool training, double dropout_probability) {
+    if ((int32_t)input_nodes.size() != series_data.size()) {
         cerr << "ERROR: number of input nodes (" << input_nodes.size() << ") != number of time series data input fields (" << series_data.size() << ")" << endl;
         exit(1);
     }
 
     //TODO: want to check that all vectors in series_data are of same length
 
+    lane_inputs.assign(1, &series_data);
+    lane_length.assign(1, series_data.get_length());
+    window_start = 0;
 
-    for (uint32_t i = 0; i < nodes.size(); i++) {
-        nodes[i]->reset(series_length);
+    batch_forward_pass(using_dropout, training, dropout_probability, -1);
+}
+
+void RNN::forward_pass(const SeriesViews &series_data, int32_t first_series, int32_t number_series, bool using_dropout, bool training, double dropout_probability) {
+    lane_inputs.resize(number_series);
+    lane_length.resize(number_series);
+
+    for (int32_t lane = 0; lane < number_series; lane++) {
+        const SeriesView &lane_series = series_data[first_series + lane];
+
+        if ((int32_t)input_nodes.size() != lane_series.size()) {
+            cerr << "ERROR: number of input nodes (" << input_nodes.size() << ") != number of time series data input fields (" << lane_series.size() << ")" << endl;
+            exit(1);
+        }
+
+        lane_inputs[lane] = &lane_series;
+        lane_length[lane] = lane_series.get_length();
     }
+    window_start = 0;
 
-    for (uint32_t i = 0; i < edges.size(); i++) {
-        edges[i]->reset(series_length);
+    batch_forward_pass(using_dropout, training, dropout_probability, -1);
+}
+
+void RNN::batch_forward_pass(bool using_dropout, bool training, double dropout_probability, int32_t carry_time) {
+    batch_size = lane_inputs.size();
+
+    //shorter series are padded with 0 inputs up to the longest in the batch,
+    //their error values stay 0 past their end so the padding adds nothing
+    //to the gradients
+    series_length = 0;
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        series_length = max(series_length, lane_length[lane]);
     }
 
-    for (uint32_t i = 0; i < recurrent_edges.size(); i++) {
-        recurrent_edges[i]->reset(series_length);
+    int32_t array_length = (arena_history + series_length) * batch_size;
+    if (carry_time >= 0) {
+        if (array_length > arena_array_length) {
+            cerr << "ERROR: cannot carry the RNN state over to a forward pass of " << series_length << " time steps, the arena only has room for " << (arena_array_length / batch_size) - arena_history << endl;
+            exit(1);
+        }
+        carry_state(carry_time);
+    } else {
+        if (array_length > arena_array_length) {
+            allocate_arena(array_length);
+        } else {
+            memset(arena.data(), 0, arena.size() * sizeof(double));
+        }
+        bind_arena();
     }
 
-    //do a propagate forward for time == -1 so that the the input
-    //fired count on each node will be correct for the first pass
-    //through the RNN
-    for (uint32_t i = 0; i < recurrent_edges.size(); i++) {
-        if (recurrent_edges[i]->is_reachable()) recurrent_edges[i]->first_propagate_forward();
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        nodes[i]->batch_size = batch_size;
+        nodes[i]->reset(series_length);
     }
 
-    for (int32_t time = 0; time < series_length; time++) {
-        for (uint32_t i = 0; i < input_nodes.size(); i++) {
-            if(input_nodes[i]->is_reachable()) input_nodes[i]->input_fired(time, series_data[i][time]);
-        }
+    int32_t n_plan_edges = plan_edge_index.size();
+    if (using_dropout && training) plan_dropped_out.assign(series_length * n_plan_edges * batch_size, false);
+
+    for (int32_t block = 0; block < (int32_t)plan_block_stepped.size(); block++) {
+        int32_t block_start = plan_block_start[block];
+        int32_t block_end = plan_block_start[block + 1];
 
-        //feed forward
-        if (using_dropout) {
-            for (uint32_t i = 0; i < edges.size(); i++) {
-                if (edges[i]->is_reachable()) edges[i]->propagate_forward(time, training, dropout_probability);
+        if (plan_block_stepped[block]) {
+            for (int32_t time = 0; time < series_length; time++) {
+                for (int32_t i = block_start; i < block_end; i++) {
+                    sum_inputs(i, time, time + 1, using_dropout, training, dropout_probability);
+                    plan_nodes[i]->project_inputs(time, time + 1);
+                    plan_nodes[i]->forward_pass(time);
+                }
             }
         } else {
-            for (uint32_t i = 0; i < edges.size(); i++) {
-                if (edges[i]->is_reachable()) edges[i]->propagate_forward(time);
+            //everything feeding into these nodes has been calculated for the
+            //whole series, so only their own recurrence is stepped through time
+            for (int32_t i = block_start; i < block_end; i++) {
+                sum_inputs(i, 0, series_length, using_dropout, training, dropout_probability);
+                plan_nodes[i]->project_inputs(0, series_length);
+
+                for (int32_t time = 0; time < series_length; time++) {
+                    plan_nodes[i]->forward_pass(time);
+                }
             }
         }
+    }
+}
+
+void RNN::sum_inputs(int32_t i, int32_t start_time, int32_t end_time, bool using_dropout, bool training, double dropout_probability) {
+    double *input_values = plan_input_values[i];
+
+    int32_t series_index = plan_series_index[i];
+    for (int32_t time = start_time; time < end_time; time++) {
+        for (int32_t lane = 0; lane < batch_size; lane++) {
+            int32_t current = (time * batch_size) + lane;
 
-        for (uint32_t i = 0; i < recurrent_edges.size(); i++) {
-            if (recurrent_edges[i]->is_reachable()) recurrent_edges[i]->propagate_forward(time);
+            if (series_index >= 0 && time < lane_length[lane]) {
+                input_values[current] = (*lane_inputs[lane])[series_index][window_start + time];
+            } else {
+                input_values[current] = 0.0;
+            }
+        }
+    }
+
+    int32_t n_plan_edges = plan_edge_index.size();
+    for (int32_t j = plan_input_start[i]; j < plan_input_start[i + 1]; j++) {
+        int32_t edge = plan_input_edges[j];
+        int32_t depth = plan_edge_depth[edge];
+
+        //time steps before 0 read the history of the source
+        const double *source_values = plan_output_values[plan_edge_source[edge]];
+        int32_t offset = depth * batch_size;
+        double weight = plan_edge_weight[edge];
+
+        if (using_dropout && depth == 0) {
+            for (int32_t time = start_time; time < end_time; time++) {
+                for (int32_t lane = 0; lane < batch_size; lane++) {
+                    int32_t current = (time * batch_size) + lane;
+                    double output = source_values[current - offset] * weight;
+
+                    if (training) {
+                        if (drand48() < dropout_probability) {
+                            plan_dropped_out[(((time * n_plan_edges) + edge) * batch_size) + lane] = true;
+                            output = 0.0;
+                        }
+                    } else {
+                        output *= (1.0 - dropout_probability);
+                    }
+
+                    input_values[current] += output;
+                }
+            }
+        } else {
+            for (int32_t k = start_time * batch_size; k < end_time * batch_size; k++) {
+                input_values[k] += source_values[k - offset] * weight;
+            }
         }
     }
 }
 
 void RNN::backward_pass(double error, bool using_dropout, bool training, double dropout_probability) {
-    //do a propagate forward for time == (series_length - 1) so that the
-    // output fired count on each node will be correct for the first pass
-    //through the RNN
-    for (uint32_t i = 0; i < recurrent_edges.size(); i++) {
-        if (recurrent_edges[i]->is_reachable()) recurrent_edges[i]->first_propagate_backward();
-    }
+    backward_pass(vector<double>(batch_size, error), using_dropout, training, dropout_probability);
+}
 
+void RNN::backward_pass(const vector<double> &errors, bool using_dropout, bool training, double dropout_probability) {
+    int32_t n_plan_edges = plan_edge_index.size();
+    plan_edge_gradient.assign(n_plan_edges, 0.0);
+    lane_deltas.resize(batch_size);
+
+    //nodes are visited in reverse plan order, so every delta a node pulls
+    //from the nodes its edges feed into has already been calculated
     for (int32_t time = series_length - 1; time >= 0; time--) {
+        for (int32_t i = (int32_t)plan_nodes.size() - 1; i >= 0; i--) {
+            for (int32_t lane = 0; lane < batch_size; lane++) {
+                int32_t current = (time * batch_size) + lane;
 
-        for (uint32_t i = 0; i < output_nodes.size(); i++) {
-            output_nodes[i]->error_fired(time, error);
-        }
+                double delta = 0.0;
+                if (plan_is_output[i]) delta = plan_error_values[i][current] * errors[lane];
 
-        if (using_dropout) {
-            for (int32_t i = (int32_t)edges.size() - 1; i >= 0; i--) {
-                if (edges[i]->is_reachable()) edges[i]->propagate_backward(time, training, dropout_probability);
-            }
-        } else {
-            for (int32_t i = (int32_t)edges.size() - 1; i >= 0; i--) {
-                if (edges[i]->is_reachable()) edges[i]->propagate_backward(time);
+                for (int32_t j = plan_output_start[i]; j < plan_output_start[i + 1]; j++) {
+                    int32_t edge = plan_output_edges[j];
+                    int32_t target_time = time + plan_edge_depth[edge];
+                    if (target_time >= series_length) continue;
+
+                    double edge_delta = plan_d_input[plan_edge_target[edge]][(target_time * batch_size) + lane];
+
+                    if (using_dropout && training && plan_edge_depth[edge] == 0) {
+                        if (plan_dropped_out[(((time * n_plan_edges) + edge) * batch_size) + lane]) edge_delta = 0.0;
+                    }
+
+                    plan_edge_gradient[edge] += edge_delta * plan_output_values[i][current];
+                    delta += edge_delta * plan_edge_weight[edge];
+                }
+
+                lane_deltas[lane] = delta;
             }
+
+            plan_nodes[i]->backward_pass(time, lane_deltas.data());
         }
+    }
 
-        for (int32_t i = (int32_t)recurrent_edges.size() - 1; i >= 0; i--) {
-            if (recurrent_edges[i]->is_reachable()) recurrent_edges[i]->propagate_backward(time);
+    //recurrent edges out of the history (all 0 unless state was carried over)
+    //still contribute to their weight gradient, the deltas stop there
+    for (int32_t edge = 0; edge < n_plan_edges; edge++) {
+        int32_t depth = plan_edge_depth[edge];
+        const double *source_values = plan_output_values[plan_edge_source[edge]];
+        const double *target_d_input = plan_d_input[plan_edge_target[edge]];
+
+        for (int32_t k = 0; k < min(depth, series_length) * batch_size; k++) {
+            plan_edge_gradient[edge] += target_d_input[k] * source_values[k - (depth * batch_size)];
+        }
+    }
+
+    for (uint32_t i = 0; i < edges.size(); i++) {
+        edges[i]->d_weight = 0.0;
+    }
+
+    for (uint32_t i = 0; i < recurrent_edges.size(); i++) {
+        recurrent_edges[i]->d_weight = 0.0;
+    }
+
+    for (int32_t i = 0; i < n_plan_edges; i++) {
+        if (plan_edge_depth[i] == 0) {
+            edges[plan_edge_index[i]]->d_weight = plan_edge_gradient[i];
+        } else {
+            recurrent_edges[plan_edge_index[i]]->d_weight = plan_edge_gradient[i];
         }
     }
 }
 
+void RNN::calculate_error_mse(const SeriesViews &expected_outputs, int32_t first_series, vector<double> &mses) {
+    mses.assign(batch_size, 0.0);
+
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        const SeriesView &expected = expected_outputs[first_series + lane];
 
-double RNN::calculate_error_mse(const vector< vector<double> > &expected_outputs) {
+        double mse_sum = 0.0;
+        for (uint32_t i = 0; i < output_nodes.size(); i++) {
+            double mse = 0.0;
+            for (int32_t j = 0; j < expected.get_length(); j++) {
+                int32_t current = (j * batch_size) + lane;
+                double error = output_nodes[i]->output_values[current] - expected[i][j];
+                output_nodes[i]->error_values[current] = error;
+                mse += error * error;
+            }
+            mse_sum += mse / expected.get_length();
+        }
+        mses[lane] = mse_sum;
+    }
+}
+
+double RNN::calculate_error_mse(const SeriesView &expected_outputs) {
     double mse_sum = 0.0;
     double mse;
     double error;
     for (uint32_t i = 0; i < output_nodes.size(); i++) {
-        output_nodes[i]->error_values.resize(expected_outputs[i].size());
-
         mse = 0.0;
-        for (uint32_t j = 0; j < expected_outputs[i].size(); j++) {
+        for (int32_t j = 0; j < expected_outputs.get_length(); j++) {
             error = output_nodes[i]->output_values[j] - expected_outputs[i][j];
             output_nodes[i]->error_values[j] = error;
             mse += error * error;
         }
-        mse_sum += mse / expected_outputs[i].size();
+        mse_sum += mse / expected_outputs.get_length();
     }
 
     return mse_sum;
 }
 
-double RNN::calculate_error_mae(const vector< vector<double> > &expected_outputs) {
+double RNN::calculate_error_mae(const SeriesView &expected_outputs) {
     double mae_sum = 0.0;
     double mae;
     double error;
     for (uint32_t i = 0; i < output_nodes.size(); i++) {
-        output_nodes[i]->error_values.resize(expected_outputs[i].size());
-
         mae = 0.0;
-        for (uint32_t j = 0; j < expected_outputs[i].size(); j++) {
+        for (int32_t j = 0; j < expected_outputs.get_length(); j++) {
             error = fabs(output_nodes[i]->output_values[j] - expected_outputs[i][j]);
 
             mae += error;
@@ -313,23 +688,23 @@ double RNN::calculate_error_mae(const vector< vector<double> > &expected_outputs
             output_nodes[i]->error_values[j] = error;
 
         }
-        mae_sum += mae / expected_outputs[i].size();
+        mae_sum += mae / expected_outputs.get_length();
     }
 
     return mae_sum;
 }
 
-double RNN::prediction_mse(const vector< vector<double> > &series_data, const vector< vector<double> > &expected_outputs, bool using_dropout, bool training, double dropout_probability) {
+double RNN::prediction_mse(const SeriesView &series_data, const SeriesView &expected_outputs, bool using_dropout, bool training, double dropout_probability) {
     forward_pass(series_data, using_dropout, training, dropout_probability);
     return calculate_error_mse(expected_outputs);
 }
 
-double RNN::prediction_mae(const vector< vector<double> > &series_data, const vector< vector<double> > &expected_outputs, bool using_dropout, bool training, double dropout_probability) {
+double RNN::prediction_mae(const SeriesView &series_data, const SeriesView &expected_outputs, bool using_dropout, bool training, double dropout_probability) {
     forward_pass(series_data, using_dropout, training, dropout_probability);
     return calculate_error_mae(expected_outputs);
 }
 
-vector<double> RNN::get_predictions(const vector< vector<double> > &series_data, const vector< vector<double> > &expected_outputs, bool using_dropout, double dropout_probability) {
+vector<double> RNN::get_predictions(const SeriesView &series_data, const SeriesView &expected_outputs, bool using_dropout, double dropout_probability) {
     forward_pass(series_data, using_dropout, false, dropout_probability);
 
     vector<double> result;
@@ -346,11 +721,11 @@ vector<double> RNN::get_predictions(const vector< vector<double> > &series_data,
 }
 
 
-void RNN::write_predictions(string output_filename, const vector<string> &input_parameter_names, const vector<string> &output_parameter_names, const vector< vector<double> > &series_data, const vector< vector<double> > &expected_outputs, bool using_dropout, double dropout_probability) {
+void RNN::write_predictions(string output_filename, const vector<string> &input_parameter_names, const vector<string> &output_parameter_names, const SeriesView &series_data, const SeriesView &expected_outputs, bool using_dropout, double dropout_probability) {
     forward_pass(series_data, using_dropout, false, dropout_probability);
 
 
-    cerr << "series_length: " << series_length << ", series_data.size(): " << series_data.size() << ", series_data[0].size(): " << series_data[0].size() << endl;
+    cerr << "series_length: " << series_length << ", series_data.size(): " << series_data.size() << ", series_data.get_length(): " << series_data.get_length() << endl;
     cerr << "input_nodes.size(): " << input_nodes.size() << ", output_nodes.size(): " << output_nodes.size() << endl;
     ofstream outfile(output_filename);
 
@@ -398,46 +773,178 @@ void RNN::write_predictions(string output_filename, const vector<string> &input_
     outfile.close();
 }
 
-void RNN::get_analytic_gradient(const vector<double> &test_parameters, const vector< vector<double> > &inputs, const vector< vector<double> > &outputs, double &mse, vector<double> &analytic_gradient, bool using_dropout, bool training, double dropout_probability) {
-    analytic_gradient.assign(test_parameters.size(), 0.0);
-
+void RNN::get_analytic_gradient(const vector<double> &test_parameters, const SeriesView &inputs, const SeriesView &outputs, double &mse, vector<double> &analytic_gradient, bool using_dropout, bool training, double dropout_probability) {
     set_weights(test_parameters);
     forward_pass(inputs, using_dropout, training, dropout_probability);
 
     mse = calculate_error_mse(outputs);
 
-    backward_pass(mse * (1.0 / outputs[0].size()) * 2.0, using_dropout, training, dropout_probability);
+    backward_pass(mse * (1.0 / outputs.get_length()) * 2.0, using_dropout, training, dropout_probability);
+
+    get_gradients(analytic_gradient);
+}
+
+void RNN::get_truncated_gradient(const vector<double> &test_parameters, const SeriesViews &inputs, const SeriesViews &outputs, int32_t first_series, int32_t number_series, int32_t window_length, int32_t stride, vector<double> &mses, vector<double> &analytic_gradient, bool using_dropout, bool training, double dropout_probability) {
+    if (stride <= 0 || stride > window_length) {
+        cerr << "ERROR: truncated backpropagation through time needs 0 < stride (" << stride << ") <= window length (" << window_length << ")" << endl;
+        exit(1);
+    }
+
+    set_weights(test_parameters);
+
+    lane_inputs.resize(number_series);
+    lane_length.resize(number_series);
+
+    int32_t max_length = 0;
+    for (int32_t lane = 0; lane < number_series; lane++) {
+        const SeriesView &lane_series = inputs[first_series + lane];
+
+        if ((int32_t)input_nodes.size() != lane_series.size()) {
+            cerr << "ERROR: number of input nodes (" << input_nodes.size() << ") != number of time series data input fields (" << lane_series.size() << ")" << endl;
+            exit(1);
+        }
+
+        lane_inputs[lane] = &lane_series;
+        max_length = max(max_length, (int32_t)lane_series.get_length());
+    }
+
+    //the arena is sized for the longest window up front, as it can't be
+    //reallocated while the state is carried from one window to the next
+    batch_size = number_series;
+    int32_t array_length = (arena_history + window_length) * batch_size;
+    if (array_length > arena_array_length) allocate_arena(array_length);
+
+    mses.assign(number_series, 0.0);
+    analytic_gradient.assign(get_number_weights(), 0.0);
+
+    vector<double> window_gradient;
+    vector<double> errors(number_series);
+
+    int32_t previous_start = 0;
+    for (int32_t scored_start = 0; scored_start < max_length; scored_start += stride) {
+        int32_t end = scored_start + stride;
+        int32_t start = max(0, end - window_length);
+
+        for (int32_t lane = 0; lane < number_series; lane++) {
+            int32_t length = (int32_t)lane_inputs[lane]->get_length() - start;
+            lane_length[lane] = max(0, min(length, end - start));
+        }
+
+        window_start = start;
+        if (scored_start == 0) {
+            batch_forward_pass(using_dropout, training, dropout_probability, -1);
+        } else {
+            batch_forward_pass(using_dropout, training, dropout_probability, start - previous_start);
+        }
+        previous_start = start;
+
+        //each window's errors are backpropagated the same way as a series of
+        //that many time steps would be, while the mses add up to the mse of
+        //the whole series
+        for (int32_t lane = 0; lane < number_series; lane++) {
+            const SeriesView &expected = outputs[first_series + lane];
+
+            int32_t first_scored = scored_start - start;
+            int32_t n_scored = lane_length[lane] - first_scored;
+            errors[lane] = 0.0;
+            if (n_scored <= 0) continue;
+
+            double window_mse = 0.0;
+            for (uint32_t i = 0; i < output_nodes.size(); i++) {
+                double error_sum = 0.0;
+                for (int32_t j = first_scored; j < lane_length[lane]; j++) {
+                    int32_t current = (j * batch_size) + lane;
+                    double error = output_nodes[i]->output_values[current] - expected[i][start + j];
+                    output_nodes[i]->error_values[current] = error;
+                    error_sum += error * error;
+                }
+
+                window_mse += error_sum / n_scored;
+                mses[lane] += error_sum / expected.get_length();
+            }
+
+            errors[lane] = window_mse * (1.0 / n_scored) * 2.0;
+        }
+
+        backward_pass(errors, using_dropout, training, dropout_probability);
+        get_gradients(window_gradient);
+
+        for (uint32_t i = 0; i < window_gradient.size(); i++) {
+            analytic_gradient[i] += window_gradient[i];
+        }
+    }
+}
 
+void RNN::get_windowed_errors(const SeriesView &series_data, const SeriesView &expected_outputs, int32_t window_length, double &mse, double &mae, bool using_dropout, bool training, double dropout_probability) {
+    if ((int32_t)input_nodes.size() != series_data.size()) {
+        cerr << "ERROR: number of input nodes (" << input_nodes.size() << ") != number of time series data input fields (" << series_data.size() << ")" << endl;
+        exit(1);
+    }
+
+    lane_inputs.assign(1, &series_data);
+    lane_length.resize(1);
+
+    batch_size = 1;
+    int32_t array_length = arena_history + window_length;
+    if (array_length > arena_array_length) allocate_arena(array_length);
+
+    int32_t length = series_data.get_length();
+    vector<double> squared_errors(output_nodes.size(), 0.0);
+    vector<double> absolute_errors(output_nodes.size(), 0.0);
+
+    for (int32_t start = 0; start < length; start += window_length) {
+        lane_length[0] = min(window_length, length - start);
+
+        window_start = start;
+        batch_forward_pass(using_dropout, training, dropout_probability, start == 0 ? -1 : window_length);
+
+        for (uint32_t i = 0; i < output_nodes.size(); i++) {
+            for (int32_t j = 0; j < lane_length[0]; j++) {
+                double error = output_nodes[i]->output_values[j] - expected_outputs[i][start + j];
+                squared_errors[i] += error * error;
+                absolute_errors[i] += fabs(error);
+            }
+        }
+    }
+
+    //summed per output the same way as calculate_error_mse and calculate_error_mae
+    mse = 0.0;
+    mae = 0.0;
+    for (uint32_t i = 0; i < output_nodes.size(); i++) {
+        mse += squared_errors[i] / length;
+        mae += absolute_errors[i] / length;
+    }
+}
+
+void RNN::get_gradients(vector<double> &gradients) {
+    gradients.resize(get_number_weights());
+
+    //unreachable nodes and edges still have weights in the parameter vector,
+    //their gradients are 0 so keep them to stay aligned with get_weights
     vector<double> current_gradients;
 
     uint32_t current = 0;
     for (uint32_t i = 0; i < nodes.size(); i++) {
-        if (nodes[i]->is_reachable()) {
-            nodes[i]->get_gradients(current_gradients);
+        nodes[i]->get_gradients(current_gradients);
 
-            for (uint32_t j = 0; j < current_gradients.size(); j++) {
-                analytic_gradient[current] = current_gradients[j];
-                current++;
-            }
+        for (uint32_t j = 0; j < current_gradients.size(); j++) {
+            gradients[current] = current_gradients[j];
+            current++;
         }
     }
 
     for (uint32_t i = 0; i < edges.size(); i++) {
-        if (edges[i]->is_reachable()) {
-            analytic_gradient[current] = edges[i]->get_gradient();
-            current++;
-        }
+        gradients[current] = edges[i]->get_gradient();
+        current++;
     }
 
     for (uint32_t i = 0; i < recurrent_edges.size(); i++) {
-        if (recurrent_edges[i]->is_reachable()) {
-            analytic_gradient[current] = recurrent_edges[i]->get_gradient();
-            current++;
-        }
+        gradients[current] = recurrent_edges[i]->get_gradient();
+        current++;
     }
 }
 
-void RNN::get_empirical_gradient(const vector<double> &test_parameters, const vector< vector<double> > &inputs, const vector< vector<double> > &outputs, double &mse, vector<double> &empirical_gradient, bool using_dropout, bool training, double dropout_probability) {
+void RNN::get_empirical_gradient(const vector<double> &test_parameters, const SeriesView &inputs, const SeriesView &outputs, double &mse, vector<double> &empirical_gradient, bool using_dropout, bool training, double dropout_probability) {
     empirical_gradient.assign(test_parameters.size(), 0.0);
 
     vector< vector<double> > deltas;
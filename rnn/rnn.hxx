@@ -12,10 +12,21 @@ using std::vector;
 #include "rnn_edge.hxx"
 #include "rnn_recurrent_edge.hxx"
 
+#include "time_series/series_view.hxx"
+
 class RNN {
     private:
         int series_length;
 
+        //several series are run through the network at once, each in its own
+        //lane, with the per time step arrays of the nodes laid out as
+        //[time][lane] so each node runs its cell math for every lane of a
+        //time step in a single call
+        int32_t batch_size;
+        vector<const SeriesView*> lane_inputs;
+        vector<int32_t> lane_length;
+        vector<double> lane_deltas;
+
         vector<RNN_Node_Interface*> input_nodes;
         vector<RNN_Node_Interface*> output_nodes;
 
@@ -23,6 +34,63 @@ class RNN {
         vector<RNN_Edge*> edges;
         vector<RNN_Recurrent_Edge*> recurrent_edges;
 
+        //the execution plan is compiled once when the RNN is constructed:
+        //the reachable nodes in topological order, and the reachable edges
+        //and recurrent edges in structure of arrays form (recurrent edges
+        //have depth > 0), with each node's incoming and outgoing edges
+        //stored as contiguous ranges of edge indices
+        vector<RNN_Node_Interface*> plan_nodes;
+        vector<int32_t> plan_series_index;
+        vector<bool> plan_is_output;
+
+        vector<int32_t> plan_input_start;
+        vector<int32_t> plan_input_edges;
+        vector<int32_t> plan_output_start;
+        vector<int32_t> plan_output_edges;
+
+        vector<int32_t> plan_edge_source;
+        vector<int32_t> plan_edge_target;
+        vector<int32_t> plan_edge_depth;
+        vector<int32_t> plan_edge_index;
+        vector<double> plan_edge_weight;
+        vector<double> plan_edge_gradient;
+
+        //the plan nodes are split into blocks of contiguous nodes, a stepped
+        //block contains a recurrent edge back to itself and is run one time
+        //step at a time, the nodes of any other block are each run over the
+        //whole series before moving on to the next
+        vector<int32_t> plan_block_start;
+        vector<bool> plan_block_stepped;
+
+        //per time step arrays of the plan nodes, bound when the arena is allocated
+        vector<double*> plan_input_values;
+        vector<double*> plan_output_values;
+        vector<double*> plan_d_input;
+        vector<double*> plan_error_values;
+
+        //dropout is only applied to feed forward edges, indexed by ((time * edges) + edge) * batch_size + lane
+        vector<bool> plan_dropped_out;
+
+        //all per time step state of the nodes lives in one arena, with one
+        //slice per array sized for the largest (history + series length) *
+        //batch size seen so far, cleared once per forward pass. the first
+        //arena_history time steps of each slice come before time step 0
+        int32_t arena_history;
+        int32_t arena_array_length;
+        vector<double> arena;
+        vector<double**> arena_arrays;
+
+        //time step of the series that time step 0 of the forward pass reads
+        int32_t window_start;
+
+        void build_plan();
+        void update_plan_weights();
+        void allocate_arena(int32_t array_length);
+        void bind_arena();
+        void carry_state(int32_t carry_time);
+        void batch_forward_pass(bool using_dropout, bool training, double dropout_probability, int32_t carry_time);
+        void sum_inputs(int32_t i, int32_t start_time, int32_t end_time, bool using_dropout, bool training, double dropout_probability);
+
     public:
         RNN(vector<RNN_Node_Interface*> &_nodes, vector<RNN_Edge*> &_edges);
         RNN(vector<RNN_Node_Interface*> &_nodes, vector<RNN_Edge*> &_edges, vector<RNN_Recurrent_Edge*> &_recurrent_edges);
@@ -34,19 +102,25 @@ class RNN {
         RNN_Node_Interface* get_node(int i);
         RNN_Edge* get_edge(int i);
 
-        void forward_pass(const vector< vector<double> > &series_data, bool using_dropout, bool training, double dropout_probability);
+        void forward_pass(const SeriesView &series_data, bool using_dropout, bool training, double dropout_probability);
         void backward_pass(double error, bool using_dropout, bool training, double dropout_probability);
 
-        double calculate_error_mse(const vector< vector<double> > &expected_outputs);
-        double calculate_error_mae(const vector< vector<double> > &expected_outputs);
+        //runs series [first_series, first_series + number_series) as one batch,
+        //series may have different lengths. errors and mses have one entry per series
+        void forward_pass(const SeriesViews &series_data, int32_t first_series, int32_t number_series, bool using_dropout, bool training, double dropout_probability);
+        void backward_pass(const vector<double> &errors, bool using_dropout, bool training, double dropout_probability);
+        void calculate_error_mse(const SeriesViews &expected_outputs, int32_t first_series, vector<double> &mses);
+
+        double calculate_error_mse(const SeriesView &expected_outputs);
+        double calculate_error_mae(const SeriesView &expected_outputs);
 
-        double prediction_mse(const vector< vector<double> > &series_data, const vector< vector<double> > &expected_outputs, bool using_dropout, bool training, double dropout_probability);
-        double prediction_mae(const vector< vector<double> > &series_data, const vector< vector<double> > &expected_outputs, bool using_dropout, bool training, double dropout_probability);
+        double prediction_mse(const SeriesView &series_data, const SeriesView &expected_outputs, bool using_dropout, bool training, double dropout_probability);
+        double prediction_mae(const SeriesView &series_data, const SeriesView &expected_outputs, bool using_dropout, bool training, double dropout_probability);
 
 
-        vector<double> get_predictions(const vector< vector<double> > &series_data, const vector< vector<double> > &expected_outputs, bool usng_dropout, double dropout_probability);
+        vector<double> get_predictions(const SeriesView &series_data, const SeriesView &expected_outputs, bool usng_dropout, double dropout_probability);
 
-        void write_predictions(string output_filename, const vector<string> &input_parameter_names, const vector<string> &output_parameter_names, const vector< vector<double> > &series_data, const vector< vector<double> > &expected_outputs, bool using_dropout, double dropout_probability);
+        void write_predictions(string output_filename, const vector<string> &input_parameter_names, const vector<string> &output_parameter_names, const SeriesView &series_data, const SeriesView &expected_outputs, bool using_dropout, double dropout_probability);
 
         void initialize_randomly();
         void get_weights(vector<double> &parameters);
@@ -54,13 +128,26 @@ class RNN {
 
         uint32_t get_number_weights();
 
-        void get_analytic_gradient(const vector<double> &test_parameters, const vector< vector<double> > &inputs, const vector< vector<double> > &outputs, double &mse, vector<double> &analytic_gradient, bool using_dropout, bool training, double dropout_probability);
-        void get_empirical_gradient(const vector<double> &test_parameters, const vector< vector<double> > &inputs, const vector< vector<double> > &outputs, double &mae, vector<double> &empirical_gradient, bool using_dropout, bool training, double dropout_probability);
+        void get_gradients(vector<double> &gradients);
+
+        void get_analytic_gradient(const vector<double> &test_parameters, const SeriesView &inputs, const SeriesView &outputs, double &mse, vector<double> &analytic_gradient, bool using_dropout, bool training, double dropout_probability);
+        //truncated backpropagation through time over series [first_series,
+        //first_series + number_series): every stride time steps a window of
+        //up to window_length time steps ending there is run, starting from
+        //the state carried over from the previous window, and the errors of
+        //its last stride time steps are backpropagated through it. memory use
+        //and gradient history are bounded by window_length
+        void get_truncated_gradient(const vector<double> &test_parameters, const SeriesViews &inputs, const SeriesViews &outputs, int32_t first_series, int32_t number_series, int32_t window_length, int32_t stride, vector<double> &mses, vector<double> &analytic_gradient, bool using_dropout, bool training, double dropout_probability);
+        void get_empirical_gradient(const vector<double> &test_parameters, const SeriesView &inputs, const SeriesView &outputs, double &mae, vector<double> &empirical_gradient, bool using_dropout, bool training, double dropout_probability);
+        //the mse and mae of a series run window_length time steps at a time,
+        //carrying the state from one window to the next, so memory use is
+        //bounded by window_length the same as in get_truncated_gradient
+        void get_windowed_errors(const SeriesView &series_data, const SeriesView &expected_outputs, int32_t window_length, double &mse, double &mae, bool using_dropout, bool training, double dropout_probability);
 
         RNN* copy();
 
-        friend void get_mse(RNN* genome, const vector< vector<double> > &expected, double &mse, vector< vector<double> > &deltas);
-        friend void get_mae(RNN* genome, const vector< vector<double> > &expected, double &mae, vector< vector<double> > &deltas);
+        friend void get_mse(RNN* genome, const SeriesView &expected, double &mse, vector< vector<double> > &deltas);
+        friend void get_mae(RNN* genome, const SeriesView &expected, double &mae, vector< vector<double> > &deltas);
 
 
 };
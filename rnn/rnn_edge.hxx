@@ -7,10 +7,6 @@ class RNN_Edge {
     private:
         int32_t innovation_number;
 
-        vector<double> outputs;
-        vector<double> deltas;
-        vector<bool> dropped_out;
-
         double weight;
         double d_weight;
 
@@ -31,14 +27,6 @@ class RNN_Edge {
 
         RNN_Edge* copy(const vector<RNN_Node_Interface*> new_nodes);
 
-        void reset(int32_t series_length);
-
-        void propagate_forward(int32_t time);
-        void propagate_backward(int32_t time);
-
-        void propagate_forward(int32_t time, bool training, double dropout_probability);
-        void propagate_backward(int32_t time, bool training, double dropout_probability);
-
         double get_gradient() const;
         int32_t get_innovation_number() const;
         int32_t get_input_innovation_number() const;
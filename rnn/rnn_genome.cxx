@@ -1,4 +1,5 @@
 #include <algorithm>
+using std::min;
 using std::sort;
 using std::upper_bound;
 
@@ -27,13 +28,6 @@ using std::endl;
 using std::minstd_rand0;
 using std::uniform_real_distribution;
 
-#include <thread>
-using std::thread;
-
-#include <random>
-using std::minstd_rand0;
-using std::uniform_real_distribution;
-
 #include <sstream>
 using std::istringstream;
 using std::ostringstream;
@@ -47,6 +41,7 @@ using std::vector;
 
 #include "common/random.hxx"
 #include "common/color_table.hxx"
+#include "common/thread_pool.hxx"
 
 #include "rnn.hxx"
 #include "rnn_node.hxx"
@@ -104,8 +99,21 @@ RNN_Genome::RNN_Genome(vector<RNN_Node_Interface*> &_nodes, vector<RNN_Edge*> &_
     use_dropout = false;
     dropout_probability = 0.5;
 
+    bptt_window = 0;
+    bptt_stride = 0;
+
+    early_stop_threshold = EXAMM_MAX_DOUBLE;
+    early_stop_grace = 0;
+
+    training_series_fraction = 1.0;
+    keep_optimizer_state = false;
+
     log_filename = "";
 
+    thread_pool = NULL;
+    evaluation_rnn = NULL;
+    structural_hash_valid = false;
+
     uint16_t seed = std::chrono::system_clock::now().time_since_epoch().count();
     generator = minstd_rand0(seed);
     rng_0_1 = uniform_real_distribution<double>(0.0, 1.0);
@@ -165,7 +173,22 @@ RNN_Genome* RNN_Genome::copy() {
     other->use_dropout = use_dropout;
     other->dropout_probability = dropout_probability;
 
+    other->bptt_window = bptt_window;
+    other->bptt_stride = bptt_stride;
+
+    other->early_stop_threshold = early_stop_threshold;
+    other->early_stop_grace = early_stop_grace;
+
+    other->training_series_fraction = training_series_fraction;
+
+    other->keep_optimizer_state = keep_optimizer_state;
+    other->optimizer_parameters = optimizer_parameters;
+    other->optimizer_velocity = optimizer_velocity;
+    other->optimizer_gradient = optimizer_gradient;
+    other->optimizer_series_state = optimizer_series_state;
+
     other->log_filename = log_filename;
+    other->thread_pool = thread_pool;
 
     other->generated_by_map = generated_by_map;
 
@@ -188,6 +211,8 @@ RNN_Genome* RNN_Genome::copy() {
 
 
 RNN_Genome::~RNN_Genome() {
+    if (evaluation_rnn != NULL) delete evaluation_rnn;
+
     RNN_Node_Interface *node;
 
     while (nodes.size() > 0) {
@@ -461,6 +486,44 @@ void RNN_Genome::set_log_filename(string _log_filename) {
     log_filename = _log_filename;
 }
 
+void RNN_Genome::set_thread_pool(ThreadPool *_thread_pool) {
+    thread_pool = _thread_pool;
+}
+
+void RNN_Genome::set_truncated_bptt(int32_t _bptt_window, int32_t _bptt_stride) {
+    bptt_window = _bptt_window;
+    bptt_stride = _bptt_stride;
+}
+
+void RNN_Genome::set_early_stop(double _early_stop_threshold, int32_t _early_stop_grace) {
+    early_stop_threshold = _early_stop_threshold;
+    early_stop_grace = _early_stop_grace;
+}
+
+double RNN_Genome::get_early_stop_threshold() const {
+    return early_stop_threshold;
+}
+
+void RNN_Genome::set_training_series_fraction(double _training_series_fraction) {
+    training_series_fraction = _training_series_fraction;
+}
+
+double RNN_Genome::get_training_series_fraction() const {
+    return training_series_fraction;
+}
+
+void RNN_Genome::set_keep_optimizer_state(bool _keep_optimizer_state) {
+    keep_optimizer_state = _keep_optimizer_state;
+}
+
+bool RNN_Genome::get_keep_optimizer_state() const {
+    return keep_optimizer_state;
+}
+
+bool RNN_Genome::has_optimizer_state() const {
+    return optimizer_parameters.size() > 0;
+}
+
 void RNN_Genome::get_weights(vector<double> &parameters) {
     parameters.resize(get_number_weights());
 
@@ -563,6 +626,11 @@ RNN* RNN_Genome::get_rnn() {
     return new RNN(node_copies, edge_copies, recurrent_edge_copies);
 }
 
+RNN* RNN_Genome::get_evaluation_rnn() {
+    if (evaluation_rnn == NULL) evaluation_rnn = get_rnn();
+    return evaluation_rnn;
+}
+
 vector<double> RNN_Genome::get_best_parameters() const {
     return best_parameters;
 }
@@ -603,72 +671,134 @@ bool RNN_Genome::sanity_check() {
 }
 
 
-void forward_pass_thread(RNN* rnn, const vector<double> &parameters, const vector< vector<double> > &inputs, const vector< vector<double> > &outputs, uint32_t i, double *mses, bool use_dropout, bool training, double dropout_probability) {
-    rnn->set_weights(parameters);
-    rnn->forward_pass(inputs, use_dropout, training, dropout_probability);
-    mses[i] = rnn->calculate_error_mse(outputs);
+void RNN_Genome::get_analytic_gradient(vector<RNN*> &rnns, const vector<double> &parameters, const SeriesViews &inputs, const SeriesViews &outputs, double &mse, vector<double> &analytic_gradient, bool training) {
+    ThreadPool *pool = thread_pool;
+    if (pool == NULL) pool = ThreadPool::get_shared();
 
-    //mses[i] = rnn->calculate_error_mae(outputs);
-    //cout << "mse[" << i << "]: " << mse_current << endl;
-}
+    int32_t n_series = inputs.size();
+    int32_t n_rnns = rnns.size();
+    int32_t n_parameters = parameters.size();
+
+    //each rnn runs a contiguous range of the series as one batch
+    vector<int32_t> first_series(n_rnns + 1);
+    for (int32_t i = 0; i <= n_rnns; i++) {
+        first_series[i] = ((int64_t)n_series * i) / n_rnns;
+    }
+
+    //the tasks capture everything by reference, so neither the parameters
+    //nor the training series are copied for each series
+    vector<double> mses(n_series, 0.0);
+    vector< vector<double> > series_gradients(n_rnns);
+
+    if (bptt_window > 0) {
+        //the windows are backpropagated as they are run, so the forward
+        //and backward passes happen in one go
+        pool->parallel_for(n_rnns, [&](int32_t i) {
+            int32_t number_series = first_series[i + 1] - first_series[i];
+            if (number_series == 0) {
+                series_gradients[i].assign(n_parameters, 0.0);
+                return;
+            }
 
-void RNN_Genome::get_analytic_gradient(vector<RNN*> &rnns, const vector<double> &parameters, const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs, double &mse, vector<double> &analytic_gradient, bool training) {
+            vector<double> batch_mses;
+            rnns[i]->get_truncated_gradient(parameters, inputs, outputs, first_series[i], number_series, bptt_window, bptt_stride, batch_mses, series_gradients[i], use_dropout, training, dropout_probability);
 
-    double *mses = new double[rnns.size()];
-    double mse_sum = 0.0;
-    vector<thread> threads;
-    for (uint32_t i = 0; i < rnns.size(); i++) {
-        threads.push_back( thread(forward_pass_thread, rnns[i], parameters, inputs[i], outputs[i], i, mses, use_dropout, training, dropout_probability) );
+            for (int32_t lane = 0; lane < number_series; lane++) {
+                mses[first_series[i] + lane] = batch_mses[lane];
+            }
+        });
+
+        mse = 0.0;
+        for (int32_t i = 0; i < n_series; i++) {
+            mse += mses[i];
+        }
+
+        sum_gradients(pool, series_gradients, n_parameters, analytic_gradient);
+        return;
     }
 
-    for (uint32_t i = 0; i < rnns.size(); i++) {
-        threads[i].join();
+    pool->parallel_for(n_rnns, [&](int32_t i) {
+        int32_t number_series = first_series[i + 1] - first_series[i];
+        if (number_series == 0) return;
+
+        vector<double> batch_mses;
+        rnns[i]->set_weights(parameters);
+        rnns[i]->forward_pass(inputs, first_series[i], number_series, use_dropout, training, dropout_probability);
+        rnns[i]->calculate_error_mse(outputs, first_series[i], batch_mses);
+
+        for (int32_t lane = 0; lane < number_series; lane++) {
+            mses[first_series[i] + lane] = batch_mses[lane];
+        }
+    });
+
+    double mse_sum = 0.0;
+    for (int32_t i = 0; i < n_series; i++) {
         mse_sum += mses[i];
     }
-    delete [] mses;
+    mse = mse_sum;
 
-    for (uint32_t i = 0; i < rnns.size(); i++) {
-        double d_mse = mse_sum * (1.0 / outputs[i][0].size()) * 2.0;
-        rnns[i]->backward_pass(d_mse, use_dropout, training, dropout_probability);
+    pool->parallel_for(n_rnns, [&](int32_t i) {
+        int32_t number_series = first_series[i + 1] - first_series[i];
+        if (number_series == 0) {
+            series_gradients[i].assign(n_parameters, 0.0);
+            return;
+        }
 
-        //double d_mae = mse_sum * (1.0 / outputs[i][0].size());
-        //rnns[i]->backward_pass(d_mae);
+        vector<double> d_mses(number_series);
+        for (int32_t lane = 0; lane < number_series; lane++) {
+            d_mses[lane] = mse_sum * (1.0 / outputs[first_series[i] + lane].get_length()) * 2.0;
+        }
 
-    }
+        rnns[i]->backward_pass(d_mses, use_dropout, training, dropout_probability);
+        rnns[i]->get_gradients(series_gradients[i]);
+    });
 
-    mse = mse_sum;
+    sum_gradients(pool, series_gradients, n_parameters, analytic_gradient);
+}
 
-    vector<double> current_gradients;
-    analytic_gradient.assign(parameters.size(), 0.0);
-    for (uint32_t k = 0; k < rnns.size(); k++) {
+void RNN_Genome::sum_gradients(ThreadPool *pool, const vector< vector<double> > &series_gradients, int32_t n_parameters, vector<double> &analytic_gradient) {
+    int32_t n_rnns = series_gradients.size();
 
-        uint32_t current = 0;
-        for (uint32_t i = 0; i < rnns[k]->get_number_nodes(); i++) {
-            rnns[k]->get_node(i)->get_gradients(current_gradients);
+    //reduce the per series gradients, each task sums a contiguous block of parameters
+    analytic_gradient.assign(n_parameters, 0.0);
+    int32_t n_blocks = min(n_parameters, pool->get_number_threads() + 1);
+    pool->parallel_for(n_blocks, [&](int32_t block) {
+        int32_t start = ((int64_t)n_parameters * block) / n_blocks;
+        int32_t end = ((int64_t)n_parameters * (block + 1)) / n_blocks;
 
-            for (uint32_t j = 0; j < current_gradients.size(); j++) {
-                analytic_gradient[current] += current_gradients[j];
-                current++;
+        for (int32_t k = 0; k < n_rnns; k++) {
+            const double *gradient = series_gradients[k].data();
+            for (int32_t j = start; j < end; j++) {
+                analytic_gradient[j] += gradient[j];
             }
         }
+    });
+}
 
-        for (uint32_t i = 0; i < rnns[k]->get_number_edges(); i++) {
-            analytic_gradient[current] += rnns[k]->get_edge(i)->get_gradient();
-            current++;
-        }
+
+void RNN_Genome::get_series_gradient(RNN *rnn, const vector<double> &parameters, const SeriesViews &inputs, const SeriesViews &outputs, int32_t series, double &mse, vector<double> &analytic_gradient) {
+    if (bptt_window > 0) {
+        vector<double> mses;
+        rnn->get_truncated_gradient(parameters, inputs, outputs, series, 1, bptt_window, bptt_stride, mses, analytic_gradient, use_dropout, true, dropout_probability);
+        mse = mses[0];
+    } else {
+        rnn->get_analytic_gradient(parameters, inputs[series], outputs[series], mse, analytic_gradient, use_dropout, true, dropout_probability);
     }
 }
 
-
-void RNN_Genome::backpropagate(const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs, const vector< vector< vector<double> > > &validation_inputs, const vector< vector< vector<double> > > &validation_outputs) {
+void RNN_Genome::backpropagate(const SeriesViews &inputs, const SeriesViews &outputs, const SeriesViews &validation_inputs, const SeriesViews &validation_outputs) {
 
     double learning_rate = this->learning_rate / inputs.size();
     double low_threshold = sqrt(this->low_threshold * inputs.size());
     double high_threshold = sqrt(this->high_threshold * inputs.size());
 
-    int32_t n_series = inputs.size();
+    //one rnn per thread, each runs its share of the series as a batch
+    ThreadPool *pool = thread_pool;
+    if (pool == NULL) pool = ThreadPool::get_shared();
+
+    int32_t n_rnns = min<int32_t>(inputs.size(), pool->get_number_threads() + 1);
     vector<RNN*> rnns;
-    for (int32_t i = 0; i < n_series; i++) {
+    for (int32_t i = 0; i < n_rnns; i++) {
         rnns.push_back( this->get_rnn() );
     }
 
@@ -875,7 +1005,23 @@ void RNN_Genome::backpropagate(const vector< vector< vector<double> > > &inputs,
     this->set_weights(best_parameters);
 }
 
-void RNN_Genome::backpropagate_stochastic(const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs, const vector< vector< vector<double> > > &validation_inputs, const vector< vector< vector<double> > > &validation_outputs) {
+double RNN_Genome::extrapolate_fitness(const vector<double> &fitness_history, int32_t total_iterations) const {
+    //assume the fitness keeps improving by the same factor every grace period
+    //that it did over the last one, which is optimistic as learning curves
+    //flatten out, so a genome is only stopped when even that isn't enough
+    int32_t completed = fitness_history.size() - 1;
+    double current = fitness_history[completed];
+    double previous = fitness_history[completed - early_stop_grace];
+
+    if (previous <= 0.0 || current <= 0.0) return current;
+
+    double ratio = current / previous;
+    if (ratio > 1.0) ratio = 1.0;
+
+    return current * pow(ratio, (double)(total_iterations - completed) / early_stop_grace);
+}
+
+void RNN_Genome::backpropagate_stochastic(const SeriesViews &inputs, const SeriesViews &outputs, const SeriesViews &validation_inputs, const SeriesViews &validation_outputs) {
 
     vector<double> parameters = initial_parameters;
 
@@ -902,15 +1048,39 @@ void RNN_Genome::backpropagate_stochastic(const vector< vector< vector<double> >
 
     std::chrono::time_point<std::chrono::system_clock> startClock = std::chrono::system_clock::now();
 
-    RNN* rnn = get_rnn();
+    //a genome continuing its training (e.g. one promoted by successive
+    //halving) picks the optimizer up where it left off
+    bool resume_optimizer = (int32_t)optimizer_parameters.size() == n_parameters
+        && (int32_t)optimizer_velocity.size() == n_parameters
+        && (int32_t)optimizer_gradient.size() == n_parameters
+        && (int32_t)optimizer_series_state.size() == (4 * n_series) + 4;
+
+    if (resume_optimizer) {
+        parameters = optimizer_parameters;
+        prev_velocity = optimizer_velocity;
+        analytic_gradient = optimizer_gradient;
+
+        for (int32_t i = 0; i < n_series; i++) {
+            prev_mu[i] = optimizer_series_state[(4 * i)];
+            prev_norm[i] = optimizer_series_state[(4 * i) + 1];
+            prev_mse[i] = optimizer_series_state[(4 * i) + 2];
+            prev_learning_rate[i] = optimizer_series_state[(4 * i) + 3];
+        }
+        mu = optimizer_series_state[(4 * n_series)];
+        norm = optimizer_series_state[(4 * n_series) + 1];
+        mse = optimizer_series_state[(4 * n_series) + 2];
+        learning_rate = optimizer_series_state[(4 * n_series) + 3];
+    }
+
+    RNN* rnn = get_evaluation_rnn();
     rnn->set_weights(parameters);
 
     //initialize the initial previous values
-    for (uint32_t i = 0; i < n_series; i++) {
+    for (uint32_t i = 0; i < n_series && !resume_optimizer; i++) {
         //cout << "getting analytic gradient for input/output: " << i << ", n_series: " << n_series << ", parameters.size: " << parameters.size() << ", log filename: " << log_filename << endl;
         //cout << "inputs.size(): " << inputs.size()  << ", outputs.size(): " << outputs.size() << ", log filename: " << log_filename << endl;
 
-        rnn->get_analytic_gradient(parameters, inputs[i], outputs[i], mse, analytic_gradient, use_dropout, true, dropout_probability);
+        get_series_gradient(rnn, parameters, inputs, outputs, i, mse, analytic_gradient);
         //cout << "got analytic gradient, inputs.size(): " << inputs.size()  << ", outputs.size(): " << outputs.size() << ", log filename: " << log_filename << endl;
 
         norm = 0.0;
@@ -927,9 +1097,12 @@ void RNN_Genome::backpropagate_stochastic(const vector< vector< vector<double> >
 
     //TODO: need to get validation error on the RNN not the genome
     double validation_mse = get_mse(parameters, validation_inputs, validation_outputs, false);
-    best_validation_mse = validation_mse;
-    best_validation_mae = get_mae(parameters, validation_inputs, validation_outputs);
-    best_parameters = parameters;
+    //the best parameters of the training so far are kept if they're better
+    if (!resume_optimizer || validation_mse < best_validation_mse) {
+        best_validation_mse = validation_mse;
+        best_validation_mae = get_mae(parameters, validation_inputs, validation_outputs);
+        best_parameters = parameters;
+    }
 
     //cout << "got initial errors on: " << log_filename << endl;
 
@@ -948,10 +1121,12 @@ void RNN_Genome::backpropagate_stochastic(const vector< vector< vector<double> >
     uniform_real_distribution<double> rng(0, 1);
 
     int random_selection = rng(generator);
-    mu = prev_mu[random_selection];
-    norm = prev_norm[random_selection];
-    mse = prev_mse[random_selection];
-    learning_rate = prev_learning_rate[random_selection];
+    if (!resume_optimizer) {
+        mu = prev_mu[random_selection];
+        norm = prev_norm[random_selection];
+        mse = prev_mse[random_selection];
+        learning_rate = prev_learning_rate[random_selection];
+    }
 
     ofstream *output_log = NULL;
     ostringstream memory_log;
@@ -974,14 +1149,22 @@ void RNN_Genome::backpropagate_stochastic(const vector< vector< vector<double> >
         shuffle_order.push_back(i);
     }
 
+    //a different random subsample of the series is used every iteration
+    int32_t series_per_iteration = ceil(training_series_fraction * shuffle_order.size());
+    if (series_per_iteration < 1) series_per_iteration = 1;
+    if (series_per_iteration > (int32_t)shuffle_order.size()) series_per_iteration = shuffle_order.size();
+
     bool was_reset = false;
     int reset_count = 0;
 
+    //best fitness after each iteration, starting with the initial fitness
+    vector<double> fitness_history(1, get_fitness());
+
     for (uint32_t iteration = 0; iteration < bp_iterations; iteration++) {
         fisher_yates_shuffle(generator, shuffle_order);
 
         double avg_norm = 0.0;
-        for (uint32_t k = 0; k < shuffle_order.size(); k++) {
+        for (int32_t k = 0; k < series_per_iteration; k++) {
             random_selection = shuffle_order[k];
 
             prev_mu[random_selection] = mu;
@@ -991,7 +1174,14 @@ void RNN_Genome::backpropagate_stochastic(const vector< vector< vector<double> >
 
             prev_gradient = analytic_gradient;
 
-            rnn->get_analytic_gradient(parameters, inputs[random_selection], outputs[random_selection], mse, analytic_gradient, use_dropout, true, dropout_probability);
+            //if the series are streamed, the next one is read in while this
+            //one is trained on
+            if (k + 1 < series_per_iteration) {
+                inputs[shuffle_order[k + 1]].will_need();
+                outputs[shuffle_order[k + 1]].will_need();
+            }
+
+            get_series_gradient(rnn, parameters, inputs, outputs, random_selection, mse, analytic_gradient);
 
             norm = 0.0;
             for (int32_t i = 0; i < parameters.size(); i++) {
@@ -1154,6 +1344,14 @@ void RNN_Genome::backpropagate_stochastic(const vector< vector< vector<double> >
 
         cout << "iteration " << setw(5) << iteration << ", mse: " << training_error << ", v_mse: " << validation_mse << ", bv_mse: " << best_validation_mse << ", avg_norm: " << avg_norm << endl;
 
+        fitness_history.push_back(get_fitness());
+        if (early_stop_grace > 0 && (int32_t)iteration + 1 >= early_stop_grace && (int32_t)iteration + 1 < bp_iterations) {
+            double predicted_fitness = extrapolate_fitness(fitness_history, bp_iterations);
+            if (predicted_fitness > early_stop_threshold) {
+                cout << "stopping early at iteration " << iteration << ", predicted fitness: " << predicted_fitness << " > threshold: " << early_stop_threshold << endl;
+                break;
+            }
+        }
     }
 
     if (log_filename != "") {
@@ -1162,7 +1360,28 @@ void RNN_Genome::backpropagate_stochastic(const vector< vector< vector<double> >
         memory_log_file.close();
     }
 
-    delete rnn;
+    if (keep_optimizer_state) {
+        optimizer_parameters = parameters;
+        optimizer_velocity = prev_velocity;
+        optimizer_gradient = analytic_gradient;
+
+        optimizer_series_state.resize((4 * n_series) + 4);
+        for (int32_t i = 0; i < n_series; i++) {
+            optimizer_series_state[(4 * i)] = prev_mu[i];
+            optimizer_series_state[(4 * i) + 1] = prev_norm[i];
+            optimizer_series_state[(4 * i) + 2] = prev_mse[i];
+            optimizer_series_state[(4 * i) + 3] = prev_learning_rate[i];
+        }
+        optimizer_series_state[(4 * n_series)] = mu;
+        optimizer_series_state[(4 * n_series) + 1] = norm;
+        optimizer_series_state[(4 * n_series) + 2] = mse;
+        optimizer_series_state[(4 * n_series) + 3] = learning_rate;
+    } else {
+        optimizer_parameters.clear();
+        optimizer_velocity.clear();
+        optimizer_gradient.clear();
+        optimizer_series_state.clear();
+    }
 
     this->set_weights(best_parameters);
     cout << "backpropagation completed, getting mu/sigma" << endl;
@@ -1170,16 +1389,23 @@ void RNN_Genome::backpropagate_stochastic(const vector< vector< vector<double> >
     get_mu_sigma(best_parameters, _mu, _sigma);
 }
 
-double RNN_Genome::get_mse(const vector<double> &parameters, const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs, bool verbose) {
-    RNN *rnn = get_rnn();
+double RNN_Genome::get_mse(const vector<double> &parameters, const SeriesViews &inputs, const SeriesViews &outputs, bool verbose) {
+    RNN *rnn = get_evaluation_rnn();
     rnn->set_weights(parameters);
 
     double mse = 0.0;
     double avg_mse = 0.0;
 
     int32_t width = ceil(log10(inputs.size()));
-    for (uint32_t i = 0; i < inputs.size(); i++) {
-        mse = rnn->prediction_mse(inputs[i], outputs[i], use_dropout, false, dropout_probability);
+    for (int32_t i = 0; i < inputs.size(); i++) {
+        //with truncated bptt the series are run a window at a time, so the
+        //rnn's arena doesn't grow to the length of the whole series
+        if (bptt_window > 0) {
+            double mae;
+            rnn->get_windowed_errors(inputs[i], outputs[i], bptt_window, mse, mae, use_dropout, false, dropout_probability);
+        } else {
+            mse = rnn->prediction_mse(inputs[i], outputs[i], use_dropout, false, dropout_probability);
+        }
 
         avg_mse += mse;
 
@@ -1188,8 +1414,6 @@ double RNN_Genome::get_mse(const vector<double> &parameters, const vector< vecto
         }
     }
 
-    delete rnn;
-
     avg_mse /= inputs.size();
     if (verbose) {
         cout << "average MSE:   " << string(width, ' ') << avg_mse << endl;
@@ -1197,16 +1421,21 @@ double RNN_Genome::get_mse(const vector<double> &parameters, const vector< vecto
     return avg_mse;
 }
 
-double RNN_Genome::get_mae(const vector<double> &parameters, const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs, bool verbose) {
-    RNN *rnn = get_rnn();
+double RNN_Genome::get_mae(const vector<double> &parameters, const SeriesViews &inputs, const SeriesViews &outputs, bool verbose) {
+    RNN *rnn = get_evaluation_rnn();
     rnn->set_weights(parameters);
 
     double mae;
     double avg_mae = 0.0;
 
     int32_t width = ceil(log10(inputs.size()));
-    for (uint32_t i = 0; i < inputs.size(); i++) {
-        mae = rnn->prediction_mae(inputs[i], outputs[i], use_dropout, false, dropout_probability);
+    for (int32_t i = 0; i < inputs.size(); i++) {
+        if (bptt_window > 0) {
+            double mse;
+            rnn->get_windowed_errors(inputs[i], outputs[i], bptt_window, mse, mae, use_dropout, false, dropout_probability);
+        } else {
+            mae = rnn->prediction_mae(inputs[i], outputs[i], use_dropout, false, dropout_probability);
+        }
 
         avg_mae += mae;
 
@@ -1215,8 +1444,6 @@ double RNN_Genome::get_mae(const vector<double> &parameters, const vector< vecto
         }
     }
 
-    delete rnn;
-
     avg_mae /= inputs.size();
     if (verbose) {
         cout << "average MAE:   " << string(width, ' ') << avg_mae << endl;
@@ -1224,28 +1451,26 @@ double RNN_Genome::get_mae(const vector<double> &parameters, const vector< vecto
     return avg_mae;
 }
 
-vector< vector<double> > RNN_Genome::get_predictions(const vector<double> &parameters, const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs) {
-    RNN *rnn = get_rnn();
+vector< vector<double> > RNN_Genome::get_predictions(const vector<double> &parameters, const SeriesViews &inputs, const SeriesViews &outputs) {
+    RNN *rnn = get_evaluation_rnn();
     rnn->set_weights(parameters);
 
     vector< vector<double> > all_results;
     
     //one input vector per testing file
-    for (uint32_t i = 0; i < inputs.size(); i++) {
+    for (int32_t i = 0; i < inputs.size(); i++) {
         all_results.push_back(rnn->get_predictions(inputs[i], outputs[i], use_dropout, dropout_probability));
     }
 
-    delete rnn;
-
     return all_results;
 }
 
 
-void RNN_Genome::write_predictions(const vector<string> &input_filenames, const vector<double> &parameters, const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs) {
-    RNN *rnn = get_rnn();
+void RNN_Genome::write_predictions(const vector<string> &input_filenames, const vector<double> &parameters, const SeriesViews &inputs, const SeriesViews &outputs) {
+    RNN *rnn = get_evaluation_rnn();
     rnn->set_weights(parameters);
 
-    for (uint32_t i = 0; i < inputs.size(); i++) {
+    for (int32_t i = 0; i < inputs.size(); i++) {
         cout << "input filename[" << i << "]: " << input_filenames[i] << endl;
 
         string output_filename = "predictions_" + std::to_string(i) + ".txt";
@@ -1253,8 +1478,6 @@ void RNN_Genome::write_predictions(const vector<string> &input_filenames, const
 
         rnn->write_predictions(output_filename, input_parameter_names, output_parameter_names, inputs[i], outputs[i], use_dropout, dropout_probability);
     }
-
-    delete rnn;
 }
 
 bool RNN_Genome::equals(RNN_Genome* other) {
@@ -1279,7 +1502,50 @@ bool RNN_Genome::equals(RNN_Genome* other) {
     return true;
 }
 
+static void hash_combine(uint64_t &hash, uint64_t value) {
+    //64 bit FNV-1a over the value's bytes
+    for (int32_t i = 0; i < 8; i++) {
+        hash ^= (value >> (i * 8)) & 0xff;
+        hash *= 1099511628211ull;
+    }
+}
+
+uint64_t RNN_Genome::get_structural_hash() {
+    if (structural_hash_valid) return structural_hash;
+
+    //covers exactly what equals compares, in the same order, so equal
+    //genomes always hash the same. an innovation number also pins down the
+    //node type, edge endpoints and recurrent depth
+    structural_hash = 14695981039346656037ull;
+    hash_combine(structural_hash, nodes.size());
+    hash_combine(structural_hash, edges.size());
+    hash_combine(structural_hash, recurrent_edges.size());
+
+    for (int32_t i = 0; i < (int32_t)nodes.size(); i++) {
+        hash_combine(structural_hash, ((uint64_t)nodes[i]->innovation_number << 1) | nodes[i]->enabled);
+    }
+
+    for (int32_t i = 0; i < (int32_t)edges.size(); i++) {
+        hash_combine(structural_hash, ((uint64_t)edges[i]->innovation_number << 1) | edges[i]->enabled);
+    }
+
+    for (int32_t i = 0; i < (int32_t)recurrent_edges.size(); i++) {
+        hash_combine(structural_hash, ((uint64_t)recurrent_edges[i]->innovation_number << 1) | recurrent_edges[i]->enabled);
+    }
+
+    structural_hash_valid = true;
+    return structural_hash;
+}
+
 void RNN_Genome::assign_reachability() {
+    //reachability is reassigned whenever the structure of the genome changes,
+    //so any RNN built from the previous structure (and its hash) is stale
+    if (evaluation_rnn != NULL) {
+        delete evaluation_rnn;
+        evaluation_rnn = NULL;
+    }
+    structural_hash_valid = false;
+
     //cout << "assigning reachability!" << endl;
     //cout << nodes.size() << " nodes, " << edges.size() << " edges, " << recurrent_edges.size() << " recurrent_edges" << endl;
 
@@ -1523,7 +1789,7 @@ void RNN_Genome::get_mu_sigma(const vector<double> &p, double &mu, double &sigma
 }
 
 
-RNN_Node_Interface* RNN_Genome::create_node(double mu, double sigma, int node_type, int32_t &node_innovation_count, double depth) {
+RNN_Node_Interface* RNN_Genome::create_node(double mu, double sigma, int node_type, atomic<int32_t> &node_innovation_count, double depth) {
     RNN_Node_Interface *n = NULL;
 
     cout << "CREATING " << NODE_TYPES[node_type] << endl;
@@ -1549,7 +1815,7 @@ RNN_Node_Interface* RNN_Genome::create_node(double mu, double sigma, int node_ty
     return n;
 }
 
-bool RNN_Genome::attempt_edge_insert(RNN_Node_Interface *n1, RNN_Node_Interface *n2, double mu, double sigma, int32_t &edge_innovation_count) {
+bool RNN_Genome::attempt_edge_insert(RNN_Node_Interface *n1, RNN_Node_Interface *n2, double mu, double sigma, atomic<int32_t> &edge_innovation_count) {
     cout << "\tadding edge between nodes " << n1->innovation_number << " and " << n2->innovation_number << endl;
 
     if (n1->depth == n2->depth) {
@@ -1592,7 +1858,7 @@ bool RNN_Genome::attempt_edge_insert(RNN_Node_Interface *n1, RNN_Node_Interface
     return true;
 }
 
-bool RNN_Genome::attempt_recurrent_edge_insert(RNN_Node_Interface *n1, RNN_Node_Interface *n2, double mu, double sigma, int32_t max_recurrent_depth, int32_t &edge_innovation_count) {
+bool RNN_Genome::attempt_recurrent_edge_insert(RNN_Node_Interface *n1, RNN_Node_Interface *n2, double mu, double sigma, int32_t max_recurrent_depth, atomic<int32_t> &edge_innovation_count) {
     cout << "\tadding recurrent edge between nodes " << n1->innovation_number << " and " << n2->innovation_number << endl;
 
     //check to see if an edge between the two nodes already exists
@@ -1623,7 +1889,7 @@ bool RNN_Genome::attempt_recurrent_edge_insert(RNN_Node_Interface *n1, RNN_Node_
     return true;
 }
 
-void RNN_Genome::generate_recurrent_edges(RNN_Node_Interface *node, double mu, double sigma, int32_t max_recurrent_depth, int32_t &edge_innovation_count) {
+void RNN_Genome::generate_recurrent_edges(RNN_Node_Interface *node, double mu, double sigma, int32_t max_recurrent_depth, atomic<int32_t> &edge_innovation_count) {
 
     if (node->node_type == JORDAN_NODE) {
         for (int32_t i = 0; i < (int32_t)edges.size(); i++) {
@@ -1640,7 +1906,7 @@ void RNN_Genome::generate_recurrent_edges(RNN_Node_Interface *node, double mu, d
 
 
 
-bool RNN_Genome::add_edge(double mu, double sigma, int32_t &edge_innovation_count) {
+bool RNN_Genome::add_edge(double mu, double sigma, atomic<int32_t> &edge_innovation_count) {
     cout << "\tattempting to add edge!" << endl;
     vector<RNN_Node_Interface*> reachable_nodes;
     for (int32_t i = 0; i < (int32_t)nodes.size(); i++) {
@@ -1672,7 +1938,7 @@ bool RNN_Genome::add_edge(double mu, double sigma, int32_t &edge_innovation_coun
     return attempt_edge_insert(n1, n2, mu, sigma, edge_innovation_count);
 }
 
-bool RNN_Genome::add_recurrent_edge(double mu, double sigma, Distribution* dist, int32_t &edge_innovation_count) {
+bool RNN_Genome::add_recurrent_edge(double mu, double sigma, Distribution* dist, atomic<int32_t> &edge_innovation_count) {
     cout << "\tattempting to add recurrent edge!" << endl;
 
     vector<RNN_Node_Interface*> possible_input_nodes;
@@ -1795,7 +2061,7 @@ bool RNN_Genome::enable_edge() {
 }
 
 
-bool RNN_Genome::split_edge(double mu, double sigma, int node_type, int32_t max_recurrent_depth, int32_t &edge_innovation_count, int32_t &node_innovation_count) {
+bool RNN_Genome::split_edge(double mu, double sigma, int node_type, int32_t max_recurrent_depth, atomic<int32_t> &edge_innovation_count, atomic<int32_t> &node_innovation_count) {
     cout << "\tattempting to split an edge!" << endl;
     vector<RNN_Edge*> enabled_edges;
     for (int32_t i = 0; i < edges.size(); i++) {
@@ -1844,7 +2110,7 @@ bool RNN_Genome::split_edge(double mu, double sigma, int node_type, int32_t max_
     return true;
 }
 
-bool RNN_Genome::add_node(double mu, double sigma, int node_type, int32_t max_recurrent_depth, int32_t &edge_innovation_count, int32_t &node_innovation_count) {
+bool RNN_Genome::add_node(double mu, double sigma, int node_type, int32_t max_recurrent_depth, atomic<int32_t> &edge_innovation_count, atomic<int32_t> &node_innovation_count) {
     double split_depth = rng_0_1(generator);
 
     vector<RNN_Node_Interface*> possible_inputs;
@@ -1974,7 +2240,7 @@ bool RNN_Genome::disable_node() {
     return true;
 }
 
-bool RNN_Genome::split_node(double mu, double sigma, int node_type, int32_t max_recurrent_depth, int32_t &edge_innovation_count, int32_t &node_innovation_count) {
+bool RNN_Genome::split_node(double mu, double sigma, int node_type, int32_t max_recurrent_depth, atomic<int32_t> &edge_innovation_count, atomic<int32_t> &node_innovation_count) {
     cout << "\tattempting to split a node!" << endl;
     vector<RNN_Node_Interface*> possible_nodes;
     for (int32_t i = 0; i < (int32_t)nodes.size(); i++) {
@@ -2159,7 +2425,7 @@ bool RNN_Genome::split_node(double mu, double sigma, int node_type, int32_t max_
     return true;
 }
 
-bool RNN_Genome::merge_node(double mu, double sigma, int node_type, int32_t max_recurrent_depth, int32_t &edge_innovation_count, int32_t &node_innovation_count) {
+bool RNN_Genome::merge_node(double mu, double sigma, int node_type, int32_t max_recurrent_depth, atomic<int32_t> &edge_innovation_count, atomic<int32_t> &node_innovation_count) {
     cout << "\tattempting to merge a node!" << endl;
     vector<RNN_Node_Interface*> possible_nodes;
     for (int32_t i = 0; i < (int32_t)nodes.size(); i++) {
@@ -2361,7 +2627,11 @@ string RNN_Genome::get_color(double weight, bool is_recurrent) {
 
 void RNN_Genome::write_graphviz(string filename) {
     ofstream outfile(filename);
+    write_graphviz(outfile);
+    outfile.close();
+}
 
+void RNN_Genome::write_graphviz(ostream &outfile) {
     outfile << "digraph RNN {" << endl;
     outfile << "labelloc=\"t\";" << endl;
     outfile << "label=\"Genome Fitness: " << best_validation_mae * 100.0 << "% MAE\";" << endl;
@@ -2480,8 +2750,6 @@ void RNN_Genome::write_graphviz(string filename) {
 
 
     outfile << "}" << endl;
-    outfile.close();
-
 }
 
 void read_map(istream &in, map<string, double> &m) {
@@ -2553,6 +2821,16 @@ void read_binary_string(istream &in, string &s, string name, bool verbose) {
 
 
 RNN_Genome::RNN_Genome(string binary_filename, bool verbose) {
+    thread_pool = NULL;
+    evaluation_rnn = NULL;
+    structural_hash_valid = false;
+    bptt_window = 0;
+    bptt_stride = 0;
+    early_stop_threshold = EXAMM_MAX_DOUBLE;
+    early_stop_grace = 0;
+    training_series_fraction = 1.0;
+    keep_optimizer_state = false;
+
     ifstream bin_infile(binary_filename, ios::in | ios::binary);
 
     if (!bin_infile.good()) {
@@ -2565,26 +2843,65 @@ RNN_Genome::RNN_Genome(string binary_filename, bool verbose) {
 }
 
 RNN_Genome::RNN_Genome(char *array, int32_t length, bool verbose) {
+    thread_pool = NULL;
+    evaluation_rnn = NULL;
+    structural_hash_valid = false;
+    bptt_window = 0;
+    bptt_stride = 0;
+    early_stop_threshold = EXAMM_MAX_DOUBLE;
+    early_stop_grace = 0;
+    training_series_fraction = 1.0;
+    keep_optimizer_state = false;
     read_from_array(array, length, verbose);
 }
 
 RNN_Genome::RNN_Genome(istream &bin_infile, bool verbose) {
+    thread_pool = NULL;
+    evaluation_rnn = NULL;
+    structural_hash_valid = false;
+    bptt_window = 0;
+    bptt_stride = 0;
+    early_stop_threshold = EXAMM_MAX_DOUBLE;
+    early_stop_grace = 0;
+    training_series_fraction = 1.0;
+    keep_optimizer_state = false;
     read_from_stream(bin_infile, verbose);
 }
 
 void RNN_Genome::read_from_array(char *array, int32_t length, bool verbose) {
-    string array_str;
-    for (uint32_t i = 0; i < length; i++) {
-        array_str.push_back(array[i]);
-    }
-
-    istringstream iss(array_str);
+    istringstream iss(string(array, length));
     read_from_stream(iss, verbose);
 }
 
+static RNN_Node_Interface* read_node(int32_t innovation_number, int32_t type, int32_t node_type, double depth) {
+    if (node_type == LSTM_NODE) {
+        return new LSTM_Node(innovation_number, type, depth);
+    } else if (node_type == DELTA_NODE) {
+        return new Delta_Node(innovation_number, type, depth);
+    } else if (node_type == GRU_NODE) {
+        return new GRU_Node(innovation_number, type, depth);
+    } else if (node_type == MGU_NODE) {
+        return new MGU_Node(innovation_number, type, depth);
+    } else if (node_type == UGRNN_NODE) {
+        return new UGRNN_Node(innovation_number, type, depth);
+    } else if (node_type == SIMPLE_NODE || node_type == JORDAN_NODE || node_type == ELMAN_NODE) {
+        return new RNN_Node(innovation_number, type, depth, node_type);
+    } else {
+        cerr << "Error reading node from stream, unknown node_type: " << node_type << endl;
+        exit(1);
+    }
+}
+
 void RNN_Genome::read_from_stream(istream &bin_istream, bool verbose) {
     if (verbose) cout << "READING GENOME FROM STREAM" << endl;
     bin_istream.read((char*)&generation_id, sizeof(int32_t));
+
+    //a genome written by write_to_compact_stream starts with a marker where
+    //the generation id would be
+    if (generation_id == COMPACT_GENOME_MARKER) {
+        read_from_compact_stream(bin_istream, verbose);
+        return;
+    }
     bin_istream.read((char*)&island, sizeof(int32_t));
     bin_istream.read((char*)&bp_iterations, sizeof(int32_t));
     bin_istream.read((char*)&learning_rate, sizeof(double));
@@ -2697,24 +3014,7 @@ void RNN_Genome::read_from_stream(istream &bin_istream, bool verbose) {
 
         if (verbose) cout << "NODE: " << innovation_number << " " << type << " " << node_type << " " << depth << " " << enabled << endl;
 
-        RNN_Node_Interface *node;
-        if (node_type == LSTM_NODE) {
-            node = new LSTM_Node(innovation_number, type, depth);
-        } else if (node_type == DELTA_NODE) {
-            node = new Delta_Node(innovation_number, type, depth);
-        } else if (node_type == GRU_NODE) {
-            node = new GRU_Node(innovation_number, type, depth);
-        } else if (node_type == MGU_NODE) {
-            node = new MGU_Node(innovation_number, type, depth);
-        } else if (node_type == UGRNN_NODE) {
-            node = new UGRNN_Node(innovation_number, type, depth);
-        } else if (node_type == SIMPLE_NODE || node_type == JORDAN_NODE || node_type == ELMAN_NODE) {
-            node = new RNN_Node(innovation_number, type, depth, node_type);
-        } else {
-            cerr << "Error reading node from stream, unknown node_type: " << node_type << endl;
-            exit(1);
-        }
-
+        RNN_Node_Interface *node = read_node(innovation_number, type, node_type, depth);
         node->enabled = enabled;
         nodes.push_back(node);
     }
@@ -2783,6 +3083,320 @@ void RNN_Genome::read_from_stream(istream &bin_istream, bool verbose) {
     assign_reachability();
 }
 
+static void write_varint(ostream &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.put((char)((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.put((char)value);
+}
+
+static uint64_t read_varint(istream &in) {
+    uint64_t value = 0;
+    for (int32_t shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == EOF) break;
+
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) break;
+    }
+    return value;
+}
+
+//zigzag encoding keeps small negative numbers (e.g. innovation number
+//differences) small
+static void write_signed_varint(ostream &out, int64_t value) {
+    write_varint(out, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static int64_t read_signed_varint(istream &in) {
+    uint64_t value = read_varint(in);
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static void write_compact_string(ostream &out, const string &s) {
+    write_varint(out, s.size());
+    out.write(s.c_str(), s.size());
+}
+
+static void read_compact_string(istream &in, string &s) {
+    s.resize(read_varint(in));
+    in.read(&s[0], s.size());
+}
+
+static void write_compact_parameters(ostream &out, const vector<double> &parameters) {
+    write_varint(out, parameters.size());
+    out.write((char*)parameters.data(), sizeof(double) * parameters.size());
+}
+
+static void read_compact_parameters(istream &in, vector<double> &parameters) {
+    parameters.resize(read_varint(in));
+    in.read((char*)parameters.data(), sizeof(double) * parameters.size());
+}
+
+static void write_compact_bounds(ostream &out, const map<string,double> &bounds) {
+    write_varint(out, bounds.size());
+    for (auto bound = bounds.begin(); bound != bounds.end(); bound++) {
+        write_compact_string(out, bound->first);
+        out.write((char*)&bound->second, sizeof(double));
+    }
+}
+
+static void read_compact_bounds(istream &in, map<string,double> &bounds) {
+    bounds.clear();
+    int32_t n_bounds = read_varint(in);
+    for (int32_t i = 0; i < n_bounds; i++) {
+        string name;
+        read_compact_string(in, name);
+        in.read((char*)&bounds[name], sizeof(double));
+    }
+}
+
+#define COMPACT_ADAPT_LEARNING_RATE 1
+#define COMPACT_NESTEROV_MOMENTUM 2
+#define COMPACT_RESET_WEIGHTS 4
+#define COMPACT_HIGH_NORM 8
+#define COMPACT_LOW_NORM 16
+#define COMPACT_DROPOUT 32
+#define COMPACT_PARAMETER_NAMES 64
+#define COMPACT_BEST_IS_INITIAL 128
+#define COMPACT_OPTIMIZER_STATE 256
+
+void RNN_Genome::write_to_compact_stream(ostream &bin_ostream, bool include_parameter_names) {
+    int32_t marker = COMPACT_GENOME_MARKER;
+    bin_ostream.write((char*)&marker, sizeof(int32_t));
+
+    bool best_is_initial = (best_parameters == initial_parameters);
+
+    int32_t flags = 0;
+    if (adapt_learning_rate) flags |= COMPACT_ADAPT_LEARNING_RATE;
+    if (use_nesterov_momentum) flags |= COMPACT_NESTEROV_MOMENTUM;
+    if (use_reset_weights) flags |= COMPACT_RESET_WEIGHTS;
+    if (use_high_norm) flags |= COMPACT_HIGH_NORM;
+    if (use_low_norm) flags |= COMPACT_LOW_NORM;
+    if (use_dropout) flags |= COMPACT_DROPOUT;
+    if (include_parameter_names) flags |= COMPACT_PARAMETER_NAMES;
+    if (best_is_initial) flags |= COMPACT_BEST_IS_INITIAL;
+    if (has_optimizer_state()) flags |= COMPACT_OPTIMIZER_STATE;
+    write_varint(bin_ostream, flags);
+
+    write_signed_varint(bin_ostream, generation_id);
+    write_signed_varint(bin_ostream, island);
+    write_signed_varint(bin_ostream, bp_iterations);
+
+    bin_ostream.write((char*)&learning_rate, sizeof(double));
+    bin_ostream.write((char*)&high_threshold, sizeof(double));
+    bin_ostream.write((char*)&low_threshold, sizeof(double));
+    bin_ostream.write((char*)&dropout_probability, sizeof(double));
+
+    write_compact_string(bin_ostream, log_filename);
+
+    ostringstream generator_oss;
+    generator_oss << generator;
+    write_compact_string(bin_ostream, generator_oss.str());
+
+    ostringstream rng_0_1_oss;
+    rng_0_1_oss << rng_0_1;
+    write_compact_string(bin_ostream, rng_0_1_oss.str());
+
+    write_varint(bin_ostream, generated_by_map.size());
+    for (auto generated_by = generated_by_map.begin(); generated_by != generated_by_map.end(); generated_by++) {
+        write_compact_string(bin_ostream, generated_by->first);
+        write_signed_varint(bin_ostream, generated_by->second);
+    }
+
+    bin_ostream.write((char*)&best_validation_mse, sizeof(double));
+    bin_ostream.write((char*)&best_validation_mae, sizeof(double));
+
+    write_compact_parameters(bin_ostream, initial_parameters);
+    if (!best_is_initial) write_compact_parameters(bin_ostream, best_parameters);
+
+    if (has_optimizer_state()) {
+        write_compact_parameters(bin_ostream, optimizer_parameters);
+        write_compact_parameters(bin_ostream, optimizer_velocity);
+        write_compact_parameters(bin_ostream, optimizer_gradient);
+        write_compact_parameters(bin_ostream, optimizer_series_state);
+    }
+
+    if (include_parameter_names) {
+        write_varint(bin_ostream, input_parameter_names.size());
+        for (int32_t i = 0; i < (int32_t)input_parameter_names.size(); i++) {
+            write_compact_string(bin_ostream, input_parameter_names[i]);
+        }
+
+        write_varint(bin_ostream, output_parameter_names.size());
+        for (int32_t i = 0; i < (int32_t)output_parameter_names.size(); i++) {
+            write_compact_string(bin_ostream, output_parameter_names[i]);
+        }
+
+        write_compact_bounds(bin_ostream, normalize_mins);
+        write_compact_bounds(bin_ostream, normalize_maxs);
+    }
+
+    //innovation numbers are written as the difference from the previous one,
+    //with the enabled flag in the lowest bit
+    write_varint(bin_ostream, nodes.size());
+    int32_t previous_innovation = 0;
+    for (int32_t i = 0; i < (int32_t)nodes.size(); i++) {
+        write_signed_varint(bin_ostream, ((int64_t)(nodes[i]->innovation_number - previous_innovation) << 1) | nodes[i]->enabled);
+        write_varint(bin_ostream, nodes[i]->layer_type);
+        write_varint(bin_ostream, nodes[i]->node_type);
+        bin_ostream.write((char*)&nodes[i]->depth, sizeof(double));
+        previous_innovation = nodes[i]->innovation_number;
+    }
+
+    write_varint(bin_ostream, edges.size());
+    previous_innovation = 0;
+    for (int32_t i = 0; i < (int32_t)edges.size(); i++) {
+        write_signed_varint(bin_ostream, ((int64_t)(edges[i]->innovation_number - previous_innovation) << 1) | edges[i]->enabled);
+        write_signed_varint(bin_ostream, edges[i]->input_innovation_number);
+        write_signed_varint(bin_ostream, edges[i]->output_innovation_number);
+        previous_innovation = edges[i]->innovation_number;
+    }
+
+    write_varint(bin_ostream, recurrent_edges.size());
+    previous_innovation = 0;
+    for (int32_t i = 0; i < (int32_t)recurrent_edges.size(); i++) {
+        write_signed_varint(bin_ostream, ((int64_t)(recurrent_edges[i]->innovation_number - previous_innovation) << 1) | recurrent_edges[i]->enabled);
+        write_varint(bin_ostream, recurrent_edges[i]->recurrent_depth);
+        write_signed_varint(bin_ostream, recurrent_edges[i]->input_innovation_number);
+        write_signed_varint(bin_ostream, recurrent_edges[i]->output_innovation_number);
+        previous_innovation = recurrent_edges[i]->innovation_number;
+    }
+}
+
+void RNN_Genome::read_from_compact_stream(istream &bin_istream, bool verbose) {
+    if (verbose) cout << "READING COMPACT GENOME FROM STREAM" << endl;
+
+    int32_t flags = read_varint(bin_istream);
+    adapt_learning_rate = flags & COMPACT_ADAPT_LEARNING_RATE;
+    use_nesterov_momentum = flags & COMPACT_NESTEROV_MOMENTUM;
+    use_reset_weights = flags & COMPACT_RESET_WEIGHTS;
+    use_high_norm = flags & COMPACT_HIGH_NORM;
+    use_low_norm = flags & COMPACT_LOW_NORM;
+    use_dropout = flags & COMPACT_DROPOUT;
+
+    generation_id = read_signed_varint(bin_istream);
+    island = read_signed_varint(bin_istream);
+    bp_iterations = read_signed_varint(bin_istream);
+
+    bin_istream.read((char*)&learning_rate, sizeof(double));
+    bin_istream.read((char*)&high_threshold, sizeof(double));
+    bin_istream.read((char*)&low_threshold, sizeof(double));
+    bin_istream.read((char*)&dropout_probability, sizeof(double));
+
+    read_compact_string(bin_istream, log_filename);
+
+    string generator_str;
+    read_compact_string(bin_istream, generator_str);
+    istringstream generator_iss(generator_str);
+    generator_iss >> generator;
+
+    string rng_0_1_str;
+    read_compact_string(bin_istream, rng_0_1_str);
+    istringstream rng_0_1_iss(rng_0_1_str);
+    rng_0_1_iss >> rng_0_1;
+
+    generated_by_map.clear();
+    int32_t n_generated_by = read_varint(bin_istream);
+    for (int32_t i = 0; i < n_generated_by; i++) {
+        string generated_by;
+        read_compact_string(bin_istream, generated_by);
+        generated_by_map[generated_by] = read_signed_varint(bin_istream);
+    }
+
+    bin_istream.read((char*)&best_validation_mse, sizeof(double));
+    bin_istream.read((char*)&best_validation_mae, sizeof(double));
+
+    read_compact_parameters(bin_istream, initial_parameters);
+    if (flags & COMPACT_BEST_IS_INITIAL) {
+        best_parameters = initial_parameters;
+    } else {
+        read_compact_parameters(bin_istream, best_parameters);
+    }
+
+    optimizer_parameters.clear();
+    optimizer_velocity.clear();
+    optimizer_gradient.clear();
+    optimizer_series_state.clear();
+
+    if (flags & COMPACT_OPTIMIZER_STATE) {
+        read_compact_parameters(bin_istream, optimizer_parameters);
+        read_compact_parameters(bin_istream, optimizer_velocity);
+        read_compact_parameters(bin_istream, optimizer_gradient);
+        read_compact_parameters(bin_istream, optimizer_series_state);
+    }
+
+    input_parameter_names.clear();
+    output_parameter_names.clear();
+    normalize_mins.clear();
+    normalize_maxs.clear();
+
+    if (flags & COMPACT_PARAMETER_NAMES) {
+        input_parameter_names.resize(read_varint(bin_istream));
+        for (int32_t i = 0; i < (int32_t)input_parameter_names.size(); i++) {
+            read_compact_string(bin_istream, input_parameter_names[i]);
+        }
+
+        output_parameter_names.resize(read_varint(bin_istream));
+        for (int32_t i = 0; i < (int32_t)output_parameter_names.size(); i++) {
+            read_compact_string(bin_istream, output_parameter_names[i]);
+        }
+
+        read_compact_bounds(bin_istream, normalize_mins);
+        read_compact_bounds(bin_istream, normalize_maxs);
+    }
+
+    nodes.clear();
+    int32_t n_nodes = read_varint(bin_istream);
+    int32_t innovation_number = 0;
+    for (int32_t i = 0; i < n_nodes; i++) {
+        int64_t innovation_and_enabled = read_signed_varint(bin_istream);
+        innovation_number += innovation_and_enabled >> 1;
+        int32_t type = read_varint(bin_istream);
+        int32_t node_type = read_varint(bin_istream);
+        double depth;
+        bin_istream.read((char*)&depth, sizeof(double));
+
+        RNN_Node_Interface *node = read_node(innovation_number, type, node_type, depth);
+        node->enabled = innovation_and_enabled & 1;
+        nodes.push_back(node);
+    }
+
+    edges.clear();
+    int32_t n_edges = read_varint(bin_istream);
+    innovation_number = 0;
+    for (int32_t i = 0; i < n_edges; i++) {
+        int64_t innovation_and_enabled = read_signed_varint(bin_istream);
+        innovation_number += innovation_and_enabled >> 1;
+        int32_t input_innovation_number = read_signed_varint(bin_istream);
+        int32_t output_innovation_number = read_signed_varint(bin_istream);
+
+        RNN_Edge *edge = new RNN_Edge(innovation_number, input_innovation_number, output_innovation_number, nodes);
+        edge->enabled = innovation_and_enabled & 1;
+        edges.push_back(edge);
+    }
+
+    recurrent_edges.clear();
+    int32_t n_recurrent_edges = read_varint(bin_istream);
+    innovation_number = 0;
+    for (int32_t i = 0; i < n_recurrent_edges; i++) {
+        int64_t innovation_and_enabled = read_signed_varint(bin_istream);
+        innovation_number += innovation_and_enabled >> 1;
+        int32_t recurrent_depth = read_varint(bin_istream);
+        int32_t input_innovation_number = read_signed_varint(bin_istream);
+        int32_t output_innovation_number = read_signed_varint(bin_istream);
+
+        RNN_Recurrent_Edge *recurrent_edge = new RNN_Recurrent_Edge(innovation_number, recurrent_depth, input_innovation_number, output_innovation_number, nodes);
+        recurrent_edge->enabled = innovation_and_enabled & 1;
+        recurrent_edges.push_back(recurrent_edge);
+    }
+
+    if (verbose) cout << "read " << n_nodes << " nodes, " << n_edges << " edges and " << n_recurrent_edges << " recurrent edges." << endl;
+
+    assign_reachability();
+}
+
 void RNN_Genome::write_to_array(char **bytes, int32_t &length, bool verbose) {
     ostringstream oss;
     write_to_stream(oss, verbose);
@@ -1,6 +1,9 @@
 #ifndef RNN_BPTT_HXX
 #define RNN_BPTT_HXX
 
+#include <atomic>
+using std::atomic;
+
 #include <fstream>
 using std::istream;
 using std::ifstream;
@@ -8,6 +11,7 @@ using std::ostream;
 using std::ofstream;
 
 #include <map>
+#include <optional>
 using std::map;
 
 #include <random>
@@ -24,10 +28,14 @@ using std::vector;
 #include "rnn_recurrent_edge.hxx"
 
 #include "common/random.hxx"
+#include "common/thread_pool.hxx"
 
 //mysql can't handl the max float value for some reason
 #define EXAMM_MAX_DOUBLE 10000000
 
+//written in place of the generation id to mark a compact genome encoding
+#define COMPACT_GENOME_MARKER 0x43474e45
+
 string parse_fitness(double fitness);
 
 // NOTE: the include of distributions.hxx is at the end of this file since.
@@ -52,8 +60,46 @@ class RNN_Genome {
         bool use_dropout;
         double dropout_probability;
 
+        //truncated backpropagation through time, a window of 0 backpropagates
+        //through the whole series
+        int32_t bptt_window;
+        int32_t bptt_stride;
+
+        //training stops once, after the grace period, extrapolating the best
+        //validation fitness says it can't get under the threshold by the
+        //last iteration. a grace period of 0 always trains for bp_iterations
+        double early_stop_threshold;
+        int32_t early_stop_grace;
+
+        //fraction of the training series backpropagated each iteration
+        double training_series_fraction;
+
+        //where backpropagate_stochastic left off: the last parameters (not the
+        //best), the momentum velocity, the last gradient, and the mu, norm,
+        //mse and learning rate of each series followed by the current ones.
+        //only kept if asked for, and training continues from it (instead of
+        //initial_parameters) when it matches the genome and series
+        bool keep_optimizer_state;
+        vector<double> optimizer_parameters;
+        vector<double> optimizer_velocity;
+        vector<double> optimizer_gradient;
+        vector<double> optimizer_series_state;
+
         string log_filename;
 
+        //the pool used to evaluate the training series in parallel in
+        //backpropagate, NULL uses the process wide shared pool
+        ThreadPool *thread_pool;
+
+        //built the first time the genome is evaluated and reused (only
+        //rebinding weights) until the structure of the genome changes
+        RNN *evaluation_rnn;
+
+        //hash of what equals compares, also recomputed only after the
+        //structure of the genome changes
+        bool structural_hash_valid;
+        uint64_t structural_hash;
+
         map<string, int> generated_by_map;
 
         vector<double> initial_parameters;
@@ -144,6 +190,15 @@ class RNN_Genome {
         void disable_dropout();
         void enable_dropout(double _dropout_probability);
         void set_log_filename(string _log_filename);
+        void set_thread_pool(ThreadPool *_thread_pool);
+        void set_truncated_bptt(int32_t _bptt_window, int32_t _bptt_stride);
+        void set_early_stop(double _early_stop_threshold, int32_t _early_stop_grace);
+        double get_early_stop_threshold() const;
+        void set_training_series_fraction(double _training_series_fraction);
+        double get_training_series_fraction() const;
+        void set_keep_optimizer_state(bool _keep_optimizer_state);
+        bool get_keep_optimizer_state() const;
+        bool has_optimizer_state() const;
 
         void get_weights(vector<double> &parameters);
         void set_weights(const vector<double> &parameters);
@@ -160,21 +215,25 @@ class RNN_Genome {
 
 
         RNN* get_rnn();
+        RNN* get_evaluation_rnn();
         vector<double> get_best_parameters() const;
 
-        void get_analytic_gradient(vector<RNN*> &rnns, const vector<double> &parameters, const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs, double &mse, vector<double> &analytic_gradient, bool training);
+        void get_analytic_gradient(vector<RNN*> &rnns, const vector<double> &parameters, const SeriesViews &inputs, const SeriesViews &outputs, double &mse, vector<double> &analytic_gradient, bool training);
+        void sum_gradients(ThreadPool *pool, const vector< vector<double> > &series_gradients, int32_t n_parameters, vector<double> &analytic_gradient);
+        void get_series_gradient(RNN *rnn, const vector<double> &parameters, const SeriesViews &inputs, const SeriesViews &outputs, int32_t series, double &mse, vector<double> &analytic_gradient);
+        double extrapolate_fitness(const vector<double> &fitness_history, int32_t total_iterations) const;
 
-        void backpropagate(const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs, const vector< vector< vector<double> > > &validation_inputs, const vector< vector< vector<double> > > &validation_outputs);
+        void backpropagate(const SeriesViews &inputs, const SeriesViews &outputs, const SeriesViews &validation_inputs, const SeriesViews &validation_outputs);
 
-        void backpropagate_stochastic(const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs, const vector< vector< vector<double> > > &validation_inputs, const vector< vector< vector<double> > > &validation_outputs);
+        void backpropagate_stochastic(const SeriesViews &inputs, const SeriesViews &outputs, const SeriesViews &validation_inputs, const SeriesViews &validation_outputs);
 
 
-        double get_mse(const vector<double> &parameters, const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs, bool verbose = false);
-        double get_mae(const vector<double> &parameters, const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs, bool verbose = false);
+        double get_mse(const vector<double> &parameters, const SeriesViews &inputs, const SeriesViews &outputs, bool verbose = false);
+        double get_mae(const vector<double> &parameters, const SeriesViews &inputs, const SeriesViews &outputs, bool verbose = false);
 
 
-        vector< vector<double> > get_predictions(const vector<double> &parameters, const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs);
-        void write_predictions(const vector<string> &input_filenames, const vector<double> &parameters, const vector< vector< vector<double> > > &inputs, const vector< vector< vector<double> > > &outputs);
+        vector< vector<double> > get_predictions(const vector<double> &parameters, const SeriesViews &inputs, const SeriesViews &outputs);
+        void write_predictions(const vector<string> &input_filenames, const vector<double> &parameters, const SeriesViews &inputs, const SeriesViews &outputs);
 
         void get_mu_sigma(const vector<double> &p, double &mu, double &sigma);
 
@@ -182,36 +241,38 @@ class RNN_Genome {
         void assign_reachability();
         bool outputs_unreachable();
 
-        RNN_Node_Interface* create_node(double mu, double sigma, int node_type, int32_t &node_innovation_count, double depth);
+        RNN_Node_Interface* create_node(double mu, double sigma, int node_type, atomic<int32_t> &node_innovation_count, double depth);
 
-        bool attempt_edge_insert(RNN_Node_Interface *n1, RNN_Node_Interface *n2, double mu, double sigma, int32_t &edge_innovation_count);
-        bool attempt_recurrent_edge_insert(RNN_Node_Interface *n1, RNN_Node_Interface *n2, double mu, double sigma, int32_t max_recurrent_depth, int32_t &edge_innovation_count);
+        bool attempt_edge_insert(RNN_Node_Interface *n1, RNN_Node_Interface *n2, double mu, double sigma, atomic<int32_t> &edge_innovation_count);
+        bool attempt_recurrent_edge_insert(RNN_Node_Interface *n1, RNN_Node_Interface *n2, double mu, double sigma, int32_t max_recurrent_depth, atomic<int32_t> &edge_innovation_count);
 
         //after adding an Elman or Jordan node, generate the circular RNN edge for Elman and the
         //edges from output to this node for Jordan.
-        void generate_recurrent_edges(RNN_Node_Interface *node, double mu, double sigma, int32_t max_recurrent_depth, int32_t &edge_innovation_count);
+        void generate_recurrent_edges(RNN_Node_Interface *node, double mu, double sigma, int32_t max_recurrent_depth, atomic<int32_t> &edge_innovation_count);
 
-        bool add_edge(double mu, double sigma, int32_t &edge_innovation_count);
-        bool add_recurrent_edge(double mu, double sigma, Distribution *d, int32_t &edge_innovation_count);
+        bool add_edge(double mu, double sigma, atomic<int32_t> &edge_innovation_count);
+        bool add_recurrent_edge(double mu, double sigma, Distribution *d, atomic<int32_t> &edge_innovation_count);
         bool disable_edge();
         bool enable_edge();
-        bool split_edge(double mu, double sigma, int node_type, int32_t max_recurrent_depth, int32_t &edge_innovation_count, int32_t &node_innovation_count);
+        bool split_edge(double mu, double sigma, int node_type, int32_t max_recurrent_depth, atomic<int32_t> &edge_innovation_count, atomic<int32_t> &node_innovation_count);
 
 
-        bool add_node(double mu, double sigma, int node_type, int32_t max_recurrent_depth, int32_t &edge_innovation_count, int32_t &node_innovation_count);
+        bool add_node(double mu, double sigma, int node_type, int32_t max_recurrent_depth, atomic<int32_t> &edge_innovation_count, atomic<int32_t> &node_innovation_count);
 
         bool enable_node();
         bool disable_node();
-        bool split_node(double mu, double sigma, int node_type, int32_t max_recurrent_depth, int32_t &edge_innovation_count, int32_t &node_innovation_count);
+        bool split_node(double mu, double sigma, int node_type, int32_t max_recurrent_depth, atomic<int32_t> &edge_innovation_count, atomic<int32_t> &node_innovation_count);
 
-        bool merge_node(double mu, double sigma, int node_type, int32_t max_recurrent_depth, int32_t &edge_innovation_count, int32_t &node_innovation_count);
+        bool merge_node(double mu, double sigma, int node_type, int32_t max_recurrent_depth, atomic<int32_t> &edge_innovation_count, atomic<int32_t> &node_innovation_count);
 
 
 
         bool equals(RNN_Genome *other);
+        uint64_t get_structural_hash();
 
         string get_color(double weight, bool is_recurrent);
         void write_graphviz(string filename);
+        void write_graphviz(ostream &outfile);
 
         RNN_Genome(string binary_filename, bool verbose = false);
         RNN_Genome(char* array, int32_t length, bool verbose = false);
@@ -224,6 +285,14 @@ class RNN_Genome {
         void write_to_file(string bin_filename, bool verbose = false);
         void write_to_stream(ostream &bin_stream, bool verbose = false);
 
+        //a smaller encoding for sending genomes between processes: varints,
+        //innovation numbers as differences and the best parameters only when
+        //they differ from the initial ones. read_from_stream reads either
+        //encoding. without the parameter names, the receiver has to set them
+        //(and the normalization bounds) itself.
+        void write_to_compact_stream(ostream &bin_stream, bool include_parameter_names);
+        void read_from_compact_stream(istream &bin_istream, bool verbose = false);
+
 
         friend class EXAMM;
         friend class RecDepthFrequencyTable;
@@ -235,4 +304,10 @@ struct sort_genomes_by_fitness {
     }
 };
 
+void read_map(istream &in, map<string, int> &m);
+void write_map(ostream &out, map<string, int> &m);
+
+void write_binary_string(ostream &out, string s, string name, bool verbose);
+void read_binary_string(istream &in, string &s, string name, bool verbose);
+
 #endif
@@ -28,87 +28,49 @@ void RNN_Node::initialize_randomly(minstd_rand0 &generator, NormalDistribution &
     bias = bound(normal_distribution.random(generator, mu, sigma));
 }
 
-void RNN_Node::input_fired(int time, double incoming_output) {
-    inputs_fired[time]++;
-
-    input_values[time] += incoming_output;
-
-    if (inputs_fired[time] < total_inputs) return;
-    else if (inputs_fired[time] > total_inputs) {
-        cerr << "ERROR: inputs_fired on RNN_Node " << innovation_number << " at time " << time << " is " << inputs_fired[time] << " and total_inputs is " << total_inputs << endl;
-        exit(1);
-    }
-
-    //cout << "node " << innovation_number << " - input value[" << time << "]: " << input_values[time] << endl;
-
-
-    output_values[time] = tanh(input_values[time] + bias);
-    ld_output[time] = tanh_derivative(output_values[time]);
-
-    //output_values[time] = sigmoid(input_values[time] + bias);
-    //ld_output[time] = sigmoid_derivative(output_values[time]);
-
-#ifdef NAN_CHECKS
-    if (isnan(output_values[time]) || isinf(output_values[time])) {
-        cerr << "ERROR: output_value[" << time << "] became " << output_values[time] << " on RNN node: " << innovation_number << endl;
-        cerr << "\tinput_value[" << time << "]: " << input_values[time] << endl;
-        cerr << "\tnode bias: " << bias << endl;
-        exit(1);
+void RNN_Node::forward_pass(int32_t time) {
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        int32_t current = (time * batch_size) + lane;
+
+        //cout << "node " << innovation_number << " - input value[" << time << "]: " << input_values[time] << endl;
+
+        output_values[current] = tanh(input_values[current] + bias);
+        ld_output[current] = tanh_derivative(output_values[current]);
+
+        //output_values[time] = sigmoid(input_values[time] + bias);
+        //ld_output[time] = sigmoid_derivative(output_values[time]);
+
+    #ifdef NAN_CHECKS
+        if (isnan(output_values[current]) || isinf(output_values[current])) {
+            cerr << "ERROR: output_value[" << time << "] became " << output_values[current] << " on RNN node: " << innovation_number << endl;
+            cerr << "\tinput_value[" << time << "]: " << input_values[current] << endl;
+            cerr << "\tnode bias: " << bias << endl;
+            exit(1);
+        }
+    #endif
     }
-#endif
 }
 
-void RNN_Node::try_update_deltas(int time) {
-    if (outputs_fired[time] < total_outputs) return;
-    else if (outputs_fired[time] > total_outputs) {
-        cerr << "ERROR: outputs_fired on RNN_Node " << innovation_number << " at time " << time << " is " << outputs_fired[time] << " and total_outputs is " << total_outputs << endl;
-        exit(1);
-    }
-
-    d_input[time] *= ld_output[time];
-
-    d_bias += d_input[time];
-}
+void RNN_Node::backward_pass(int32_t time, const double *deltas) {
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        int32_t current = (time * batch_size) + lane;
 
-void RNN_Node::error_fired(int time, double error) {
-    outputs_fired[time]++;
+        d_input[current] = deltas[lane] * ld_output[current];
 
-    /*
-    cout << "error fired at time: " << time << " on node " << innovation_number
-        << ", d_input: " << d_input[time]
-        << ", ld_output: " << ld_output[time]
-        << ", error_values: " << error_values[time]
-        << ", output_values: " << output_values[time]
-        << endl;
-    */
-
-
-    d_input[time] += error_values[time] * error;
-
-    try_update_deltas(time);
-}
-
-void RNN_Node::output_fired(int time, double delta) {
-    outputs_fired[time]++;
-
-    d_input[time] += delta;
-
-    try_update_deltas(time);
+        d_bias += d_input[current];
+    }
 }
 
 void RNN_Node::reset(int _series_length) {
     series_length = _series_length;
 
-    ld_output.assign(series_length, 0.0);
-    d_input.assign(series_length, 0.0);
-    input_values.assign(series_length, 0.0);
-    output_values.assign(series_length, 0.0);
-    error_values.assign(series_length, 0.0);
+    d_bias = 0.0;
+}
 
-    inputs_fired.assign(series_length, 0);
-    outputs_fired.assign(series_length, 0);
+void RNN_Node::get_series_arrays(vector<double**> &arrays) {
+    RNN_Node_Interface::get_series_arrays(arrays);
 
-    d_bias = 0.0;
+    arrays.push_back(&ld_output);
 }
 
 void RNN_Node::get_gradients(vector<double> &gradients) {
@@ -148,18 +110,11 @@ RNN_Node_Interface* RNN_Node::copy() const {
     //copy RNN_Node values
     n->bias = bias;
     n->d_bias = d_bias;
-    n->ld_output = ld_output;
 
     //copy RNN_Node_Interface values
     n->series_length = series_length;
-    n->input_values = input_values;
-    n->output_values = output_values;
-    n->error_values = error_values;
-    n->d_input = d_input;
 
-    n->inputs_fired = inputs_fired;
     n->total_inputs = total_inputs;
-    n->outputs_fired = outputs_fired;
     n->total_outputs = total_outputs;
     n->enabled = enabled;
     n->forward_reachable = forward_reachable;
@@ -11,7 +11,7 @@ class RNN_Node : public RNN_Node_Interface {
         double bias;
         double d_bias;
 
-        vector<double> ld_output;
+        double *ld_output;
 
     public:
 
@@ -20,11 +20,8 @@ class RNN_Node : public RNN_Node_Interface {
 
         void initialize_randomly(minstd_rand0 &generator, NormalDistribution &normal_distribution, double mu, double sigma);
 
-        void input_fired(int time, double incoming_output);
-
-        void try_update_deltas(int time);
-        void output_fired(int time, double delta);
-        void error_fired(int time, double error);
+        void forward_pass(int32_t time);
+        void backward_pass(int32_t time, const double *deltas);
 
         uint32_t get_number_weights() const ;
         void get_weights(vector<double> &parameters) const;
@@ -33,6 +30,7 @@ class RNN_Node : public RNN_Node_Interface {
         void set_weights(uint32_t &offset, const vector<double> &parameters);
 
         void reset(int _series_length);
+        void get_series_arrays(vector<double**> &arrays);
 
         void get_gradients(vector<double> &gradients);
 
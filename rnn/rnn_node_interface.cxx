@@ -35,6 +35,14 @@ double tanh_derivative(double input) {
 RNN_Node_Interface::RNN_Node_Interface(int32_t _innovation_number, int32_t _layer_type, double _depth) : innovation_number(_innovation_number), layer_type(_layer_type), depth(_depth) {
     total_inputs = 0;
 
+    series_length = 0;
+    batch_size = 1;
+
+    input_values = NULL;
+    output_values = NULL;
+    error_values = NULL;
+    d_input = NULL;
+
     enabled = true;
     forward_reachable = false;
     backward_reachable = false;
@@ -51,6 +59,16 @@ RNN_Node_Interface::RNN_Node_Interface(int32_t _innovation_number, int32_t _laye
 RNN_Node_Interface::~RNN_Node_Interface() {
 }
 
+void RNN_Node_Interface::get_series_arrays(vector<double**> &arrays) {
+    arrays.push_back(&input_values);
+    arrays.push_back(&output_values);
+    arrays.push_back(&error_values);
+    arrays.push_back(&d_input);
+}
+
+void RNN_Node_Interface::project_inputs(int32_t start_time, int32_t end_time) {
+}
+
 int32_t RNN_Node_Interface::get_layer_type() const {
     return layer_type;
 }
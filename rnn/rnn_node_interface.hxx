@@ -19,6 +19,7 @@ using std::vector;
 #include "common/random.hxx"
 
 class RNN;
+class SeriesView;
 
 #define INPUT_LAYER 0
 #define HIDDEN_LAYER 1
@@ -56,14 +57,15 @@ class RNN_Node_Interface {
         bool forward_reachable;
 
         int32_t series_length;
+        int32_t batch_size;
 
-        vector<double> input_values;
-        vector<double> output_values;
-        vector<double> error_values;
-        vector<double> d_input;
+        //per time step values, these point into the arena of the RNN the
+        //node belongs to (see RNN::allocate_arena)
+        double *input_values;
+        double *output_values;
+        double *error_values;
+        double *d_input;
 
-        vector<int32_t> inputs_fired;
-        vector<int32_t> outputs_fired;
         int32_t total_inputs;
         int32_t total_outputs;
     public:
@@ -72,9 +74,25 @@ class RNN_Node_Interface {
 
         virtual void initialize_randomly(minstd_rand0 &generator, NormalDistribution &normal_distribution, double mu, double sigma) = 0;
 
-        virtual void input_fired(int32_t time, double incoming_output) = 0;
-        virtual void output_fired(int32_t time, double delta) = 0;
-        virtual void error_fired(int32_t time, double error) = 0;
+        //the RNN's execution plan accumulates input_values[time] before calling
+        //forward_pass, and passes the summed deltas for the node's output at
+        //that time step into backward_pass, so nodes do no readiness counting.
+        //both process every series in the batch, the value of a series at a
+        //time step is at [(time * batch_size) + lane] and deltas has one
+        //entry per lane. the arrays have room for the time steps before 0,
+        //which hold the state carried over from the previous window when
+        //using truncated backpropagation through time and 0 otherwise, so
+        //the previous time step can always be read
+        virtual void forward_pass(int32_t time) = 0;
+        virtual void backward_pass(int32_t time, const double *deltas) = 0;
+
+        //calculates the parts of the cell math that only depend on
+        //input_values (the input weight and bias terms of the gates) for
+        //time steps [start_time, end_time), before forward_pass is called for
+        //them. when every input of the node is known ahead of time the RNN
+        //does this for the whole series at once, leaving only the recurrence
+        //to forward_pass
+        virtual void project_inputs(int32_t start_time, int32_t end_time);
 
         virtual uint32_t get_number_weights() const = 0;
 
@@ -84,6 +102,10 @@ class RNN_Node_Interface {
         virtual void set_weights(uint32_t &offset, const vector<double> &parameters) = 0;
         virtual void reset(int32_t _series_length) = 0;
 
+        //adds the address of every per time step array of the node, each is
+        //pointed at a slice of the arena holding the longest series seen
+        virtual void get_series_arrays(vector<double**> &arrays);
+
         virtual void get_gradients(vector<double> &gradients) = 0;
 
         virtual RNN_Node_Interface* copy() const = 0;
@@ -102,8 +124,8 @@ class RNN_Node_Interface {
         friend class RNN;
         friend class RNN_Genome;
 
-        friend void get_mse(RNN* genome, const vector< vector<double> > &expected, double &mse, vector< vector<double> > &deltas);
-        friend void get_mae(RNN* genome, const vector< vector<double> > &expected, double &mae, vector< vector<double> > &deltas);
+        friend void get_mse(RNN* genome, const SeriesView &expected, double &mse, vector< vector<double> > &deltas);
+        friend void get_mae(RNN* genome, const SeriesView &expected, double &mae, vector< vector<double> > &deltas);
 };
 
 
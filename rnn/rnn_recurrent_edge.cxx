@@ -90,9 +90,6 @@ RNN_Recurrent_Edge* RNN_Recurrent_Edge::copy(const vector<RNN_Node_Interface*> n
     e->weight = weight;
     e->d_weight = d_weight;
 
-    e->outputs = outputs;
-    e->deltas = deltas;
-
     e->enabled = enabled;
     e->forward_reachable = forward_reachable;
     e->backward_reachable = backward_reachable;
@@ -122,86 +119,6 @@ const RNN_Node_Interface* RNN_Recurrent_Edge::get_output_node() const {
     return output_node;
 }
 
-
-
-//do a propagate to the network at time 0 so that the
-//input fireds are correct
-void RNN_Recurrent_Edge::first_propagate_forward() {
-    for (uint32_t i = 0; i < recurrent_depth; i++) {
-        output_node->input_fired(i, 0.0);
-    }
-}
-
-void RNN_Recurrent_Edge::propagate_forward(int32_t time) {
-    if (input_node->inputs_fired[time] != input_node->total_inputs) {
-        cerr << "ERROR! propagate forward called on recurrent edge " << innovation_number << " where input_node->inputs_fired[" << time << "] (" << input_node->inputs_fired[time] << ") != total_inputs (" << input_node->total_inputs << ")" << endl;
-        exit(1);
-    }
-
-
-    double output = input_node->output_values[time] * weight;
-    if (time < series_length - recurrent_depth) {
-        //cout << "propagating forward on recurrent edge " << innovation_number << " from time " << time << " to time " << time + recurrent_depth << " from node " << input_innovation_number << " to node " << output_innovation_number << endl;
-
-        //cout << "propagating recurrent at time " << time << " from " << input_node->innovation_number << " to " << output_node->innovation_number << ", value: " << output << ", input: " << input_node->output_values[time] << ", weight: " << weight << endl;
-        outputs[time + recurrent_depth] = output;
-        output_node->input_fired(time + recurrent_depth, output);
-    }
-}
-
-//do a propagate to the network at time (series_length - 1) so that the
-//output fireds are correct
-void RNN_Recurrent_Edge::first_propagate_backward() {
-    for (uint32_t i = 0; i < recurrent_depth; i++) {
-        //cout << "FIRST propagating backward on recurrent edge " << innovation_number << " to time " << series_length - 1 - i << " from node " << output_innovation_number << " to node " << input_innovation_number << endl;
-        input_node->output_fired(series_length - 1 - i, 0.0);
-    }
-}
-
-void RNN_Recurrent_Edge::propagate_backward(int32_t time) {
-    if (output_node->outputs_fired[time] != output_node->total_outputs) {
-        //if (output_node->innovation_number == input_node->innovation_number) {
-            //circular recurrent edge
-            /*
-            if (output_node->outputs_fired[time] != (output_node->total_outputs - 1)) {
-                cerr << "ERROR! propagate backward called on recurrent edge " << innovation_number << " where output_node->outputs_fired[" << time << "] (" << output_node->outputs_fired[time] << ") != total_outputs (" << output_node->total_outputs << ")" << endl;
-                cerr << "input innovation number: " << input_node->innovation_number << ", output innovation number: " << output_node->innovation_number << endl;
-                exit(1);
-            }
-            */
-        //} else {
-            cerr << "ERROR! propagate backward called on recurrent edge " << innovation_number << " where output_node->outputs_fired[" << time << "] (" << output_node->outputs_fired[time] << ") != total_outputs (" << output_node->total_outputs << ")" << endl;
-            cerr << "input innovation number: " << input_node->innovation_number << ", output innovation number: " << output_node->innovation_number << endl;
-            exit(1);
-        //}
-    }
-
-    /*
-    cout << "edge " << innovation_number << " propagating backwards, input_node->series_length: " << input_node->series_length << endl;
-    cout << "input_innovation_number: " << input_innovation_number << endl;
-    cout << "output_innovation_number: " << output_innovation_number << endl;
-    cout << "input_node->output_values.size(): " << input_node->output_values.size() << endl;
-    cout << "output_node->d_input.size(): " << output_node->d_input.size() << endl;
-    */
-
-    double delta = output_node->d_input[time];
-
-    if (time - recurrent_depth >= 0) {
-        //cout << "propagating backward on recurrent edge " << innovation_number << " from time " << time << " to time " << time - recurrent_depth << " from node " << output_innovation_number << " to node " << input_innovation_number << endl;
-
-        d_weight += delta * input_node->output_values[time - recurrent_depth];
-        deltas[time] = delta * weight;
-        input_node->output_fired(time - recurrent_depth, deltas[time]);
-    }
-}
-
-void RNN_Recurrent_Edge::reset(int32_t _series_length) {
-    series_length = _series_length;
-    d_weight = 0.0;
-    outputs.resize(series_length);
-    deltas.resize(series_length);
-}
-
 int32_t RNN_Recurrent_Edge::get_recurrent_depth() const {
     return recurrent_depth;
 }
@@ -8,14 +8,10 @@ class RNN;
 class RNN_Recurrent_Edge {
     private:
         int32_t innovation_number;
-        int32_t series_length;
 
         //how far in the past to get the value
         int32_t recurrent_depth;
 
-        vector<double> outputs;
-        vector<double> deltas;
-
         double weight;
         double d_weight;
 
@@ -34,13 +30,6 @@ class RNN_Recurrent_Edge {
 
         RNN_Recurrent_Edge(int32_t _innovation_number, int32_t _recurrent_depth, int32_t _input_innovation_number, int32_t _output_innovation_number, const vector<RNN_Node_Interface*> &nodes);
 
-        void reset(int32_t _series_length);
-
-        void first_propagate_forward();
-        void first_propagate_backward();
-        void propagate_forward(int32_t time);
-        void propagate_backward(int32_t time);
-
         int32_t get_recurrent_depth() const;
         double get_gradient();
         bool is_reachable() const;
@@ -51,15 +51,15 @@ void UGRNN_Node::initialize_randomly(minstd_rand0 &generator, NormalDistribution
 double UGRNN_Node::get_gradient(string gradient_name) {
     double gradient_sum = 0.0;
 
-    for (uint32_t i = 0; i < series_length; i++ ) {
+    for (int32_t i = 0; i < series_length * batch_size; i++) {
         if (gradient_name == "cw") {
-            gradient_sum += d_cw[i];
+            gradient_sum += d_c_bias[i] * input_values[i];
         } else if (gradient_name == "ch") {
             gradient_sum += d_ch[i];
         } else if (gradient_name == "c_bias") {
             gradient_sum += d_c_bias[i];
         } else if (gradient_name == "gw") {
-            gradient_sum += d_gw[i];
+            gradient_sum += d_g_bias[i] * input_values[i];
         } else if (gradient_name == "gh") {
             gradient_sum += d_gh[i];
         } else if (gradient_name == "g_bias") {
@@ -77,125 +77,106 @@ void UGRNN_Node::print_gradient(string gradient_name) {
     cout << "\tgradient['" << gradient_name << "']: " << get_gradient(gradient_name) << endl;
 }
 
-void UGRNN_Node::input_fired(int time, double incoming_output) {
-    inputs_fired[time]++;
+void UGRNN_Node::project_inputs(int32_t start_time, int32_t end_time) {
+    double c_weight = cw;
+    double g_weight = gw;
 
-    input_values[time] += incoming_output;
+    double c_bias_value = c_bias;
+    double g_bias_value = g_bias;
 
-    if (inputs_fired[time] < total_inputs) return;
-    else if (inputs_fired[time] > total_inputs) {
-        cerr << "ERROR: inputs_fired on UGRNN_Node " << innovation_number << " at time " << time << " is " << inputs_fired[time] << " and total_inputs is " << total_inputs << endl;
-        exit(1);
+    //c and g start out as the input part of their sums
+    for (int32_t i = start_time * batch_size; i < end_time * batch_size; i++) {
+        double x = input_values[i];
+
+        c[i] = x * c_weight + c_bias_value;
+        g[i] = x * g_weight + g_bias_value;
     }
+}
 
-    //update the reset gate bias so its centered around 1
-    //g_bias += 1;
+void UGRNN_Node::forward_pass(int32_t time) {
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        int32_t current = (time * batch_size) + lane;
 
-    //cout << "PROPAGATING FORWARD" << endl;
+        //update the reset gate bias so its centered around 1
+        //g_bias += 1;
 
-    double x = input_values[time];
-    //cout << "node " << innovation_number << " - input value[" << time << "] (x): " << x << endl;
+        //cout << "PROPAGATING FORWARD" << endl;
 
-    double h_prev = 0.0;
-    if (time > 0) h_prev = output_values[time - 1];
-    //cout << "node " << innovation_number << " - prev_output_value[" << time << "] (h_prev): " << h_prev << endl;
+        double h_prev = output_values[current - batch_size];
+        //cout << "node " << innovation_number << " - prev_output_value[" << time << "] (h_prev): " << h_prev << endl;
 
-    //cout << "g_bias: " << g_bias << endl;
+        //cout << "g_bias: " << g_bias << endl;
 
-    double xcw = x * cw;
-    double hch = h_prev * ch;
-    double c_sum = xcw + hch + c_bias;
-    c[time] = tanh(c_sum);
-    ld_c[time] = tanh_derivative(c[time]);
+        double hch = h_prev * ch;
+        double c_sum = c[current] + hch;
+        c[current] = tanh(c_sum);
+        ld_c[current] = tanh_derivative(c[current]);
 
-    double xgw = x * gw;
-    double hgh = h_prev * gh;
-    double g_sum = xgw + hgh + g_bias;
+        double hgh = h_prev * gh;
+        double g_sum = g[current] + hgh;
 
-    g[time] = sigmoid(g_sum);
-    ld_g[time] = sigmoid_derivative(g[time]);
+        g[current] = sigmoid(g_sum);
+        ld_g[current] = sigmoid_derivative(g[current]);
 
-    output_values[time] = (g[time] * h_prev) + ((1 - g[time]) * c[time]);
+        output_values[current] = (g[current] * h_prev) + ((1 - g[current]) * c[current]);
 
-    //reset alpha, beta1, beta2 so they don't mess with mean/stddev calculations for
-    //parameter generation
-    //g_bias -= 1.0;
+        //reset alpha, beta1, beta2 so they don't mess with mean/stddev calculations for
+        //parameter generation
+        //g_bias -= 1.0;
 
-    //cout << "node " << innovation_number << " - output_values[" << time << "]: " << output_values[time] << endl;
-}
-
-void UGRNN_Node::try_update_deltas(int time) {
-    if (outputs_fired[time] < total_outputs) return;
-    else if (outputs_fired[time] > total_outputs) {
-        cerr << "ERROR: outputs_fired on UGRNN_Node " << innovation_number << " at time " << time << " is " << outputs_fired[time] << " and total_outputs is " << total_outputs << endl;
-        exit(1);
+        //cout << "node " << innovation_number << " - output_values[" << time << "]: " << output_values[time] << endl;
     }
+}
 
-    //cout << "PROPAGATING BACKWARDS" << endl;
-    //update the reset gate bias so its centered around 1   
-    //g_bias += 1.0;
-
-    double error = error_values[time];
-    //cout << "error_values[time]: " << error << endl;
-    double x = input_values[time];
-    //cout << "input value[" << time << "]:" << x << endl;
-
-    double h_prev = 0.0;
-    if (time > 0) h_prev = output_values[time - 1];
-    //cout << "h_prev[" << (time - 1) << "]: " << h_prev << endl;
-
-
-    //backprop output gate
-    double d_h = error;
-    if (time < (series_length - 1)) d_h += d_h_prev[time + 1];
-    //get the error into the output (z), it's the error from ahead in the network
-    //as well as from the previous output of the cell
-
-    //cout << "d_z: " << d_z << endl;
-    //cout << "ld_z_cap[" << time << "]: " << ld_z_cap[time] << endl;
+void UGRNN_Node::backward_pass(int32_t time, const double *deltas) {
+    for (int32_t lane = 0; lane < batch_size; lane++) {
+        int32_t current = (time * batch_size) + lane;
 
-    d_h_prev[time] = d_h * g[time];
+        //cout << "PROPAGATING BACKWARDS" << endl;
+        //update the reset gate bias so its centered around 1   
+        //g_bias += 1.0;
 
-    double d_g = ((d_h * h_prev) - (d_h * c[time])) * ld_g[time];
-    d_g_bias[time] = d_g;
-    d_gh[time] = d_g * h_prev;
-    d_h_prev[time] += d_g * gh;
-    d_gw[time] = d_g * x;
-    d_input[time] = d_g * gw;
+        double error = deltas[lane];
+        //cout << "error_values[time]: " << error << endl;
 
-    double d_c = (1 - g[time]) * d_h * ld_c[time];
+        double h_prev = output_values[current - batch_size];
+        //cout << "h_prev[" << (time - 1) << "]: " << h_prev << endl;
 
-    d_input[time] += d_c * cw;
-    d_cw[time] = d_c * x;
 
-    d_c_bias[time] = d_c;
+        //backprop output gate
+        double d_h = error;
+        if (time < (series_length - 1)) d_h += d_h_prev[current + batch_size];
+        //get the error into the output (z), it's the error from ahead in the network
+        //as well as from the previous output of the cell
 
-    d_ch[time] = d_c * h_prev;
-    d_h_prev[time] += d_c * ch;
+        //cout << "d_z: " << d_z << endl;
+        //cout << "ld_z_cap[" << time << "]: " << ld_z_cap[time] << endl;
 
-    //cout << "d_input: " << d_input[time] << endl;
-    //cout << "d_beta2: " << d_beta2[time] << endl;
+        d_h_prev[current] = d_h * g[current];
 
-    //cout << endl << endl;
+        double d_g = ((d_h * h_prev) - (d_h * c[current])) * ld_g[current];
+        d_g_bias[current] = d_g;
+        d_gh[current] = d_g * h_prev;
+        d_h_prev[current] += d_g * gh;
+        d_input[current] = d_g * gw;
 
-    //reset the reset gate bias to be around 0
-    //g_bias -= 1.0;
-}
+        double d_c = (1 - g[current]) * d_h * ld_c[current];
 
-void UGRNN_Node::error_fired(int time, double error) {
-    outputs_fired[time]++;
+        d_input[current] += d_c * cw;
 
-    error_values[time] *= error;
+        d_c_bias[current] = d_c;
 
-    try_update_deltas(time);
-}
+        d_ch[current] = d_c * h_prev;
+        d_h_prev[current] += d_c * ch;
 
-void UGRNN_Node::output_fired(int time, double delta) {
-    outputs_fired[time]++;
+        //cout << "d_input: " << d_input[time] << endl;
+        //cout << "d_beta2: " << d_beta2[time] << endl;
 
-    error_values[time] += delta;
+        //cout << endl << endl;
 
-    try_update_deltas(time);
+        //reset the reset gate bias to be around 0
+        //g_bias -= 1.0;
+    }
 }
 
 
@@ -266,12 +247,12 @@ void UGRNN_Node::get_gradients(vector<double> &gradients) {
         gradients[i] = 0.0;
     }
 
-    for (uint32_t i = 0; i < series_length; i++) {
-        gradients[0] += d_cw[i];
+    for (int32_t i = 0; i < series_length * batch_size; i++) {
+        gradients[0] += d_c_bias[i] * input_values[i];
         gradients[1] += d_ch[i];
         gradients[2] += d_c_bias[i];
 
-        gradients[3] += d_gw[i];
+        gradients[3] += d_g_bias[i] * input_values[i];
         gradients[4] += d_gh[i];
         gradients[5] += d_g_bias[i];
     }
@@ -279,31 +260,22 @@ void UGRNN_Node::get_gradients(vector<double> &gradients) {
 
 void UGRNN_Node::reset(int _series_length) {
     series_length = _series_length;
+}
 
-    d_cw.assign(series_length, 0.0);
-    d_ch.assign(series_length, 0.0);
-    d_c_bias.assign(series_length, 0.0);
-
-    d_gw.assign(series_length, 0.0);
-    d_gh.assign(series_length, 0.0);
-    d_g_bias.assign(series_length, 0.0);
-
-    d_h_prev.assign(series_length, 0.0);
-
-    c.assign(series_length, 0.0);
-    ld_c.assign(series_length, 0.0);
-    g.assign(series_length, 0.0);
-    ld_g.assign(series_length, 0.0);
+void UGRNN_Node::get_series_arrays(vector<double**> &arrays) {
+    RNN_Node_Interface::get_series_arrays(arrays);
 
-    //reset values from rnn_node_interface
-    d_input.assign(series_length, 0.0);
-    error_values.assign(series_length, 0.0);
+    arrays.push_back(&d_ch);
+    arrays.push_back(&d_c_bias);
+    arrays.push_back(&d_gh);
+    arrays.push_back(&d_g_bias);
 
-    input_values.assign(series_length, 0.0);
-    output_values.assign(series_length, 0.0);
+    arrays.push_back(&d_h_prev);
 
-    inputs_fired.assign(series_length, 0);
-    outputs_fired.assign(series_length, 0);
+    arrays.push_back(&c);
+    arrays.push_back(&ld_c);
+    arrays.push_back(&g);
+    arrays.push_back(&ld_g);
 }
 
 RNN_Node_Interface* UGRNN_Node::copy() const {
@@ -319,30 +291,10 @@ RNN_Node_Interface* UGRNN_Node::copy() const {
     n->gh = gh;
     n->g_bias = g_bias;
 
-    n->d_cw = d_cw;
-    n->d_ch = d_ch;
-    n->d_c_bias = d_c_bias;
-    n->d_gw = d_gw;
-    n->d_gh = d_gh;
-    n->d_g_bias = d_g_bias;
-
-    n->d_h_prev = d_h_prev;
-
-    n->c = c;
-    n->ld_c = ld_c;
-    n->g = g;
-    n->ld_g = ld_g;
-
     //copy RNN_Node_Interface values
     n->series_length = series_length;
-    n->input_values = input_values;
-    n->output_values = output_values;
-    n->error_values = error_values;
-    n->d_input = d_input;
 
-    n->inputs_fired = inputs_fired;
     n->total_inputs = total_inputs;
-    n->outputs_fired = outputs_fired;
     n->total_outputs = total_outputs;
     n->enabled = enabled;
     n->forward_reachable = forward_reachable;
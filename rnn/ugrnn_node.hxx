@@ -25,19 +25,17 @@ class UGRNN_Node : public RNN_Node_Interface {
         double gh;
         double g_bias;
 
-        vector<double> d_cw;
-        vector<double> d_ch;
-        vector<double> d_c_bias;
-        vector<double> d_gw;
-        vector<double> d_gh;
-        vector<double> d_g_bias;
+        double *d_ch;
+        double *d_c_bias;
+        double *d_gh;
+        double *d_g_bias;
 
-        vector<double> d_h_prev;
+        double *d_h_prev;
 
-        vector<double> c;
-        vector<double> ld_c;
-        vector<double> g;
-        vector<double> ld_g;
+        double *c;
+        double *ld_c;
+        double *g;
+        double *ld_g;
 
     public:
 
@@ -49,11 +47,9 @@ class UGRNN_Node : public RNN_Node_Interface {
         double get_gradient(string gradient_name);
         void print_gradient(string gradient_name);
 
-        void input_fired(int time, double incoming_output);
-
-        void try_update_deltas(int time);
-        void error_fired(int time, double error);
-        void output_fired(int time, double delta);
+        void project_inputs(int32_t start_time, int32_t end_time);
+        void forward_pass(int32_t time);
+        void backward_pass(int32_t time, const double *deltas);
 
         uint32_t get_number_weights() const;
 
@@ -66,6 +62,7 @@ class UGRNN_Node : public RNN_Node_Interface {
         void get_gradients(vector<double> &gradients);
 
         void reset(int _series_length);
+        void get_series_arrays(vector<double**> &arrays);
 
         void print_cell_values();
 
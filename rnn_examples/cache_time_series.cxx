@@ -0,0 +1,30 @@
+#include <iostream>
+using std::cerr;
+using std::cout;
+using std::endl;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "common/arguments.hxx"
+
+#include "time_series/time_series.hxx"
+
+//writes the --training_cache for a set of CSV files ahead of time, taking the
+//same time series arguments as the searches which will use it
+int main(int argc, char** argv) {
+    vector<string> arguments = vector<string>(argv, argv + argc);
+
+    string cache_filename;
+    get_argument(arguments, "--training_cache", true, cache_filename);
+
+    TimeSeriesSets *time_series_sets = TimeSeriesSets::generate_from_arguments(arguments, true);
+
+    cout << "time series cache '" << cache_filename << "' is up to date for " << time_series_sets->get_number_series() << " files" << endl;
+
+    delete time_series_sets;
+    return 0;
+}
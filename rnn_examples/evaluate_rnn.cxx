@@ -32,8 +32,8 @@ using std::vector;
 
 vector<string> arguments;
 
-vector< vector< vector<double> > > testing_inputs;
-vector< vector< vector<double> > > testing_outputs;
+SeriesViews testing_inputs;
+SeriesViews testing_outputs;
 
 int main(int argc, char** argv) {
     arguments = vector<string>(argv, argv + argc);
@@ -32,10 +32,10 @@ using std::vector;
 
 #include "time_series/time_series.hxx"
 
-vector< vector< vector<double> > > training_inputs;
-vector< vector< vector<double> > > training_outputs;
-vector< vector< vector<double> > > test_inputs;
-vector< vector< vector<double> > > test_outputs;
+SeriesViews training_inputs;
+SeriesViews training_outputs;
+SeriesViews test_inputs;
+SeriesViews test_outputs;
 
 RNN_Genome *genome;
 RNN* rnn;
@@ -47,7 +47,7 @@ double objective_function(const vector<double> &parameters) {
 
     double error = 0.0;
 
-    for (uint32_t i = 0; i < training_inputs.size(); i++) {
+    for (int32_t i = 0; i < training_inputs.size(); i++) {
         error += rnn->prediction_mae(training_inputs[i], training_outputs[i], false, true, 0.0);
     }
 
@@ -59,7 +59,7 @@ double test_objective_function(const vector<double> &parameters) {
 
     double total_error = 0.0;
 
-    for (uint32_t i = 0; i < test_inputs.size(); i++) {
+    for (int32_t i = 0; i < test_inputs.size(); i++) {
         double error = rnn->prediction_mse(test_inputs[i], test_outputs[i], false, true, 0.0);
         total_error += error;
 
@@ -162,6 +162,13 @@ int main(int argc, char **argv) {
     genome->enable_low_threshold(0.05);
     genome->disable_dropout();
 
+    int32_t bptt_window = 0;
+    if (get_argument(arguments, "--bptt_window", false, bptt_window)) {
+        int32_t bptt_stride = bptt_window;
+        get_argument(arguments, "--bptt_stride", false, bptt_stride);
+        genome->set_truncated_bptt(bptt_window, bptt_stride);
+    }
+
     if (argument_exists(arguments, "--log_filename")) {
         string log_filename;
         get_argument(arguments, "--log_filename", false, log_filename);
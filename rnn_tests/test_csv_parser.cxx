@@ -0,0 +1,210 @@
+#include <cstdio>
+
+#include <fstream>
+using std::getline;
+using std::ifstream;
+using std::ofstream;
+
+#include <iomanip>
+using std::fixed;
+using std::scientific;
+using std::setprecision;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <random>
+using std::minstd_rand0;
+using std::uniform_int_distribution;
+using std::uniform_real_distribution;
+
+#include <sstream>
+using std::ostringstream;
+using std::stringstream;
+
+#include <string>
+using std::string;
+using std::to_string;
+
+#include <vector>
+using std::vector;
+
+#include <unistd.h>
+
+#include "common/arguments.hxx"
+
+#include "time_series/time_series.hxx"
+
+minstd_rand0 generator(1337);
+
+bool failed = false;
+
+//writes a value in one of the ways values turn up in the data files
+string format_value(double value) {
+    ostringstream out;
+
+    switch (uniform_int_distribution<int32_t>(0, 6)(generator)) {
+        case 0: out << setprecision(17) << value; break;
+        case 1: out << scientific << setprecision(10) << value; break;
+        case 2: out << fixed << setprecision(3) << value; break;
+        case 3: out << (int32_t)(value * 100); break;
+        case 4: out << (value >= 0 ? "+" : "") << setprecision(8) << value; break;
+        case 5: out << " " << setprecision(12) << value; break;
+        case 6: out << setprecision(6) << value * 1e-7; break;
+    }
+
+    return out.str();
+}
+
+//a file with a column which isn't loaded, comment and blank lines and
+//trailing commas, as the loader has to handle
+string generate_csv(int32_t number_rows) {
+    uniform_real_distribution<double> rng(-1000.0, 1000.0);
+    uniform_int_distribution<int32_t> rng_line(0, 19);
+
+    ostringstream out;
+    out << "a,b,unused,c" << endl;
+    out << "# a comment before the values" << endl;
+
+    for (int32_t i = 0; i < number_rows; i++) {
+        int32_t line_type = rng_line(generator);
+        if (line_type == 0) out << endl;
+        if (line_type == 1) out << "#" << format_value(rng(generator)) << ",a comment" << endl;
+
+        out << format_value(rng(generator)) << "," << format_value(rng(generator)) << ",text " << i << "," << format_value(rng(generator));
+        if (line_type == 2) out << ",";
+        out << endl;
+    }
+
+    return out.str();
+}
+
+void write_file(string filename, string contents) {
+    ofstream out(filename);
+    out << contents;
+    out.close();
+}
+
+//the values of each field as the getline and stod loader read them before
+//the files were parsed in place
+void reference_parse(string contents, const vector<string> &fields, vector< vector<double> > &values) {
+    stringstream in(contents);
+    string line;
+    getline(in, line);
+
+    vector<string> file_fields;
+    stringstream header(line);
+    string item;
+    while (getline(header, item, ',')) file_fields.push_back(item);
+
+    values.assign(fields.size(), vector<double>());
+    while (getline(in, line)) {
+        if (line.size() == 0 || line[0] == '#') continue;
+
+        vector<string> parts;
+        stringstream row(line);
+        while (getline(row, item, ',')) parts.push_back(item);
+
+        for (int32_t i = 0; i < (int32_t)parts.size(); i++) {
+            for (int32_t j = 0; j < (int32_t)fields.size(); j++) {
+                if (file_fields[i] == fields[j]) values[j].push_back(stod(parts[i]));
+            }
+        }
+    }
+}
+
+void compare_series(string name, const vector<double> &expected, const vector<double> &parsed) {
+    if (expected.size() != parsed.size()) {
+        cout << "\t\tFAILED " << name << ": expected " << expected.size() << " values but parsed " << parsed.size() << endl;
+        failed = true;
+        return;
+    }
+
+    for (int32_t i = 0; i < (int32_t)expected.size(); i++) {
+        //the values have to be exactly the same, not just close
+        if (expected[i] != parsed[i]) {
+            cout << "\t\tFAILED " << name << "[" << i << "]: expected " << setprecision(17) << expected[i] << " but parsed " << parsed[i] << endl;
+            failed = true;
+            return;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    vector<string> arguments = vector<string>(argv, argv + argc);
+
+    string directory = "/tmp";
+    get_argument(arguments, "--test_directory", false, directory);
+
+    int32_t number_files = 6;
+    int32_t number_rows = 2000;
+
+    cout << "TESTING CSV PARSER" << endl;
+
+    vector<string> fields = {"a", "b", "c"};
+    string prefix = directory + "/test_csv_parser_" + to_string(getpid()) + "_";
+
+    vector<string> contents;
+    vector<string> filenames;
+    for (int32_t i = 0; i < number_files; i++) {
+        contents.push_back(generate_csv(number_rows + i * 37));
+        filenames.push_back(prefix + to_string(i) + ".csv");
+        write_file(filenames[i], contents[i]);
+    }
+
+    //the same as the first file, but with windows line endings
+    string crlf_contents;
+    for (int32_t i = 0; i < (int32_t)contents[0].size(); i++) {
+        if (contents[0][i] == '\n') crlf_contents += '\r';
+        crlf_contents += contents[0][i];
+    }
+    string crlf_filename = prefix + "crlf.csv";
+    write_file(crlf_filename, crlf_contents);
+
+    //the files are loaded in parallel
+    vector<string> load_arguments = {"test_csv_parser", "--training_filenames"};
+    load_arguments.insert(load_arguments.end(), filenames.begin(), filenames.end());
+    load_arguments.push_back("--test_filenames");
+    load_arguments.push_back(crlf_filename);
+    load_arguments.push_back("--input_parameter_names");
+    load_arguments.push_back("a");
+    load_arguments.push_back("b");
+    load_arguments.push_back("--output_parameter_names");
+    load_arguments.push_back("c");
+
+    TimeSeriesSets *time_series_sets = TimeSeriesSets::generate_from_arguments(load_arguments, false);
+
+    if (time_series_sets->get_number_series() != number_files + 1) {
+        cout << "\t\tFAILED: loaded " << time_series_sets->get_number_series() << " series from " << number_files + 1 << " files" << endl;
+        failed = true;
+    } else {
+        for (int32_t i = 0; i < (int32_t)fields.size(); i++) {
+            vector< vector<double> > parsed;
+            time_series_sets->export_series_by_name(fields[i], parsed);
+
+            for (int32_t j = 0; j <= number_files; j++) {
+                //the crlf file has the same values as the first
+                int32_t file = (j == number_files) ? 0 : j;
+                cout << "\ttesting field '" << fields[i] << "' of file " << (j == number_files ? crlf_filename : filenames[j]) << " ... " << endl;
+
+                vector< vector<double> > expected;
+                reference_parse(contents[file], fields, expected);
+                compare_series(fields[i], expected[i], parsed[j]);
+            }
+        }
+    }
+
+    delete time_series_sets;
+
+    for (int32_t i = 0; i < number_files; i++) remove(filenames[i].c_str());
+    remove(crlf_filename.c_str());
+
+    if (!failed) {
+        cout << "ALL PASSED!" << endl;
+    } else {
+        cout << "SOME FAILED!" << endl;
+    }
+
+    return failed ? 1 : 0;
+}
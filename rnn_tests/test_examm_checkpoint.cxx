@@ -0,0 +1,206 @@
+#include <cstdio>
+
+#include <fstream>
+using std::ifstream;
+using std::ios;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <map>
+using std::map;
+
+#include <sstream>
+using std::ostringstream;
+
+#include <string>
+using std::string;
+using std::to_string;
+
+#include <vector>
+using std::vector;
+
+#include <unistd.h>
+
+#include "common/arguments.hxx"
+#include "common/file_writer.hxx"
+
+#include "rnn/examm.hxx"
+#include "rnn/rnn_genome.hxx"
+
+#include "time_series/series_view.hxx"
+
+#include "gradient_test.hxx"
+
+bool failed = false;
+
+int32_t population_size = 5;
+int32_t number_islands = 2;
+int32_t max_genomes = 100;
+
+vector<string> input_names = {"in_a", "in_b"};
+vector<string> output_names = {"out_a"};
+map<string,double> mins = {{"in_a", 0.0}, {"in_b", 0.0}, {"out_a", 0.0}};
+map<string,double> maxs = {{"in_a", 1.0}, {"in_b", 1.0}, {"out_a", 1.0}};
+
+EXAMM* create_examm() {
+    return new EXAMM(population_size, number_islands, max_genomes, 0, "clear_worst_n",
+            input_names, output_names, mins, maxs,
+            2, 0.001,
+            true, 1.0,
+            true, 0.05,
+            false, 0.0,
+            1, 5,
+            0.1, 0.3,
+            "global", "uniform", "");
+}
+
+string read_file(string filename) {
+    ifstream in(filename, ios::in | ios::binary);
+    ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+//the checkpoint of a search, with the time since it started left out as that
+//is the only thing which differs when it is written again
+string read_checkpoint_bytes(string filename) {
+    string bytes = read_file(filename);
+    if (bytes.size() < 24) return bytes;
+
+    return bytes.substr(0, bytes.size() - 24) + bytes.substr(bytes.size() - 16);
+}
+
+void write_checkpoint(EXAMM *examm, string filename) {
+    examm->write_checkpoint(filename);
+    FileWriter::get_shared()->flush();
+}
+
+//generates, trains and inserts genomes the way the examm_mt workers do,
+//returning false once the search is done
+bool run_genomes(EXAMM *examm, int32_t number_genomes, const SeriesViews &inputs, const SeriesViews &outputs) {
+    for (int32_t i = 0; i < number_genomes; i++) {
+        RNN_Genome *genome = examm->generate_genome();
+        if (genome == NULL) return false;
+
+        double prev_fitness = genome->get_fitness();
+        genome->backpropagate_stochastic(inputs, outputs, inputs, outputs);
+
+        examm->deposit_rec_depth_pheromone(genome, prev_fitness);
+        examm->insert_genome(genome);
+
+        delete genome;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    vector<string> arguments = vector<string>(argv, argv + argc);
+
+    string directory = "/tmp";
+    get_argument(arguments, "--test_directory", false, directory);
+
+    initialize_generator();
+
+    cout << "TESTING EXAMM CHECKPOINTS" << endl;
+
+    string prefix = directory + "/test_examm_checkpoint_" + to_string(getpid()) + "_";
+    string checkpoint_filename = prefix + "original";
+    string resumed_filename = prefix + "resumed";
+
+    int32_t series_length = 20;
+    vector< vector< vector<double> > > input_series(2), output_series(2);
+    for (int32_t i = 0; i < 2; i++) {
+        input_series[i].resize(input_names.size());
+        output_series[i].resize(output_names.size());
+        for (int32_t j = 0; j < (int32_t)input_names.size(); j++) generate_random_vector(series_length, input_series[i][j]);
+        for (int32_t j = 0; j < (int32_t)output_names.size(); j++) generate_random_vector(series_length, output_series[i][j]);
+    }
+    SeriesViews inputs(input_series), outputs(output_series);
+
+    EXAMM *original = create_examm();
+    run_genomes(original, 20, inputs, outputs);
+
+    cout << "\ttesting a checkpoint is written ... " << endl;
+    write_checkpoint(original, checkpoint_filename);
+    string original_bytes = read_checkpoint_bytes(checkpoint_filename);
+    if (original_bytes.size() == 0) {
+        cout << "\t\tFAILED: the checkpoint '" << checkpoint_filename << "' was not written" << endl;
+        failed = true;
+    }
+
+    cout << "\ttesting the resumed search writes the same checkpoint ... " << endl;
+    EXAMM *resumed = create_examm();
+    resumed->read_checkpoint(checkpoint_filename);
+    write_checkpoint(resumed, resumed_filename);
+
+    if (read_checkpoint_bytes(resumed_filename) != original_bytes) {
+        cout << "\t\tFAILED: the checkpoint written after resuming differs from the one resumed from" << endl;
+        failed = true;
+    }
+
+    cout << "\ttesting the resumed search has the same populations ... " << endl;
+    if (resumed->get_best_fitness() != original->get_best_fitness() || resumed->get_worst_fitness() != original->get_worst_fitness()) {
+        cout << "\t\tFAILED: the resumed search's best and worst fitnesses were " << resumed->get_best_fitness() << " and " << resumed->get_worst_fitness()
+             << " instead of " << original->get_best_fitness() << " and " << original->get_worst_fitness() << endl;
+        failed = true;
+    }
+
+    ostringstream original_best, resumed_best;
+    original->get_best_genome()->write_to_stream(original_best);
+    resumed->get_best_genome()->write_to_stream(resumed_best);
+    if (original_best.str() != resumed_best.str()) {
+        cout << "\t\tFAILED: the resumed search's best genome differs from the original's" << endl;
+        failed = true;
+    }
+
+    //the checkpoint has to reflect genomes inserted after the last one, not
+    //the genomes it wrote the last time
+    cout << "\ttesting checkpoints after more genomes are inserted ... " << endl;
+    run_genomes(original, 10, inputs, outputs);
+    write_checkpoint(original, checkpoint_filename);
+    string later_bytes = read_checkpoint_bytes(checkpoint_filename);
+
+    if (later_bytes == original_bytes) {
+        cout << "\t\tFAILED: the checkpoint did not change after inserting more genomes" << endl;
+        failed = true;
+    }
+
+    EXAMM *later = create_examm();
+    later->read_checkpoint(checkpoint_filename);
+    write_checkpoint(later, resumed_filename);
+
+    if (read_checkpoint_bytes(resumed_filename) != later_bytes) {
+        cout << "\t\tFAILED: the later checkpoint written after resuming differs from the one resumed from" << endl;
+        failed = true;
+    }
+
+    //the resumed search generates as many more genomes as the original
+    cout << "\ttesting the resumed search finishes with the original ... " << endl;
+    int32_t original_total = 30;
+    while (original_total <= 2 * max_genomes && run_genomes(original, 1, inputs, outputs)) original_total++;
+
+    int32_t resumed_total = 20;
+    while (resumed_total <= 2 * max_genomes && run_genomes(resumed, 1, inputs, outputs)) resumed_total++;
+
+    if (original_total > 2 * max_genomes || original_total <= 30 || resumed_total != original_total) {
+        cout << "\t\tFAILED: the original search generated " << original_total << " genomes and the resumed one " << resumed_total << endl;
+        failed = true;
+    }
+
+    delete original;
+    delete resumed;
+    delete later;
+
+    remove(checkpoint_filename.c_str());
+    remove(resumed_filename.c_str());
+
+    if (!failed) {
+        cout << "ALL PASSED!" << endl;
+    } else {
+        cout << "SOME FAILED!" << endl;
+    }
+
+    return failed ? 1 : 0;
+}
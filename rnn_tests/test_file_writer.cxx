@@ -0,0 +1,249 @@
+#include <atomic>
+using std::atomic;
+
+#include <cstdio>
+
+#include <fstream>
+using std::ifstream;
+using std::ios;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <sstream>
+using std::ostringstream;
+
+#include <string>
+using std::string;
+using std::to_string;
+
+#include <thread>
+using std::thread;
+
+#include <vector>
+using std::vector;
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/arguments.hxx"
+#include "common/file_writer.hxx"
+
+bool failed = false;
+
+string read_file(string filename) {
+    ifstream in(filename, ios::in | ios::binary);
+    ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+bool file_exists(string filename) {
+    struct stat file_stat;
+    return stat(filename.c_str(), &file_stat) == 0;
+}
+
+void check_contents(string name, string filename, string expected) {
+    string contents = read_file(filename);
+    if (contents != expected) {
+        cout << "\t\tFAILED " << name << ": '" << filename << "' had " << contents.size() << " bytes which were not the expected " << expected.size() << endl;
+        failed = true;
+    }
+}
+
+void test_write(string prefix) {
+    cout << "\ttesting writes replace the file ... " << endl;
+
+    string filename = prefix + "write";
+    FileWriter writer(16);
+
+    writer.write(filename, "first version which is longer");
+    writer.write(filename, "second version");
+    writer.flush();
+
+    check_contents("write", filename, "second version");
+
+    if (file_exists(filename + ".tmp")) {
+        cout << "\t\tFAILED: the temporary file '" << filename << ".tmp' was left behind" << endl;
+        failed = true;
+    }
+
+    remove(filename.c_str());
+}
+
+//the file is renamed into place, so a reader never sees part of a write
+void test_write_is_atomic(string prefix) {
+    cout << "\ttesting writes are never seen partially written ... " << endl;
+
+    string filename = prefix + "atomic";
+    string first(1 << 20, 'a');
+    string second(2 << 20, 'b');
+
+    FileWriter writer(4);
+    writer.write(filename, first);
+    writer.flush();
+
+    atomic<bool> done(false);
+    atomic<int32_t> reads(0);
+    atomic<int32_t> bad_reads(0);
+
+    thread reader([&]() {
+        while (!done) {
+            string contents = read_file(filename);
+            if (contents != first && contents != second) bad_reads++;
+            reads++;
+        }
+    });
+
+    for (int32_t i = 0; i < 100; i++) {
+        writer.write(filename, (i % 2 == 0) ? second : first);
+    }
+    writer.flush();
+
+    //make sure the reader got to read while the file was being replaced
+    while (reads < 10) std::this_thread::yield();
+    done = true;
+    reader.join();
+
+    if (bad_reads > 0) {
+        cout << "\t\tFAILED: " << bad_reads << " of " << reads << " reads saw a partially written file" << endl;
+        failed = true;
+    }
+
+    check_contents("last atomic write", filename, first);
+    remove(filename.c_str());
+}
+
+void test_append_order(string prefix) {
+    cout << "\ttesting appends are written in order ... " << endl;
+
+    string filename = prefix + "append";
+    remove(filename.c_str());
+
+    FileWriter writer(8);
+    string expected;
+    for (int32_t i = 0; i < 1000; i++) {
+        string line = "line " + to_string(i) + "\n";
+        writer.append(filename, line);
+        expected += line;
+    }
+    writer.flush();
+
+    check_contents("appends", filename, expected);
+
+    //a write replaces whatever was appended before it, and later appends go
+    //after it
+    writer.append(filename, "lost");
+    writer.write(filename, "replaced\n");
+    writer.append(filename, "appended\n");
+    writer.flush();
+
+    check_contents("appends around a write", filename, "replaced\nappended\n");
+    remove(filename.c_str());
+}
+
+void test_concurrent_appends(string prefix) {
+    cout << "\ttesting appends from several threads ... " << endl;
+
+    string filename = prefix + "concurrent";
+    remove(filename.c_str());
+
+    int32_t number_threads = 4;
+    int32_t number_lines = 500;
+
+    //a queue of 1 makes the threads wait on each other
+    FileWriter writer(1);
+    vector<thread> threads;
+    for (int32_t i = 0; i < number_threads; i++) {
+        threads.push_back(thread([&writer, filename, i, number_lines]() {
+            for (int32_t j = 0; j < number_lines; j++) {
+                writer.append(filename, to_string(i) + " " + to_string(j) + "\n");
+            }
+        }));
+    }
+    for (int32_t i = 0; i < number_threads; i++) threads[i].join();
+    writer.flush();
+
+    //every thread's lines have to be there, in the order it appended them
+    vector<int32_t> next_line(number_threads, 0);
+    string contents = read_file(filename);
+    size_t start = 0;
+    while (start < contents.size()) {
+        size_t end = contents.find('\n', start);
+        if (end == string::npos) end = contents.size();
+
+        int32_t thread_number, line_number;
+        if (sscanf(contents.substr(start, end - start).c_str(), "%d %d", &thread_number, &line_number) != 2 || thread_number < 0 || thread_number >= number_threads || line_number != next_line[thread_number]) {
+            cout << "\t\tFAILED: unexpected line '" << contents.substr(start, end - start) << "'" << endl;
+            failed = true;
+            break;
+        }
+        next_line[thread_number]++;
+        start = end + 1;
+    }
+
+    for (int32_t i = 0; i < number_threads; i++) {
+        if (next_line[i] != number_lines) {
+            cout << "\t\tFAILED: thread " << i << " appended " << number_lines << " lines but " << next_line[i] << " were written" << endl;
+            failed = true;
+        }
+    }
+
+    remove(filename.c_str());
+}
+
+void test_destructor_flushes(string prefix) {
+    cout << "\ttesting the writer finishes its queue when deleted ... " << endl;
+
+    string filename = prefix + "destructor";
+
+    FileWriter *writer = new FileWriter(1024);
+    for (int32_t i = 0; i < 100; i++) {
+        writer->write(filename, "version " + to_string(i));
+    }
+    delete writer;
+
+    check_contents("after deleting the writer", filename, "version 99");
+    remove(filename.c_str());
+}
+
+void test_failed_write(string prefix) {
+    cout << "\ttesting a failed write doesn't stop later ones ... " << endl;
+
+    string filename = prefix + "after_failure";
+
+    FileWriter writer(16);
+    writer.write(prefix + "missing_directory/file", "can't be written");
+    writer.write(filename, "written");
+    writer.flush();
+
+    check_contents("after a failed write", filename, "written");
+    remove(filename.c_str());
+}
+
+int main(int argc, char **argv) {
+    vector<string> arguments = vector<string>(argv, argv + argc);
+
+    string directory = "/tmp";
+    get_argument(arguments, "--test_directory", false, directory);
+
+    cout << "TESTING FILE WRITER" << endl;
+
+    string prefix = directory + "/test_file_writer_" + to_string(getpid()) + "_";
+
+    test_write(prefix);
+    test_write_is_atomic(prefix);
+    test_append_order(prefix);
+    test_concurrent_appends(prefix);
+    test_destructor_flushes(prefix);
+    test_failed_write(prefix);
+
+    if (!failed) {
+        cout << "ALL PASSED!" << endl;
+    } else {
+        cout << "SOME FAILED!" << endl;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,154 @@
+#include <atomic>
+using std::atomic;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <map>
+using std::map;
+
+#include <sstream>
+using std::istringstream;
+using std::ostringstream;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "common/arguments.hxx"
+
+#include "rnn/rnn_genome.hxx"
+#include "rnn/generate_nn.hxx"
+
+#include "time_series/series_view.hxx"
+
+#include "gradient_test.hxx"
+
+bool failed = false;
+
+string get_bytes(RNN_Genome *genome) {
+    ostringstream out;
+    genome->write_to_stream(out);
+    return out.str();
+}
+
+//the compact encoding has to decode to a genome which writes exactly the
+//same bytes as the original
+void test_encoding(string name, RNN_Genome *genome, const vector<string> &input_names, const vector<string> &output_names, const map<string,double> &mins, const map<string,double> &maxs) {
+    cout << "\ttesting encoding of '" << name << "' ... " << endl;
+
+    string bytes = get_bytes(genome);
+
+    ostringstream compact_out;
+    genome->write_to_compact_stream(compact_out, true);
+    string compact_bytes = compact_out.str();
+
+    istringstream compact_in(compact_bytes);
+    RNN_Genome *decoded = new RNN_Genome(compact_in);
+
+    if (get_bytes(decoded) != bytes) {
+        cout << "\t\tFAILED: decoding the compact encoding with parameter names did not give the original genome" << endl;
+        failed = true;
+    }
+    delete decoded;
+
+    //without the parameter names they are set by the receiver
+    ostringstream nameless_out;
+    genome->write_to_compact_stream(nameless_out, false);
+    string nameless_bytes = nameless_out.str();
+
+    istringstream nameless_in(nameless_bytes);
+    decoded = new RNN_Genome(nameless_in);
+    decoded->set_parameter_names(input_names, output_names);
+    decoded->set_normalize_bounds(mins, maxs);
+
+    if (get_bytes(decoded) != bytes) {
+        cout << "\t\tFAILED: decoding the compact encoding without parameter names did not give the original genome" << endl;
+        failed = true;
+    }
+    delete decoded;
+
+    if (compact_bytes.size() >= bytes.size() || nameless_bytes.size() >= compact_bytes.size()) {
+        cout << "\t\tFAILED: encoding sizes were " << bytes.size() << " (full), " << compact_bytes.size() << " (compact) and " << nameless_bytes.size() << " (compact without names)" << endl;
+        failed = true;
+    }
+}
+
+int main(int argc, char **argv) {
+    vector<string> arguments = vector<string>(argv, argv + argc);
+
+    initialize_generator();
+
+    cout << "TESTING COMPACT GENOME ENCODING" << endl;
+
+    int32_t number_inputs = 3;
+    int32_t number_outputs = 2;
+    int32_t input_length = 20;
+
+    vector<string> input_names = {"in_a", "in_b", "in_c"};
+    vector<string> output_names = {"out_a", "out_b"};
+    map<string,double> mins = {{"in_a", -1.0}, {"in_b", 0.0}, {"in_c", 0.5}, {"out_a", -2.0}, {"out_b", 1.0}};
+    map<string,double> maxs = {{"in_a", 1.0}, {"in_b", 10.0}, {"in_c", 0.75}, {"out_a", 2.0}, {"out_b", 3.0}};
+
+    vector< vector<double> > input_values(number_inputs), output_values(number_outputs);
+    for (int32_t i = 0; i < number_inputs; i++) generate_random_vector(input_length, input_values[i]);
+    for (int32_t i = 0; i < number_outputs; i++) generate_random_vector(input_length, output_values[i]);
+
+    vector< vector< vector<double> > > input_series = {input_values};
+    vector< vector< vector<double> > > output_series = {output_values};
+    SeriesViews inputs(input_series), outputs(output_series);
+
+    vector<RNN_Genome*> genomes = {
+        create_ff(number_inputs, 2, 3, number_outputs, 3),
+        create_elman(number_inputs, 1, 4, number_outputs, 2),
+        create_lstm(number_inputs, 2, 2, number_outputs, 5),
+        create_gru(number_inputs, 1, 3, number_outputs, 1),
+        create_delta(number_inputs, 1, 2, number_outputs, 3)
+    };
+    vector<string> names = {"FF", "ELMAN", "LSTM", "GRU", "DELTA"};
+
+    atomic<int32_t> edge_innovation_count(1000);
+    atomic<int32_t> node_innovation_count(1000);
+
+    for (int32_t i = 0; i < (int32_t)genomes.size(); i++) {
+        RNN_Genome *genome = genomes[i];
+        genome->set_parameter_names(input_names, output_names);
+        genome->set_normalize_bounds(mins, maxs);
+        genome->set_generation_id(i + 1);
+        genome->initialize_randomly();
+
+        test_encoding(names[i] + ": initial", genome, input_names, output_names, mins, maxs);
+
+        //mutations leave gaps in the innovation numbers, disabled edges and
+        //recurrent edges, which are all encoded differently
+        for (int32_t j = 0; j < 5; j++) {
+            genome->add_edge(0.0, 0.5, edge_innovation_count);
+            genome->add_node(0.0, 0.5, SIMPLE_NODE, 3, edge_innovation_count, node_innovation_count);
+            genome->disable_edge();
+        }
+        //as EXAMM does after mutating a genome
+        genome->assign_reachability();
+        genome->initialize_randomly();
+
+        test_encoding(names[i] + ": mutated", genome, input_names, output_names, mins, maxs);
+
+        //training gives best parameters which differ from the initial ones
+        genome->set_bp_iterations(3);
+        genome->backpropagate_stochastic(inputs, outputs, inputs, outputs);
+
+        test_encoding(names[i] + ": trained", genome, input_names, output_names, mins, maxs);
+
+        delete genome;
+    }
+
+    if (!failed) {
+        cout << "ALL PASSED!" << endl;
+    } else {
+        cout << "SOME FAILED!" << endl;
+    }
+
+    return failed ? 1 : 0;
+}
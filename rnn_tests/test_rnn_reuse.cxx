@@ -0,0 +1,146 @@
+#include <atomic>
+using std::atomic;
+
+#include <iomanip>
+using std::setprecision;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "common/arguments.hxx"
+
+#include "rnn/generate_nn.hxx"
+#include "rnn/rnn.hxx"
+#include "rnn/rnn_genome.hxx"
+
+#include "time_series/series_view.hxx"
+
+#include "gradient_test.hxx"
+
+bool failed = false;
+
+void generate_series(const vector<int32_t> &lengths, int32_t number_parameters, vector< vector< vector<double> > > &series) {
+    series.assign(lengths.size(), vector< vector<double> >(number_parameters));
+    for (int32_t i = 0; i < (int32_t)lengths.size(); i++) {
+        for (int32_t j = 0; j < number_parameters; j++) generate_random_vector(lengths[i], series[i][j]);
+    }
+}
+
+void compare_value(string name, double reused, double fresh) {
+    if (reused != fresh) {
+        cout << "\t\tFAILED " << name << ": " << setprecision(17) << reused << " with the reused RNN but " << fresh << " with a new one" << endl;
+        failed = true;
+    }
+}
+
+//the genome's evaluation RNN is reused between calls, so every call has to
+//give exactly what a newly built RNN gives
+void test_evaluation(string name, RNN_Genome *genome, const vector<double> &parameters, const SeriesViews &inputs, const SeriesViews &outputs) {
+    cout << "\ttesting " << name << " ... " << endl;
+
+    double reused_mse = genome->get_mse(parameters, inputs, outputs);
+    double reused_mae = genome->get_mae(parameters, inputs, outputs);
+    vector< vector<double> > reused_predictions = genome->get_predictions(parameters, inputs, outputs);
+
+    RNN *rnn = genome->get_rnn();
+    rnn->set_weights(parameters);
+
+    double fresh_mse = 0.0;
+    double fresh_mae = 0.0;
+    vector< vector<double> > fresh_predictions;
+    for (int32_t i = 0; i < inputs.size(); i++) {
+        fresh_mse += rnn->prediction_mse(inputs[i], outputs[i], false, false, 0.0);
+        fresh_mae += rnn->prediction_mae(inputs[i], outputs[i], false, false, 0.0);
+        fresh_predictions.push_back(rnn->get_predictions(inputs[i], outputs[i], false, 0.0));
+    }
+    fresh_mse /= inputs.size();
+    fresh_mae /= inputs.size();
+
+    delete rnn;
+
+    compare_value("mse", reused_mse, fresh_mse);
+    compare_value("mae", reused_mae, fresh_mae);
+
+    if (reused_predictions != fresh_predictions) {
+        cout << "\t\tFAILED: the predictions of the reused RNN differ from a new one's" << endl;
+        failed = true;
+    }
+}
+
+int main(int argc, char **argv) {
+    vector<string> arguments = vector<string>(argv, argv + argc);
+
+    initialize_generator();
+
+    cout << "TESTING RNN REUSE" << endl;
+
+    int32_t number_inputs = 3;
+    int32_t number_outputs = 2;
+
+    //different numbers and lengths of series, so the reused RNN's arrays
+    //have to grow and shrink between calls
+    vector< vector< vector<double> > > long_inputs, long_outputs, short_inputs, short_outputs;
+    generate_series({30, 7, 50}, number_inputs, long_inputs);
+    generate_series({30, 7, 50}, number_outputs, long_outputs);
+    generate_series({100, 3}, number_inputs, short_inputs);
+    generate_series({100, 3}, number_outputs, short_outputs);
+
+    SeriesViews long_input_views(long_inputs), long_output_views(long_outputs);
+    SeriesViews short_input_views(short_inputs), short_output_views(short_outputs);
+
+    vector<RNN_Genome*> genomes = {
+        create_ff(number_inputs, 1, 4, number_outputs, 2),
+        create_elman(number_inputs, 1, 4, number_outputs, 2),
+        create_lstm(number_inputs, 2, 2, number_outputs, 3),
+        create_gru(number_inputs, 1, 3, number_outputs, 1),
+        create_delta(number_inputs, 1, 2, number_outputs, 3)
+    };
+    vector<string> names = {"FF", "ELMAN", "LSTM", "GRU", "DELTA"};
+
+    atomic<int32_t> edge_innovation_count(1000);
+    atomic<int32_t> node_innovation_count(1000);
+
+    for (int32_t i = 0; i < (int32_t)genomes.size(); i++) {
+        RNN_Genome *genome = genomes[i];
+
+        vector<double> first_parameters, second_parameters;
+        generate_random_vector(genome->get_number_weights(), first_parameters);
+        generate_random_vector(genome->get_number_weights(), second_parameters);
+
+        test_evaluation(names[i] + ": first evaluation", genome, first_parameters, long_input_views, long_output_views);
+        test_evaluation(names[i] + ": new parameters and series", genome, second_parameters, short_input_views, short_output_views);
+        test_evaluation(names[i] + ": the first parameters again", genome, first_parameters, long_input_views, long_output_views);
+
+        //changing the structure has to rebuild the evaluation RNN
+        genome->add_node(0.0, 0.5, SIMPLE_NODE, 3, edge_innovation_count, node_innovation_count);
+        genome->add_edge(0.0, 0.5, edge_innovation_count);
+        genome->assign_reachability();
+
+        vector<double> mutated_parameters;
+        generate_random_vector(genome->get_number_weights(), mutated_parameters);
+
+        if (mutated_parameters.size() == first_parameters.size()) {
+            cout << "\t\tFAILED: mutating " << names[i] << " did not add any weights" << endl;
+            failed = true;
+        }
+
+        test_evaluation(names[i] + ": after mutation", genome, mutated_parameters, long_input_views, long_output_views);
+
+        delete genome;
+    }
+
+    if (!failed) {
+        cout << "ALL PASSED!" << endl;
+    } else {
+        cout << "SOME FAILED!" << endl;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+#include <cmath>
+using std::fabs;
+using std::sqrt;
+
+#include <cstdio>
+
+#include <fstream>
+using std::ofstream;
+
+#include <iomanip>
+using std::setprecision;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <map>
+using std::map;
+
+#include <random>
+using std::minstd_rand0;
+using std::uniform_real_distribution;
+
+#include <sstream>
+using std::ostringstream;
+
+#include <string>
+using std::string;
+using std::to_string;
+
+#include <vector>
+using std::vector;
+
+#include <unistd.h>
+
+#include "common/arguments.hxx"
+
+#include "time_series/time_series.hxx"
+
+minstd_rand0 generator(1337);
+
+bool failed = false;
+
+void generate_values(int32_t number_values, double offset, vector<double> &values) {
+    uniform_real_distribution<double> rng(-1.0, 1.0);
+
+    values.resize(number_values);
+    for (int32_t i = 0; i < number_values; i++) {
+        values[i] = offset + rng(generator);
+    }
+}
+
+//the mean and sample variance the straightforward way, with a pass for each
+//and in long double, to check the single pass statistics against
+void two_pass_statistics(const vector<double> &values, double &average, double &variance) {
+    long double sum = 0.0;
+    for (int32_t i = 0; i < (int32_t)values.size(); i++) sum += values[i];
+    long double mean = sum / values.size();
+
+    long double squared_differences = 0.0;
+    for (int32_t i = 0; i < (int32_t)values.size(); i++) {
+        long double difference = values[i] - mean;
+        squared_differences += difference * difference;
+    }
+
+    average = mean;
+    variance = squared_differences / (values.size() - 1);
+}
+
+void check_close(string name, double calculated, double expected, double tolerance) {
+    if (fabs(calculated - expected) > tolerance * (1.0 + fabs(expected))) {
+        cout << "\t\tFAILED " << name << ": " << setprecision(17) << calculated << " but the two pass reference is " << expected << endl;
+        failed = true;
+    }
+}
+
+void check_equal(string name, double calculated, double expected) {
+    if (calculated != expected) {
+        cout << "\t\tFAILED " << name << ": " << setprecision(17) << calculated << " instead of " << expected << endl;
+        failed = true;
+    }
+}
+
+//the statistics are found a block of values at a time, so lengths around
+//the block size are checked. a large offset compared to the spread of the
+//values loses the variance entirely if it is found from the sum of squares.
+void test_statistics(int32_t number_values, double offset) {
+    cout << "\ttesting statistics of " << number_values << " values with an offset of " << offset << " ... " << endl;
+
+    vector<double> values;
+    generate_values(number_values, offset, values);
+
+    TimeSeries series("test");
+    for (int32_t i = 0; i < number_values; i++) series.add_value(values[i]);
+    series.calculate_statistics();
+
+    double average, variance;
+    two_pass_statistics(values, average, variance);
+
+    check_close("average", series.get_average(), average, 1e-14);
+    check_close("variance", series.get_variance(), variance, 1e-8);
+    check_close("std_dev", series.get_std_dev(), sqrt(variance), 1e-8);
+
+    double min = values[0], max = values[0];
+    double min_change = values[1] - values[0], max_change = values[1] - values[0];
+    for (int32_t i = 1; i < number_values; i++) {
+        if (values[i] < min) min = values[i];
+        if (values[i] > max) max = values[i];
+        if (values[i] - values[i - 1] < min_change) min_change = values[i] - values[i - 1];
+        if (values[i] - values[i - 1] > max_change) max_change = values[i] - values[i - 1];
+    }
+
+    check_equal("min", series.get_min(), min);
+    check_equal("max", series.get_max(), max);
+    check_equal("min_change", series.get_min_change(), min_change);
+    check_equal("max_change", series.get_max_change(), max_change);
+}
+
+string write_csv(string filename, const vector< vector<double> > &values) {
+    ofstream out(filename);
+    out << "a,b" << endl;
+    for (int32_t i = 0; i < (int32_t)values[0].size(); i++) {
+        out << setprecision(17) << values[0][i] << "," << values[1][i] << endl;
+    }
+    out.close();
+
+    return filename;
+}
+
+//the z-score bounds are merged from each file's statistics, so they have to
+//match the mean and standard deviation over the values of all the files
+void test_z_score(string prefix) {
+    cout << "\ttesting z-score normalization over several files ... " << endl;
+
+    vector<int32_t> lengths = {300, 1000, 57};
+    vector<double> offsets = {1e6, 1e6 + 0.5, 1e6 - 0.25};
+
+    vector<string> filenames;
+    vector< vector< vector<double> > > file_values(lengths.size(), vector< vector<double> >(2));
+    vector<double> all_a;
+    for (int32_t i = 0; i < (int32_t)lengths.size(); i++) {
+        generate_values(lengths[i], offsets[i], file_values[i][0]);
+        generate_values(lengths[i], -offsets[i], file_values[i][1]);
+        filenames.push_back(write_csv(prefix + to_string(i) + ".csv", file_values[i]));
+
+        all_a.insert(all_a.end(), file_values[i][0].begin(), file_values[i][0].end());
+    }
+
+    vector<string> arguments = {"test_series_statistics", "--filenames", filenames[0], filenames[1], filenames[2], "--training_indexes", "0", "1", "2", "--test_indexes", "0", "--input_parameter_names", "a", "--output_parameter_names", "b", "--normalize", "--normalize_type", "z_score"};
+    TimeSeriesSets *time_series_sets = TimeSeriesSets::generate_from_arguments(arguments, false);
+
+    double average, variance;
+    two_pass_statistics(all_a, average, variance);
+    double std_dev = sqrt(variance);
+
+    map<string,double> mins = time_series_sets->get_normalize_mins();
+    map<string,double> maxs = time_series_sets->get_normalize_maxs();
+    check_close("z-score mean", mins["a"], average, 1e-14);
+    check_close("z-score std_dev", maxs["a"] - mins["a"], std_dev, 1e-8);
+
+    vector< vector<double> > normalized;
+    time_series_sets->export_series_by_name("a", normalized);
+
+    if (normalized.size() != lengths.size()) {
+        cout << "\t\tFAILED: " << normalized.size() << " series were loaded instead of " << lengths.size() << endl;
+        failed = true;
+    } else {
+        for (int32_t i = 0; i < (int32_t)normalized.size(); i++) {
+            for (int32_t j = 0; j < (int32_t)normalized[i].size(); j++) {
+                double expected = (file_values[i][0][j] - average) / std_dev;
+                if (fabs(normalized[i][j] - expected) > 1e-6) {
+                    cout << "\t\tFAILED: value " << j << " of file " << i << " was normalized to " << setprecision(17) << normalized[i][j] << " instead of " << expected << endl;
+                    failed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    delete time_series_sets;
+    for (int32_t i = 0; i < (int32_t)filenames.size(); i++) remove(filenames[i].c_str());
+}
+
+int main(int argc, char **argv) {
+    vector<string> arguments = vector<string>(argv, argv + argc);
+
+    string directory = "/tmp";
+    get_argument(arguments, "--test_directory", false, directory);
+
+    cout << "TESTING SERIES STATISTICS" << endl;
+
+    vector<int32_t> lengths = {2, 255, 256, 257, 1000, 100000};
+    vector<double> offsets = {0.0, 1e6, 1e9};
+    for (int32_t i = 0; i < (int32_t)lengths.size(); i++) {
+        for (int32_t j = 0; j < (int32_t)offsets.size(); j++) {
+            test_statistics(lengths[i], offsets[j]);
+        }
+    }
+
+    test_z_score(directory + "/test_series_statistics_" + to_string(getpid()) + "_");
+
+    if (!failed) {
+        cout << "ALL PASSED!" << endl;
+    } else {
+        cout << "SOME FAILED!" << endl;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,172 @@
+#include <algorithm>
+using std::sort;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <map>
+using std::map;
+
+#include <string>
+using std::string;
+using std::to_string;
+
+#include <utility>
+using std::pair;
+
+#include <vector>
+using std::vector;
+
+#include "common/arguments.hxx"
+
+#include "rnn/examm.hxx"
+#include "rnn/rnn_genome.hxx"
+
+#include "time_series/series_view.hxx"
+
+#include "gradient_test.hxx"
+
+bool failed = false;
+
+vector<string> input_names = {"in_a", "in_b"};
+vector<string> output_names = {"out_a"};
+map<string,double> mins = {{"in_a", 0.0}, {"in_b", 0.0}, {"out_a", 0.0}};
+map<string,double> maxs = {{"in_a", 1.0}, {"in_b", 1.0}, {"out_a", 1.0}};
+
+int32_t bp_iterations = 8;
+int32_t rung_size = 4;
+
+void check(bool passed, string message) {
+    if (!passed) {
+        cout << "\t\tFAILED: " << message << endl;
+        failed = true;
+    }
+}
+
+int main(int argc, char **argv) {
+    vector<string> arguments = vector<string>(argv, argv + argc);
+
+    initialize_generator();
+
+    cout << "TESTING SUCCESSIVE HALVING" << endl;
+
+    int32_t series_length = 20;
+    vector< vector< vector<double> > > input_series(4), output_series(4);
+    for (int32_t i = 0; i < (int32_t)input_series.size(); i++) {
+        input_series[i].resize(input_names.size());
+        output_series[i].resize(output_names.size());
+        for (int32_t j = 0; j < (int32_t)input_names.size(); j++) generate_random_vector(series_length, input_series[i][j]);
+        for (int32_t j = 0; j < (int32_t)output_names.size(); j++) generate_random_vector(series_length, output_series[i][j]);
+    }
+    SeriesViews inputs(input_series), outputs(output_series);
+
+    EXAMM *examm = new EXAMM(5, 2, 100, 0, "clear_worst_n",
+            input_names, output_names, mins, maxs,
+            bp_iterations, 0.001,
+            true, 1.0,
+            true, 0.05,
+            false, 0.0,
+            1, 5,
+            0.1, 0.3,
+            "global", "uniform", "");
+    examm->set_successive_halving(0.25, 0.5, 0.5, rung_size);
+
+    cout << "\ttesting new genomes are partially trained and held back ... " << endl;
+
+    //fitness and generation id of every genome in the rung
+    vector< pair<double,int32_t> > ranked;
+    for (int32_t i = 0; i < rung_size; i++) {
+        RNN_Genome *genome = examm->generate_genome();
+
+        check(genome->get_bp_iterations() == 2, "a new genome has " + to_string(genome->get_bp_iterations()) + " bp iterations instead of 2");
+        check(genome->get_training_series_fraction() == 0.5, "a new genome trains on a fraction " + to_string(genome->get_training_series_fraction()) + " of the series instead of 0.5");
+
+        genome->backpropagate_stochastic(inputs, outputs, inputs, outputs);
+        ranked.push_back(pair<double,int32_t>(genome->get_fitness(), genome->get_generation_id()));
+
+        check(genome->has_optimizer_state(), "a partially trained genome did not keep its optimizer state");
+
+        check(!examm->insert_genome(genome), "a partially trained genome was inserted");
+        //the islands only hold the untrained genomes they are initialized with
+        check(examm->get_best_fitness() == EXAMM_MAX_DOUBLE, "a partially trained genome is in an island");
+
+        delete genome;
+    }
+
+    cout << "\ttesting the best half of the rung is promoted ... " << endl;
+
+    sort(ranked.begin(), ranked.end());
+
+    vector<RNN_Genome*> promoted;
+    for (int32_t i = 0; i < rung_size / 2; i++) {
+        RNN_Genome *genome = examm->generate_genome();
+        promoted.push_back(genome);
+
+        check(genome->get_generation_id() == ranked[i].second, "promoted genome " + to_string(genome->get_generation_id()) + " is not the rung's number " + to_string(i + 1) + ", genome " + to_string(ranked[i].second));
+        check(genome->get_bp_iterations() == bp_iterations - 2, "a promoted genome has " + to_string(genome->get_bp_iterations()) + " bp iterations instead of " + to_string(bp_iterations - 2));
+        check(genome->get_training_series_fraction() == 1.0, "a promoted genome trains on a fraction " + to_string(genome->get_training_series_fraction()) + " of the series instead of all of them");
+        check(genome->has_optimizer_state(), "a promoted genome lost its optimizer state");
+        check(!genome->get_keep_optimizer_state(), "a promoted genome will keep its optimizer state after training");
+    }
+
+    cout << "\ttesting the rest of the rung is culled ... " << endl;
+
+    RNN_Genome *next = examm->generate_genome();
+    check(next->get_generation_id() == rung_size + 1, "genome " + to_string(next->get_generation_id()) + " was handed out after the promoted genomes instead of the new genome " + to_string(rung_size + 1));
+    check(next->get_bp_iterations() == 2, "the genome after the promoted genomes is not a new partially trained genome");
+    delete next;
+
+    cout << "\ttesting promoted genomes are inserted once fully trained ... " << endl;
+
+    for (int32_t i = 0; i < (int32_t)promoted.size(); i++) {
+        promoted[i]->backpropagate_stochastic(inputs, outputs, inputs, outputs);
+
+        //training continues from the partial training, keeping its best parameters
+        check(promoted[i]->get_fitness() <= ranked[i].first, "a promoted genome's fitness got worse than after its partial training");
+        check(!promoted[i]->has_optimizer_state(), "a fully trained genome kept its optimizer state");
+
+        check(examm->insert_genome(promoted[i]), "a fully trained promoted genome was not inserted");
+        delete promoted[i];
+    }
+    check(examm->get_best_fitness() < EXAMM_MAX_DOUBLE, "no promoted genome is in an island");
+
+    delete examm;
+
+    cout << "\ttesting a promoted genome is not inserted into an island cleared since it was generated ... " << endl;
+
+    examm = new EXAMM(5, 1, 100, 0, "clear_worst_n",
+            input_names, output_names, mins, maxs,
+            bp_iterations, 0.001,
+            true, 1.0,
+            true, 0.05,
+            false, 0.0,
+            1, 5,
+            0.1, 0.3,
+            "global", "uniform", "");
+    examm->set_successive_halving(0.25, 0.5, 0.5, 2);
+
+    for (int32_t i = 0; i < 2; i++) {
+        RNN_Genome *genome = examm->generate_genome();
+        genome->backpropagate_stochastic(inputs, outputs, inputs, outputs);
+        examm->insert_genome(genome);
+        delete genome;
+    }
+
+    RNN_Genome *cleared = examm->generate_genome();
+    check(examm->clear_island_with_worst_best_genome() == 0, "the only island was not cleared");
+
+    cleared->backpropagate_stochastic(inputs, outputs, inputs, outputs);
+    check(!examm->insert_genome(cleared), "a promoted genome was inserted into an island cleared after it was generated");
+    delete cleared;
+
+    delete examm;
+
+    if (!failed) {
+        cout << "ALL PASSED!" << endl;
+    } else {
+        cout << "SOME FAILED!" << endl;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+#include <atomic>
+using std::atomic;
+
+#include <chrono>
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <mutex>
+using std::lock_guard;
+using std::mutex;
+
+#include <set>
+using std::set;
+
+#include <string>
+using std::string;
+using std::to_string;
+
+#include <thread>
+using std::thread;
+
+#include <vector>
+using std::vector;
+
+#include "common/arguments.hxx"
+#include "common/thread_pool.hxx"
+
+bool failed = false;
+
+//every task has to have run exactly once by the time parallel_for returns
+bool check_counts(string name, const vector< atomic<int32_t> > &counts) {
+    for (int32_t i = 0; i < (int32_t)counts.size(); i++) {
+        if (counts[i] != 1) {
+            cout << "\t\tFAILED " << name << ": task " << i << " of " << counts.size() << " ran " << counts[i] << " times" << endl;
+            failed = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_each_task_once(ThreadPool &pool) {
+    vector<int32_t> sizes = {0, 1, 2, 7, 64, 1000, 100000};
+
+    for (int32_t i = 0; i < (int32_t)sizes.size(); i++) {
+        string name = to_string(sizes[i]) + " tasks on " + to_string(pool.get_number_threads()) + " workers";
+        cout << "\ttesting " << name << " ... " << endl;
+
+        vector< atomic<int32_t> > counts(sizes[i]);
+        for (int32_t j = 0; j < sizes[i]; j++) counts[j] = 0;
+
+        pool.parallel_for(sizes[i], [&counts](int32_t task) {
+            counts[task]++;
+        });
+
+        check_counts(name, counts);
+    }
+}
+
+void test_uses_workers(ThreadPool &pool) {
+    cout << "\ttesting that tasks run on the workers ... " << endl;
+
+    mutex ids_mutex;
+    set<thread::id> ids;
+
+    pool.parallel_for(64, [&ids_mutex, &ids](int32_t task) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+        lock_guard<mutex> lock(ids_mutex);
+        ids.insert(std::this_thread::get_id());
+    });
+
+    if ((int32_t)ids.size() < 2) {
+        cout << "\t\tFAILED: 64 tasks on " << pool.get_number_threads() << " workers all ran on " << ids.size() << " thread" << endl;
+        failed = true;
+    }
+}
+
+void test_concurrent_calls(ThreadPool &pool) {
+    cout << "\ttesting concurrent calls ... " << endl;
+
+    int32_t number_callers = 6;
+    int32_t number_tasks = 5000;
+
+    vector< vector< atomic<int32_t> > > counts(number_callers);
+    for (int32_t i = 0; i < number_callers; i++) {
+        counts[i] = vector< atomic<int32_t> >(number_tasks);
+        for (int32_t j = 0; j < number_tasks; j++) counts[i][j] = 0;
+    }
+
+    vector<thread> callers;
+    for (int32_t i = 0; i < number_callers; i++) {
+        callers.push_back(thread([&pool, &counts, i, number_tasks]() {
+            //repeated so the callers' jobs overlap in the pool's queue
+            for (int32_t repeat = 0; repeat < 20; repeat++) {
+                pool.parallel_for(number_tasks / 20, [&counts, i, repeat, number_tasks](int32_t task) {
+                    counts[i][repeat * (number_tasks / 20) + task]++;
+                });
+            }
+        }));
+    }
+
+    for (int32_t i = 0; i < number_callers; i++) callers[i].join();
+
+    for (int32_t i = 0; i < number_callers; i++) {
+        if (!check_counts("caller " + to_string(i), counts[i])) break;
+    }
+}
+
+void test_nested_calls(ThreadPool &pool) {
+    cout << "\ttesting nested calls ... " << endl;
+
+    int32_t outer_tasks = 16;
+    int32_t inner_tasks = 100;
+
+    vector< atomic<int32_t> > counts(outer_tasks * inner_tasks);
+    for (int32_t i = 0; i < (int32_t)counts.size(); i++) counts[i] = 0;
+
+    pool.parallel_for(outer_tasks, [&pool, &counts, inner_tasks](int32_t outer) {
+        pool.parallel_for(inner_tasks, [&counts, outer, inner_tasks](int32_t inner) {
+            counts[outer * inner_tasks + inner]++;
+        });
+    });
+
+    check_counts("nested", counts);
+}
+
+void test_repeated_calls(ThreadPool &pool) {
+    cout << "\ttesting repeated small calls ... " << endl;
+
+    //like a training loop, where every iteration runs one small loop
+    int32_t iterations = 20000;
+    atomic<int64_t> total(0);
+    for (int32_t i = 0; i < iterations; i++) {
+        pool.parallel_for(3, [&total](int32_t task) {
+            total += task + 1;
+        });
+    }
+
+    if (total != (int64_t)iterations * 6) {
+        cout << "\t\tFAILED: the tasks of " << iterations << " calls summed to " << total << " instead of " << (int64_t)iterations * 6 << endl;
+        failed = true;
+    }
+}
+
+int main(int argc, char **argv) {
+    vector<string> arguments = vector<string>(argv, argv + argc);
+
+    cout << "TESTING THREAD POOL" << endl;
+
+    vector<int32_t> pool_sizes = {0, 1, 4};
+    for (int32_t i = 0; i < (int32_t)pool_sizes.size(); i++) {
+        ThreadPool pool(pool_sizes[i]);
+
+        test_each_task_once(pool);
+        if (pool_sizes[i] > 0) test_uses_workers(pool);
+        test_concurrent_calls(pool);
+        test_nested_calls(pool);
+        test_repeated_calls(pool);
+    }
+
+    cout << "\ttesting the shared pool ... " << endl;
+    test_each_task_once(*ThreadPool::get_shared());
+
+    if (!failed) {
+        cout << "ALL PASSED!" << endl;
+    } else {
+        cout << "SOME FAILED!" << endl;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,180 @@
+#include <iomanip>
+using std::setprecision;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "common/arguments.hxx"
+
+#include "rnn/delta_node.hxx"
+#include "rnn/gru_node.hxx"
+#include "rnn/lstm_node.hxx"
+#include "rnn/mgu_node.hxx"
+#include "rnn/rnn.hxx"
+#include "rnn/rnn_edge.hxx"
+#include "rnn/rnn_genome.hxx"
+#include "rnn/rnn_node.hxx"
+#include "rnn/rnn_node_interface.hxx"
+#include "rnn/rnn_recurrent_edge.hxx"
+#include "rnn/ugrnn_node.hxx"
+
+#include "time_series/series_view.hxx"
+
+#include "gradient_test.hxx"
+
+bool failed = false;
+
+RNN_Node_Interface* create_node(int32_t node_type, int32_t innovation_number, int32_t depth) {
+    switch (node_type) {
+        case LSTM_NODE: return new LSTM_Node(innovation_number, HIDDEN_LAYER, depth);
+        case GRU_NODE: return new GRU_Node(innovation_number, HIDDEN_LAYER, depth);
+        case MGU_NODE: return new MGU_Node(innovation_number, HIDDEN_LAYER, depth);
+        case UGRNN_NODE: return new UGRNN_Node(innovation_number, HIDDEN_LAYER, depth);
+        case DELTA_NODE: return new Delta_Node(innovation_number, HIDDEN_LAYER, depth);
+        default: return new RNN_Node(innovation_number, HIDDEN_LAYER, depth, node_type);
+    }
+}
+
+//layers of the given node type with forward recurrent edges between them, so
+//every node can have its inputs summed and projected over the whole series.
+//a recurrent edge from the first output back to the first hidden node puts
+//every node into one block which is stepped one time step at a time
+RNN_Genome* create_network(int32_t node_type, int32_t number_inputs, int32_t number_hidden_layers, int32_t number_hidden_nodes, int32_t number_outputs, bool stepped) {
+    vector<RNN_Node_Interface*> rnn_nodes;
+    vector< vector<RNN_Node_Interface*> > layer_nodes(2 + number_hidden_layers);
+    vector<RNN_Edge*> rnn_edges;
+    vector<RNN_Recurrent_Edge*> recurrent_edges;
+
+    int32_t node_innovation_count = 0;
+    int32_t edge_innovation_count = 0;
+    int32_t current_layer = 0;
+
+    for (int32_t i = 0; i < number_inputs; i++) {
+        RNN_Node *node = new RNN_Node(++node_innovation_count, INPUT_LAYER, current_layer, SIMPLE_NODE);
+        rnn_nodes.push_back(node);
+        layer_nodes[current_layer].push_back(node);
+    }
+    current_layer++;
+
+    for (int32_t i = 0; i <= number_hidden_layers; i++) {
+        int32_t layer_size = (i < number_hidden_layers) ? number_hidden_nodes : number_outputs;
+
+        for (int32_t j = 0; j < layer_size; j++) {
+            RNN_Node_Interface *node;
+            if (i < number_hidden_layers) node = create_node(node_type, ++node_innovation_count, current_layer);
+            else node = new RNN_Node(++node_innovation_count, OUTPUT_LAYER, current_layer, SIMPLE_NODE);
+
+            rnn_nodes.push_back(node);
+            layer_nodes[current_layer].push_back(node);
+
+            for (int32_t k = 0; k < (int32_t)layer_nodes[current_layer - 1].size(); k++) {
+                rnn_edges.push_back(new RNN_Edge(++edge_innovation_count, layer_nodes[current_layer - 1][k], node));
+                recurrent_edges.push_back(new RNN_Recurrent_Edge(++edge_innovation_count, 2, layer_nodes[current_layer - 1][k], node));
+            }
+        }
+        current_layer++;
+    }
+
+    if (stepped) {
+        recurrent_edges.push_back(new RNN_Recurrent_Edge(++edge_innovation_count, 1, layer_nodes[current_layer - 1][0], layer_nodes[1][0]));
+    }
+
+    return new RNN_Genome(rnn_nodes, rnn_edges, recurrent_edges);
+}
+
+void compare_values(string name, const vector<double> &projected, const vector<double> &stepped, int32_t length) {
+    for (int32_t i = 0; i < length; i++) {
+        //adding a zero weighted edge doesn't change any value, so they have
+        //to be exactly the same
+        if (projected[i] != stepped[i]) {
+            cout << "\t\tFAILED " << name << "[" << i << "]: " << setprecision(17) << projected[i] << " over the whole series but " << stepped[i] << " stepped" << endl;
+            failed = true;
+            return;
+        }
+    }
+}
+
+void test_node_type(int32_t node_type, const SeriesView &inputs, const SeriesView &outputs) {
+    cout << "\ttesting " << NODE_TYPES[node_type] << " nodes over the whole series against stepping them ... " << endl;
+
+    int32_t number_inputs = inputs.size();
+    int32_t number_outputs = outputs.size();
+
+    RNN_Genome *projected_genome = create_network(node_type, number_inputs, 2, 3, number_outputs, false);
+    RNN_Genome *stepped_genome = create_network(node_type, number_inputs, 2, 3, number_outputs, true);
+
+    RNN *projected_rnn = projected_genome->get_rnn();
+    RNN *stepped_rnn = stepped_genome->get_rnn();
+
+    //the stepped network's extra edge is its last recurrent edge, so its
+    //weight is the last parameter
+    vector<double> parameters;
+    generate_random_vector(projected_rnn->get_number_weights(), parameters);
+    vector<double> stepped_parameters = parameters;
+    stepped_parameters.push_back(0.0);
+
+    if (stepped_parameters.size() != stepped_rnn->get_number_weights()) {
+        cout << "\t\tFAILED: the stepped network has " << stepped_rnn->get_number_weights() << " weights instead of " << stepped_parameters.size() << endl;
+        failed = true;
+    } else {
+        projected_rnn->set_weights(parameters);
+        stepped_rnn->set_weights(stepped_parameters);
+        compare_values("predictions", projected_rnn->get_predictions(inputs, outputs, false, 0.0), stepped_rnn->get_predictions(inputs, outputs, false, 0.0), inputs.get_length() * number_outputs);
+
+        double projected_mse, stepped_mse;
+        vector<double> projected_gradient, stepped_gradient;
+        projected_rnn->get_analytic_gradient(parameters, inputs, outputs, projected_mse, projected_gradient, false, true, 0.0);
+        stepped_rnn->get_analytic_gradient(stepped_parameters, inputs, outputs, stepped_mse, stepped_gradient, false, true, 0.0);
+
+        compare_values("mse", vector<double>(1, projected_mse), vector<double>(1, stepped_mse), 1);
+        compare_values("gradient", projected_gradient, stepped_gradient, parameters.size());
+    }
+
+    delete projected_rnn;
+    delete stepped_rnn;
+    delete projected_genome;
+    delete stepped_genome;
+}
+
+int main(int argc, char **argv) {
+    vector<string> arguments = vector<string>(argv, argv + argc);
+
+    initialize_generator();
+
+    cout << "TESTING TIME PARALLEL INPUTS" << endl;
+
+    int32_t number_inputs = 3;
+    int32_t number_outputs = 2;
+
+    vector<int32_t> node_types = {SIMPLE_NODE, LSTM_NODE, GRU_NODE, MGU_NODE, UGRNN_NODE, DELTA_NODE};
+    vector<int32_t> lengths = {1, 2, 17, 100};
+
+    for (int32_t i = 0; i < (int32_t)lengths.size(); i++) {
+        cout << "\tseries length: " << lengths[i] << endl;
+
+        vector< vector<double> > input_values(number_inputs), output_values(number_outputs);
+        for (int32_t j = 0; j < number_inputs; j++) generate_random_vector(lengths[i], input_values[j]);
+        for (int32_t j = 0; j < number_outputs; j++) generate_random_vector(lengths[i], output_values[j]);
+
+        SeriesView inputs(input_values), outputs(output_values);
+
+        for (int32_t j = 0; j < (int32_t)node_types.size(); j++) {
+            test_node_type(node_types[j], inputs, outputs);
+        }
+    }
+
+    if (!failed) {
+        cout << "ALL PASSED!" << endl;
+    } else {
+        cout << "SOME FAILED!" << endl;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+#include <cstdio>
+
+#include <fstream>
+using std::ofstream;
+
+#include <iomanip>
+using std::fixed;
+using std::setprecision;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <random>
+using std::minstd_rand0;
+using std::uniform_real_distribution;
+
+#include <sstream>
+using std::ostringstream;
+
+#include <string>
+using std::string;
+using std::to_string;
+
+#include <vector>
+using std::vector;
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/arguments.hxx"
+
+#include "time_series/time_series.hxx"
+
+minstd_rand0 generator(1337);
+
+bool failed = false;
+
+//every value is written with the same width, so two versions of a file
+//have the same size and only the modification time can tell them apart
+string generate_csv(int32_t number_rows, vector< vector<double> > &values) {
+    uniform_real_distribution<double> rng(1.0, 9.0);
+
+    ostringstream out;
+    out << "a,b,c" << endl;
+
+    values.assign(3, vector<double>());
+    for (int32_t i = 0; i < number_rows; i++) {
+        for (int32_t j = 0; j < 3; j++) {
+            ostringstream value;
+            value << fixed << setprecision(6) << rng(generator);
+            values[j].push_back(stod(value.str()));
+
+            out << (j > 0 ? "," : "") << value.str();
+        }
+        out << endl;
+    }
+
+    return out.str();
+}
+
+void set_modification_time(string filename, time_t seconds, long nanoseconds) {
+    struct timespec times[2];
+    times[0].tv_sec = seconds;
+    times[0].tv_nsec = nanoseconds;
+    times[1] = times[0];
+    utimensat(AT_FDCWD, filename.c_str(), times, 0);
+}
+
+void write_file(string filename, string contents, time_t modification_time) {
+    ofstream out(filename);
+    out << contents;
+    out.close();
+
+    set_modification_time(filename, modification_time, 0);
+}
+
+//the cache's modification time is set to a marker before loading, which
+//only changes if the cache is rewritten instead of used
+void test_load(string name, const vector<string> &arguments, string cache_filename, const vector< vector<double> > &expected, bool cache_used) {
+    cout << "\ttesting " << name << " ... " << endl;
+
+    time_t marker_time = 1000000000;
+    set_modification_time(cache_filename, marker_time, 0);
+
+    TimeSeriesSets *time_series_sets = TimeSeriesSets::generate_from_arguments(arguments, false);
+
+    vector<string> fields = {"a", "b", "c"};
+    for (int32_t i = 0; i < (int32_t)fields.size(); i++) {
+        vector< vector<double> > loaded;
+        time_series_sets->export_series_by_name(fields[i], loaded);
+
+        if (loaded.size() != 1 || loaded[0] != expected[i]) {
+            cout << "\t\tFAILED: the values of field '" << fields[i] << "' were not the expected ones" << endl;
+            failed = true;
+        }
+    }
+
+    delete time_series_sets;
+
+    struct stat cache_stat;
+    if (stat(cache_filename.c_str(), &cache_stat) != 0) {
+        cout << "\t\tFAILED: the cache '" << cache_filename << "' was not written" << endl;
+        failed = true;
+    } else if ((cache_stat.st_mtime == marker_time) != cache_used) {
+        cout << "\t\tFAILED: the cache was " << (cache_used ? "rewritten instead of used" : "used instead of rewritten") << endl;
+        failed = true;
+    }
+}
+
+int main(int argc, char **argv) {
+    vector<string> arguments = vector<string>(argv, argv + argc);
+
+    string directory = "/tmp";
+    get_argument(arguments, "--test_directory", false, directory);
+
+    cout << "TESTING TIME SERIES CACHE" << endl;
+
+    string prefix = directory + "/test_time_series_cache_" + to_string(getpid());
+    string csv_filename = prefix + ".csv";
+    string cache_filename = prefix + ".cache";
+
+    vector<string> load_arguments = {"test_time_series_cache", "--filenames", csv_filename, "--training_indexes", "0", "--test_indexes", "0", "--input_parameter_names", "a", "b", "--output_parameter_names", "c", "--training_cache", cache_filename};
+    vector<string> stream_arguments = load_arguments;
+    stream_arguments.push_back("--stream_time_series");
+
+    vector< vector<double> > first_values, second_values;
+    string first_contents = generate_csv(500, first_values);
+    string second_contents = generate_csv(500, second_values);
+
+    if (first_contents.size() != second_contents.size() || first_values == second_values) {
+        cout << "\t\tFAILED: the two versions of the file should have the same size but different values" << endl;
+        failed = true;
+    }
+
+    time_t first_time = 1500000000;
+    time_t second_time = first_time + 100;
+
+    write_file(csv_filename, first_contents, first_time);
+    remove(cache_filename.c_str());
+
+    test_load("loading without a cache", load_arguments, cache_filename, first_values, false);
+
+    //the cache is used as long as the file's size, modification time and
+    //contents match
+    test_load("a cache hit", load_arguments, cache_filename, first_values, true);
+    test_load("a streamed cache hit", stream_arguments, cache_filename, first_values, true);
+
+    //a file rewritten with the same size and modification time is caught by
+    //the checksum of its contents
+    write_file(csv_filename, second_contents, first_time);
+    test_load("a cache of different contents", load_arguments, cache_filename, second_values, false);
+    test_load("the rewritten cache", stream_arguments, cache_filename, second_values, true);
+
+    //the modification time is compared to the nanosecond
+    set_modification_time(csv_filename, first_time, 500);
+    test_load("a new modification time within the second", load_arguments, cache_filename, second_values, false);
+
+    //a new modification time makes the cache stale, so the file is loaded
+    //again and the cache rewritten with its values
+    write_file(csv_filename, second_contents, second_time);
+    test_load("a stale cache", load_arguments, cache_filename, second_values, false);
+
+    //streaming rewrites a stale cache too
+    write_file(csv_filename, first_contents, first_time);
+    test_load("a stale streamed cache", stream_arguments, cache_filename, first_values, false);
+
+    //a cache which is cut short is rewritten, even though its stamps match
+    struct stat cache_stat;
+    if (stat(cache_filename.c_str(), &cache_stat) == 0) {
+        if (truncate(cache_filename.c_str(), cache_stat.st_size / 2) != 0) {
+            cout << "\t\tFAILED: could not truncate the cache '" << cache_filename << "'" << endl;
+            failed = true;
+        }
+    }
+    test_load("a truncated cache", load_arguments, cache_filename, first_values, false);
+    test_load("the cache rewritten after truncation", load_arguments, cache_filename, first_values, true);
+
+    remove(csv_filename.c_str());
+    remove(cache_filename.c_str());
+
+    if (!failed) {
+        cout << "ALL PASSED!" << endl;
+    } else {
+        cout << "SOME FAILED!" << endl;
+    }
+
+    return failed ? 1 : 0;
+}
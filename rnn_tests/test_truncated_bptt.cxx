@@ -0,0 +1,161 @@
+#include <algorithm>
+using std::max;
+
+#include <cmath>
+using std::fabs;
+
+#include <iomanip>
+using std::setprecision;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <string>
+using std::string;
+using std::to_string;
+
+#include <vector>
+using std::vector;
+
+#include "common/arguments.hxx"
+
+#include "rnn/generate_nn.hxx"
+#include "rnn/rnn.hxx"
+#include "rnn/rnn_genome.hxx"
+
+#include "time_series/series_view.hxx"
+
+#include "gradient_test.hxx"
+
+bool failed = false;
+
+void generate_series(const vector<int32_t> &lengths, int32_t number_parameters, vector< vector< vector<double> > > &series) {
+    series.assign(lengths.size(), vector< vector<double> >(number_parameters));
+    for (int32_t i = 0; i < (int32_t)lengths.size(); i++) {
+        for (int32_t j = 0; j < number_parameters; j++) generate_random_vector(lengths[i], series[i][j]);
+    }
+}
+
+//the windows sum their values in a different order than the full series
+//does, so only allow for rounding differences
+bool close_enough(double truncated, double full) {
+    return fabs(truncated - full) <= 1e-10 * (1.0 + fabs(full));
+}
+
+void compare_values(string name, const vector<double> &truncated, const vector<double> &full) {
+    for (int32_t i = 0; i < (int32_t)full.size(); i++) {
+        if (!close_enough(truncated[i], full[i])) {
+            cout << "\t\tFAILED " << name << "[" << i << "]: " << setprecision(17) << truncated[i] << " truncated but " << full[i] << " with full backpropagation through time" << endl;
+            failed = true;
+            return;
+        }
+    }
+}
+
+//with a window covering the whole series there is nothing to truncate, so
+//the mses and gradient have to match full backpropagation through time. a
+//shorter window only truncates the gradient, the state is still carried over
+//so the mses have to match as well
+void test_genome(string name, RNN_Genome *genome, const SeriesViews &inputs, const SeriesViews &outputs, int32_t max_length) {
+    cout << "\ttesting " << name << " ... " << endl;
+
+    RNN *rnn = genome->get_rnn();
+
+    vector<double> parameters;
+    generate_random_vector(rnn->get_number_weights(), parameters);
+
+    int32_t number_series = inputs.size();
+    vector<double> full_mses(number_series);
+    vector<double> full_gradient(parameters.size(), 0.0);
+    for (int32_t i = 0; i < number_series; i++) {
+        vector<double> series_gradient;
+        rnn->get_analytic_gradient(parameters, inputs[i], outputs[i], full_mses[i], series_gradient, false, true, 0.0);
+
+        for (int32_t j = 0; j < (int32_t)series_gradient.size(); j++) full_gradient[j] += series_gradient[j];
+    }
+
+    vector<int32_t> windows = {max_length, max_length + 5};
+    for (int32_t i = 0; i < (int32_t)windows.size(); i++) {
+        vector<double> truncated_mses, truncated_gradient;
+        rnn->get_truncated_gradient(parameters, inputs, outputs, 0, number_series, windows[i], windows[i], truncated_mses, truncated_gradient, false, true, 0.0);
+
+        compare_values("mse with window " + to_string(windows[i]), truncated_mses, full_mses);
+        compare_values("gradient with window " + to_string(windows[i]), truncated_gradient, full_gradient);
+    }
+
+    if (max_length > 4) {
+        vector<double> truncated_mses, truncated_gradient;
+        rnn->get_truncated_gradient(parameters, inputs, outputs, 0, number_series, 4, 3, truncated_mses, truncated_gradient, false, true, 0.0);
+
+        compare_values("mse with window 4 and stride 3", truncated_mses, full_mses);
+    }
+
+    //validation with truncated bptt runs the series a window at a time
+    vector<int32_t> error_windows = {4, max_length, max_length + 5};
+    for (int32_t i = 0; i < (int32_t)error_windows.size(); i++) {
+        vector<double> windowed_mses(number_series), windowed_maes(number_series), full_maes(number_series);
+        for (int32_t j = 0; j < number_series; j++) {
+            rnn->get_windowed_errors(inputs[j], outputs[j], error_windows[i], windowed_mses[j], windowed_maes[j], false, false, 0.0);
+            full_maes[j] = rnn->prediction_mae(inputs[j], outputs[j], false, false, 0.0);
+        }
+
+        compare_values("windowed mse with window " + to_string(error_windows[i]), windowed_mses, full_mses);
+        compare_values("windowed mae with window " + to_string(error_windows[i]), windowed_maes, full_maes);
+    }
+
+    delete rnn;
+}
+
+int main(int argc, char **argv) {
+    vector<string> arguments = vector<string>(argv, argv + argc);
+
+    initialize_generator();
+
+    cout << "TESTING TRUNCATED BPTT" << endl;
+
+    int32_t number_inputs = 3;
+    int32_t number_outputs = 2;
+    int32_t max_recurrent_depth = 3;
+
+    vector<string> names = {"FF", "ELMAN", "LSTM", "GRU", "MGU", "UGRNN", "DELTA"};
+    vector< vector<int32_t> > series_lengths = {{1}, {10}, {37}, {10, 25, 4}};
+
+    for (int32_t i = 0; i < (int32_t)series_lengths.size(); i++) {
+        vector< vector< vector<double> > > inputs, outputs;
+        generate_series(series_lengths[i], number_inputs, inputs);
+        generate_series(series_lengths[i], number_outputs, outputs);
+        SeriesViews input_views(inputs), output_views(outputs);
+
+        int32_t max_length = 0;
+        string lengths;
+        for (int32_t j = 0; j < (int32_t)series_lengths[i].size(); j++) {
+            max_length = max(max_length, series_lengths[i][j]);
+            lengths += (j == 0 ? "" : ",") + to_string(series_lengths[i][j]);
+        }
+
+        cout << "\tseries lengths: " << lengths << endl;
+
+        for (int32_t j = 0; j < (int32_t)names.size(); j++) {
+            RNN_Genome *genome = NULL;
+            if (names[j] == "FF") genome = create_ff(number_inputs, 2, 3, number_outputs, max_recurrent_depth);
+            else if (names[j] == "ELMAN") genome = create_elman(number_inputs, 2, 3, number_outputs, max_recurrent_depth);
+            else if (names[j] == "LSTM") genome = create_lstm(number_inputs, 2, 3, number_outputs, max_recurrent_depth);
+            else if (names[j] == "GRU") genome = create_gru(number_inputs, 2, 3, number_outputs, max_recurrent_depth);
+            else if (names[j] == "MGU") genome = create_mgu(number_inputs, 2, 3, number_outputs, max_recurrent_depth);
+            else if (names[j] == "UGRNN") genome = create_ugrnn(number_inputs, 2, 3, number_outputs, max_recurrent_depth);
+            else genome = create_delta(number_inputs, 2, 3, number_outputs, max_recurrent_depth);
+
+            test_genome(names[j], genome, input_views, output_views, max_length);
+            delete genome;
+        }
+    }
+
+    if (!failed) {
+        cout << "ALL PASSED!" << endl;
+    } else {
+        cout << "SOME FAILED!" << endl;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+#ifndef EXAMM_SERIES_VIEW_HXX
+#define EXAMM_SERIES_VIEW_HXX
+
+#include <cstdint>
+
+#include <vector>
+using std::vector;
+
+//for madvise
+#include <sys/mman.h>
+#include <unistd.h>
+
+//the values of one parameter of a series. values which were memory mapped
+//(see --stream_time_series) are normalized as they are read, so the mapped
+//file is never written to; otherwise offset and range are 0 and 1, which
+//leaves the values unchanged.
+class SeriesColumn {
+    private:
+        const double *values;
+        double offset;
+        //1 / range, so reading a value doesn't need a division
+        double scale;
+        //offset and range are 0 and 1, so the values are read as they are
+        bool unchanged;
+        bool mapped;
+
+    public:
+        SeriesColumn(const double *_values, double _offset = 0.0, double _range = 1.0, bool _mapped = false) : values(_values), offset(_offset), scale(1.0 / _range), unchanged(_offset == 0.0 && _range == 1.0), mapped(_mapped) {
+        }
+
+        double operator[](int32_t time) const {
+            if (unchanged) return values[time];
+            return (values[time] - offset) * scale;
+        }
+
+        //asks the OS to start reading the pages of a mapped column in, so
+        //they are (hopefully) there by the time they are used
+        void will_need(int32_t length) const {
+            if (!mapped || length <= 0) return;
+
+            uintptr_t page_size = sysconf(_SC_PAGESIZE);
+            uintptr_t start = (uintptr_t)values & ~(page_size - 1);
+            uintptr_t end = (uintptr_t)(values + length);
+            madvise((void*)start, end - start, MADV_WILLNEED);
+        }
+};
+
+//one series, as the columns for each of its parameters. it points into
+//values stored elsewhere (the loaded time series, or exported vectors)
+//instead of holding a copy, so they have to outlive the view.
+class SeriesView {
+    private:
+        vector<SeriesColumn> parameters;
+        int32_t length;
+
+    public:
+        SeriesView() : length(0) {
+        }
+
+        SeriesView(const vector< vector<double> > &series) : length(0) {
+            if (series.size() > 0) length = series[0].size();
+
+            for (int32_t i = 0; i < (int32_t)series.size(); i++) {
+                parameters.push_back(SeriesColumn(series[i].data()));
+            }
+        }
+
+        SeriesView(const vector<SeriesColumn> &_parameters, int32_t _length) : parameters(_parameters), length(_length) {
+        }
+
+        //the number of parameters
+        int32_t size() const {
+            return parameters.size();
+        }
+
+        //the number of values each parameter has
+        int32_t get_length() const {
+            return length;
+        }
+
+        const SeriesColumn& operator[](int32_t parameter) const {
+            return parameters[parameter];
+        }
+
+        void will_need() const {
+            for (int32_t i = 0; i < (int32_t)parameters.size(); i++) {
+                parameters[i].will_need(length);
+            }
+        }
+};
+
+//a set of series, which can be made from the nested vectors the series are
+//exported to (so code passing those doesn't change) or from series views
+class SeriesViews {
+    private:
+        vector<SeriesView> series;
+
+    public:
+        SeriesViews() {
+        }
+
+        SeriesViews(const vector< vector< vector<double> > > &_series) {
+            for (int32_t i = 0; i < (int32_t)_series.size(); i++) {
+                series.push_back(SeriesView(_series[i]));
+            }
+        }
+
+        void add(const SeriesView &view) {
+            series.push_back(view);
+        }
+
+        void clear() {
+            series.clear();
+        }
+
+        int32_t size() const {
+            return series.size();
+        }
+
+        const SeriesView& operator[](int32_t i) const {
+            return series[i];
+        }
+};
+
+#endif
@@ -1,10 +1,21 @@
+#include <cerrno>
 #include <cmath>
+#include <cstring>
 
 #include <algorithm>
 using std::find;
+using std::max;
+using std::min;
+
+#include <charconv>
+using std::from_chars;
+
+#include <cstdio>
 
 #include <fstream>
 using std::ifstream;
+using std::ofstream;
+using std::ios;
 
 #include <iomanip>
 using std::setw;
@@ -13,6 +24,7 @@ using std::setw;
 using std::cout;
 using std::cerr;
 using std::endl;
+using std::istream;
 using std::ostream;
 
 #include <limits>
@@ -21,20 +33,27 @@ using std::numeric_limits;
 #include <sstream>
 using std::stringstream;
 
-#include <stdexcept>
-using std::invalid_argument;
-
 #include <string>
 using std::string;
 
+#include <system_error>
+using std::errc;
+
 #include <vector>
 using std::vector;
 
+//for mmap
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "common/arguments.hxx"
+#include "common/thread_pool.hxx"
 
 #include "time_series.hxx"
 
-TimeSeries::TimeSeries(string _name) {
+TimeSeries::TimeSeries(string _name) : mapped_values(NULL), number_mapped_values(0), mapped_offset(0.0), mapped_range(1.0) {
     name = _name;
 }
 
@@ -42,7 +61,12 @@ void TimeSeries::add_value(double value) {
     values.push_back(value);
 }
 
+void TimeSeries::reserve(int32_t number_values) {
+    values.reserve(number_values);
+}
+
 double TimeSeries::get_value(int i) {
+    if (mapped_values != NULL) return (mapped_values[i] - mapped_offset) / mapped_range;
     return values[i];
 }
 
@@ -56,28 +80,52 @@ void TimeSeries::calculate_statistics() {
     std_dev = 0.0;
     variance = 0.0;
 
-    for (uint32_t i = 0; i < values.size(); i++) {
-        average += values[i];
+    //a single pass over the values, a block at a time. the mean and sum of
+    //squared differences from it are found for each block while it is in
+    //cache, and merged into the totals as welford's method does for single
+    //values (without needing a division for every value). this way a
+    //streamed series is only read from disk once.
+    const int32_t block_size = 256;
+    double block[block_size];
+
+    int32_t number_values = get_number_values();
+    double previous = 0.0;
+    double squared_differences = 0.0;
 
-        if (min > values[i]) min = values[i];
-        if (max < values[i]) max = values[i];
+    for (int32_t start = 0; start < number_values; start += block_size) {
+        int32_t block_length = std::min(block_size, number_values - start);
 
-        if (i > 0) {
-            double diff = values[i] - values[i-1];
+        double block_sum = 0.0;
+        for (int32_t i = 0; i < block_length; i++) {
+            double value = get_value(start + i);
+            block[i] = value;
+            block_sum += value;
 
-            if (diff < min_change) min_change = diff;
-            if (diff > max_change) max_change = diff;
+            if (min > value) min = value;
+            if (max < value) max = value;
+
+            if (start + i > 0) {
+                double diff = value - previous;
+
+                if (diff < min_change) min_change = diff;
+                if (diff > max_change) max_change = diff;
+            }
+            previous = value;
         }
-    }
 
-    average /= values.size();
+        double block_average = block_sum / block_length;
+        double block_squared_differences = 0.0;
+        for (int32_t i = 0; i < block_length; i++) {
+            double difference = block[i] - block_average;
+            block_squared_differences += difference * difference;
+        }
 
-    for (uint32_t i = 0; i < values.size(); i++) {
-        double diff = values[i] - average;
-        variance += diff * diff;
+        double difference = block_average - average;
+        average += difference * ((double)block_length / (start + block_length));
+        squared_differences += block_squared_differences + difference * difference * ((double)start * block_length / (start + block_length));
     }
-    variance /= values.size() - 1;
 
+    variance = squared_differences / (number_values - 1);
     std_dev = sqrt(variance);
 }
 
@@ -93,6 +141,7 @@ void TimeSeries::print_statistics(ostream &out) {
 }
 
 int TimeSeries::get_number_values() const {
+    if (mapped_values != NULL) return number_mapped_values;
     return values.size();
 }
 
@@ -126,20 +175,31 @@ double TimeSeries::get_max_change() const {
 
 void TimeSeries::normalize_min_max(double min, double max, bool verbose) {
     if (verbose) cout << "normalizing time series '" << name << "' with min: " << min << " and " << max << ", series min: " << this->min << ", series max: " << this->max << endl;
-    for (int i = 0; i < values.size(); i++) {
-        if (values[i] < min) {
-            cout << "WARNING: normalizing series " << name << ", value[" << i << "] " << values[i] << " was less than min for normalization:" << min << endl;
-        }
 
-        if (values[i] > max) {
-            cout << "WARNING: normalizing series " << name << ", value[" << i << "] " << values[i] << " was greater than max for normalization:" << max << endl;
-        }
+    if (mapped_values != NULL) {
+        mapped_offset += min * mapped_range;
+        mapped_range *= max - min;
+        return;
+    }
 
-        values[i] = (values[i] - min) / (max - min);
+    //values outside of the bounds are found from the statistics (by
+    //TimeSeriesSets) so nothing keeps this loop from being vectorized
+    double range = max - min;
+    double *series_values = values.data();
+    int32_t number_values = values.size();
+    for (int32_t i = 0; i < number_values; i++) {
+        series_values[i] = (series_values[i] - min) / range;
     }
 }
 
 void TimeSeries::cut(int32_t start, int32_t stop) {
+    if (mapped_values != NULL) {
+        mapped_values += start;
+        number_mapped_values = stop - start;
+        calculate_statistics();
+        return;
+    }
+
     auto first = values.begin() + start;
     auto last = values.begin() + stop;
     values = vector<double>(first, last);
@@ -148,7 +208,7 @@ void TimeSeries::cut(int32_t start, int32_t stop) {
     calculate_statistics();
 }
 
-TimeSeries::TimeSeries() {
+TimeSeries::TimeSeries() : mapped_values(NULL), number_mapped_values(0), mapped_offset(0.0), mapped_range(1.0) {
 }
 
 TimeSeries* TimeSeries::copy() {
@@ -165,13 +225,155 @@ TimeSeries* TimeSeries::copy() {
 
     ts->values = values;
 
+    ts->mapped_values = mapped_values;
+    ts->number_mapped_values = number_mapped_values;
+    ts->mapped_offset = mapped_offset;
+    ts->mapped_range = mapped_range;
+
     return ts;
 }
 
+SeriesColumn TimeSeries::get_column(int32_t start) const {
+    if (mapped_values != NULL) return SeriesColumn(mapped_values + start, mapped_offset, mapped_range, true);
+    return SeriesColumn(values.data() + start);
+}
+
 void TimeSeries::copy_values(vector<double> &series) {
+    if (mapped_values != NULL) {
+        series.resize(number_mapped_values);
+        for (int32_t i = 0; i < number_mapped_values; i++) {
+            series[i] = get_value(i);
+        }
+        return;
+    }
+
     series = values;
 }
 
+static void write_binary_string(ostream &out, const string &s) {
+    int32_t length = s.size();
+    out.write((char*)&length, sizeof(int32_t));
+    out.write(s.c_str(), length);
+}
+
+static void read_binary_string(istream &in, string &s) {
+    int32_t length = 0;
+    in.read((char*)&length, sizeof(int32_t));
+    s.resize(length);
+    in.read(&s[0], length);
+}
+
+static void write_binary_strings(ostream &out, const vector<string> &strings) {
+    int32_t number_strings = strings.size();
+    out.write((char*)&number_strings, sizeof(int32_t));
+    for (int32_t i = 0; i < number_strings; i++) {
+        write_binary_string(out, strings[i]);
+    }
+}
+
+static void read_binary_strings(istream &in, vector<string> &strings) {
+    int32_t number_strings = 0;
+    in.read((char*)&number_strings, sizeof(int32_t));
+    strings.resize(number_strings);
+    for (int32_t i = 0; i < number_strings; i++) {
+        read_binary_string(in, strings[i]);
+    }
+}
+
+static void write_binary_bounds(ostream &out, const map<string,double> &bounds) {
+    int32_t number_bounds = bounds.size();
+    out.write((char*)&number_bounds, sizeof(int32_t));
+    for (auto bound = bounds.begin(); bound != bounds.end(); bound++) {
+        write_binary_string(out, bound->first);
+        out.write((char*)&bound->second, sizeof(double));
+    }
+}
+
+static void read_binary_bounds(istream &in, map<string,double> &bounds) {
+    int32_t number_bounds = 0;
+    in.read((char*)&number_bounds, sizeof(int32_t));
+    bounds.clear();
+    for (int32_t i = 0; i < number_bounds; i++) {
+        string name;
+        read_binary_string(in, name);
+        in.read((char*)&bounds[name], sizeof(double));
+    }
+}
+
+static void write_binary_indexes(ostream &out, const vector<int> &indexes) {
+    int32_t number_indexes = indexes.size();
+    out.write((char*)&number_indexes, sizeof(int32_t));
+    out.write((char*)indexes.data(), number_indexes * sizeof(int));
+}
+
+static void read_binary_indexes(istream &in, vector<int> &indexes) {
+    int32_t number_indexes = 0;
+    in.read((char*)&number_indexes, sizeof(int32_t));
+    indexes.resize(number_indexes);
+    in.read((char*)indexes.data(), number_indexes * sizeof(int));
+}
+
+//the number of bytes needed after position for the next value to start at a
+//multiple of sizeof(double)
+static int32_t get_alignment_padding(int64_t position) {
+    return (sizeof(double) - (position % sizeof(double))) % sizeof(double);
+}
+
+TimeSeries::TimeSeries(istream &in, bool aligned, const char *mapped) : mapped_values(NULL), number_mapped_values(0), mapped_offset(0.0), mapped_range(1.0) {
+    read_binary_string(in, name);
+
+    in.read((char*)&min, sizeof(double));
+    in.read((char*)&average, sizeof(double));
+    in.read((char*)&max, sizeof(double));
+    in.read((char*)&std_dev, sizeof(double));
+    in.read((char*)&variance, sizeof(double));
+    in.read((char*)&min_change, sizeof(double));
+    in.read((char*)&max_change, sizeof(double));
+
+    int32_t number_values = 0;
+    in.read((char*)&number_values, sizeof(int32_t));
+
+    if (aligned) in.seekg(get_alignment_padding(in.tellg()), ios::cur);
+
+    if (mapped != NULL) {
+        mapped_values = (const double*)(mapped + in.tellg());
+        number_mapped_values = number_values;
+        in.seekg(number_values * sizeof(double), ios::cur);
+    } else {
+        values.resize(number_values);
+        in.read((char*)values.data(), number_values * sizeof(double));
+    }
+}
+
+void TimeSeries::write_to_stream(ostream &out, bool aligned) {
+    write_binary_string(out, name);
+
+    out.write((char*)&min, sizeof(double));
+    out.write((char*)&average, sizeof(double));
+    out.write((char*)&max, sizeof(double));
+    out.write((char*)&std_dev, sizeof(double));
+    out.write((char*)&variance, sizeof(double));
+    out.write((char*)&min_change, sizeof(double));
+    out.write((char*)&max_change, sizeof(double));
+
+    int32_t number_values = get_number_values();
+    out.write((char*)&number_values, sizeof(int32_t));
+
+    if (aligned) {
+        const char padding[sizeof(double)] = {0};
+        out.write(padding, get_alignment_padding(out.tellp()));
+    }
+
+    if (mapped_values != NULL) {
+        for (int32_t i = 0; i < number_values; i++) {
+            double value = get_value(i);
+            out.write((char*)&value, sizeof(double));
+        }
+    } else {
+        out.write((char*)values.data(), number_values * sizeof(double));
+    }
+}
+
 
 void string_split(const string &s, char delim, vector<string> &result) {
     stringstream ss;
@@ -191,21 +393,37 @@ void TimeSeriesSet::add_time_series(string name) {
     }
 }
 
+//the file is mapped into memory and parsed in place, with the series each
+//column goes to looked up once from the header
 TimeSeriesSet::TimeSeriesSet(string _filename, const vector<string> &_fields) {
     filename = _filename;
     fields = _fields;
 
-    ifstream ts_file(filename);
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat file_stat;
+    if (fd < 0 || fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        cerr << "ERROR! Could not get headers from the CSV file. File potentially empty!" << endl;
+        exit(1);
+    }
 
-    string line;
+    size_t length = file_stat.st_size;
+    const char *data = (const char*)mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
 
-    if (!getline(ts_file, line)) {
-        cerr << "ERROR! Could not get headers from the CSV file. File potentially empty!" << endl;
+    if (data == MAP_FAILED) {
+        cerr << "ERROR! Could not read the CSV file '" << filename << "': " << strerror(errno) << endl;
         exit(1);
     }
+    const char *data_end = data + length;
+
+    const char *header_end = (const char*)memchr(data, '\n', length);
+    if (header_end == NULL) header_end = data_end;
+
+    string header(data, header_end - data);
+    if (header.size() > 0 && header.back() == '\r') header.pop_back();
 
     vector<string> file_fields;
-    string_split(line, ',', file_fields);
+    string_split(header, ',', file_fields);
 
     //check to see that all the specified fields are in the file
     for (int32_t i = 0; i < (int32_t)fields.size(); i++) {
@@ -220,13 +438,10 @@ TimeSeriesSet::TimeSeriesSet(string _filename, const vector<string> &_fields) {
         }
      }
 
-    //specify which of the file fields (columns) are used
-    vector<bool> file_fields_used(true, file_fields.size());
-    for (int32_t i = 0; i < (int32_t)file_fields.size(); i++) {
-        if (find(fields.begin(), fields.end(), file_fields[i]) == fields.end()) {
-            //the ith file field wasn't found in the specified fields
-            file_fields_used[i] = false;
-        }
+    //every line after the header is at most one row
+    int32_t max_rows = 0;
+    for (const char *c = header_end; c < data_end; c++) {
+        if (*c == '\n') max_rows++;
     }
 
     //cout << "number fields: " << fields.size() << endl;
@@ -234,38 +449,62 @@ TimeSeriesSet::TimeSeriesSet(string _filename, const vector<string> &_fields) {
         //cout << "\t" << fields[i] << endl;
 
         add_time_series(fields[i]);
+        time_series[fields[i]]->reserve(max_rows + 1);
+    }
+
+    //the series for each of the file fields (columns), or NULL if it isn't used
+    vector<TimeSeries*> column_series(file_fields.size(), NULL);
+    for (int32_t i = 0; i < (int32_t)file_fields.size(); i++) {
+        if (time_series.count(file_fields[i]) > 0) column_series[i] = time_series[file_fields[i]];
     }
 
     int row = 1;
     //cout << "values:" << endl;
-    while (getline(ts_file, line)) {
-        if (line.size() == 0 || line[0] == '#' || row < 0) {
-            row++;
+    for (const char *line = header_end + 1; line < data_end; row++) {
+        const char *line_end = (const char*)memchr(line, '\n', data_end - line);
+        if (line_end == NULL) line_end = data_end;
+
+        const char *next_line = line_end + 1;
+        if (line_end > line && *(line_end - 1) == '\r') line_end--;
+
+        if (line == line_end || line[0] == '#') {
+            line = next_line;
             continue;
         }
 
-        vector<string> parts;
-        string_split(line, ',', parts);
+        //like string_split, a trailing comma doesn't start another value
+        int32_t column = 0;
+        for (const char *value = line; value < line_end; column++) {
+            const char *value_end = (const char*)memchr(value, ',', line_end - value);
+            if (value_end == NULL) value_end = line_end;
+
+            if (column < (int32_t)column_series.size() && column_series[column] != NULL) {
+                const char *number = value;
+                while (number < value_end && (*number == ' ' || *number == '\t')) number++;
+                if (number < value_end && *number == '+') number++;
+
+                double parsed;
+                auto result = from_chars(number, value_end, parsed);
+                if (result.ec == errc()) {
+                    column_series[column]->add_value(parsed);
+                } else {
+                    cerr << "file: '" << filename << "' -- invalid value on row " << row << " and column " << column << ": '" << file_fields[column] << "', value: '" << string(value, value_end - value) << "'" << endl;
+                }
+            }
 
-        if (parts.size() != file_fields.size()) {
-            cerr << "ERROR! number of values in row " << row << " was " << parts.size() << ", but there were " << file_fields.size() << " fields in the header." << endl;
-            exit(1);
+            value = value_end + 1;
         }
 
-        for (uint32_t i = 0; i < parts.size(); i++) {
-            if (!file_fields_used[i]) continue;
-
-            //cout << "parts[" << i << "]: " << parts[i] << endl;
-            try {
-                time_series[ file_fields[i] ]->add_value( stod(parts[i]) );
-            } catch (const invalid_argument& ia) {
-                cerr << "file: '" << filename << "' -- invalid argument: '" << ia.what() << "' on row " << row << " and column " << i << ": '" << file_fields[i] << "', value: '" << parts[i] << "'" << endl;
-            }
+        if (column != (int32_t)file_fields.size()) {
+            cerr << "ERROR! number of values in row " << row << " was " << column << ", but there were " << file_fields.size() << " fields in the header." << endl;
+            exit(1);
         }
 
-        row++;
+        line = next_line;
     }
 
+    munmap((void*)data, length);
+
     number_rows = time_series.begin()->second->get_number_values();
 
     for (auto series = time_series.begin(); series != time_series.end(); series++) {
@@ -339,7 +578,7 @@ double TimeSeriesSet::get_max_change(string field) {
 }
 
 void TimeSeriesSet::normalize_min_max(string field, double min, double max, bool verbose) {
-    time_series[field]->normalize_min_max(min, max, verbose);
+    time_series.at(field)->normalize_min_max(min, max, verbose);
 }
 
 
@@ -383,6 +622,16 @@ void TimeSeriesSet::export_time_series(vector< vector<double> > &data, const vec
     }
 }
 
+SeriesView TimeSeriesSet::get_view(const vector<string> &requested_fields, int32_t time_offset) {
+    //inputs (a negative offset) ignore the last N values, outputs the first N
+    vector<SeriesColumn> parameters;
+    for (int32_t i = 0; i < (int32_t)requested_fields.size(); i++) {
+        parameters.push_back( time_series[ requested_fields[i] ]->get_column(time_offset > 0 ? time_offset : 0) );
+    }
+
+    return SeriesView(parameters, number_rows - abs(time_offset));
+}
+
 void TimeSeriesSet::export_time_series(vector< vector<double> > &data, const vector<string> &requested_fields) {
     export_time_series(data, requested_fields, 0);
 }
@@ -394,6 +643,12 @@ void TimeSeriesSet::export_time_series(vector< vector<double> > &data) {
 TimeSeriesSet::TimeSeriesSet() {
 }
 
+TimeSeriesSet::~TimeSeriesSet() {
+    for (auto series = time_series.begin(); series != time_series.end(); series++) {
+        delete series->second;
+    }
+}
+
 TimeSeriesSet* TimeSeriesSet::copy() {
     TimeSeriesSet *tss = new TimeSeriesSet();
 
@@ -408,6 +663,33 @@ TimeSeriesSet* TimeSeriesSet::copy() {
     return tss;
 }
 
+TimeSeriesSet::TimeSeriesSet(istream &in, bool aligned, const char *mapped) {
+    in.read((char*)&number_rows, sizeof(int));
+    read_binary_string(in, filename);
+    read_binary_strings(in, fields);
+
+    int32_t number_series = 0;
+    in.read((char*)&number_series, sizeof(int32_t));
+    for (int32_t i = 0; i < number_series; i++) {
+        string series_name;
+        read_binary_string(in, series_name);
+        time_series[series_name] = new TimeSeries(in, aligned, mapped);
+    }
+}
+
+void TimeSeriesSet::write_to_stream(ostream &out, bool aligned) {
+    out.write((char*)&number_rows, sizeof(int));
+    write_binary_string(out, filename);
+    write_binary_strings(out, fields);
+
+    int32_t number_series = time_series.size();
+    out.write((char*)&number_series, sizeof(int32_t));
+    for (auto series = time_series.begin(); series != time_series.end(); series++) {
+        write_binary_string(out, series->first);
+        series->second->write_to_stream(out, aligned);
+    }
+}
+
 void TimeSeriesSet::cut(int32_t start, int32_t stop) {
     for (auto series = time_series.begin(); series != time_series.end(); series++) {
         series->second->cut(start, stop);
@@ -478,11 +760,20 @@ void TimeSeriesSets::help_message() {
     cerr << "\t\t\t\t'b' denoting the parameter as having user specified bounds, if this is specified the following two values should be the min and max bounds for the parameter." << endl;
     cerr << "\t\t\t\tThe settings string requires at one of 'i' or 'o'." << endl;
 
+    cerr << "\tCaching:" << endl;
+    cerr << "\t\t--training_cache <filename> : a binary copy of the loaded files, which is read instead of the CSV files if they haven't changed since it was written, and (re)written otherwise." << endl;
+    cerr << "\t\t--stream_time_series : (requires --training_cache) memory map the cache instead of reading it, so only the parts of the series being trained on are read from disk and the time series can be larger than the available memory." << endl;
+
     cerr << "\tNormalization:" << endl;
     cerr << "\t\t--normalize : normalize the data. data will be normalized between user specified bounds if given, otherwise the min and max values for a parameter will be calculated over all input files." << endl;
+    cerr << "\t\t--normalize_type <min_max|z_score> : (default min_max) with z_score, parameters without user specified bounds have their mean over all input files subtracted and are divided by their standard deviation. the mean and the mean plus the standard deviation are used as the min and max bounds, so these are what is saved with the genomes." << endl;
 }
 
-TimeSeriesSets::TimeSeriesSets() : normalized(false) {
+TimeSeriesSets::TimeSeriesSets() : normalized(false), normalize_type("min_max"), mapped_cache(NULL), mapped_cache_length(0) {
+}
+
+TimeSeriesSets::~TimeSeriesSets() {
+    if (mapped_cache != NULL) munmap((void*)mapped_cache, mapped_cache_length);
 }
 
 void merge_parameter_names(const vector<string> &input_parameter_names, const vector<string> &output_parameter_names, vector<string> &all_parameter_names) {
@@ -569,11 +860,16 @@ void TimeSeriesSets::load_time_series(bool verbose) {
 
     for (uint32_t i = 0; i < filenames.size(); i++) {
         if (verbose) cout << "\t" << filenames[i] << endl;
+    }
 
-        TimeSeriesSet *ts = new TimeSeriesSet(filenames[i], all_parameter_names);
-        time_series.push_back( ts );
+    //the files are parsed in parallel on the shared pool
+    time_series.assign(filenames.size(), NULL);
+    ThreadPool::get_shared()->parallel_for(filenames.size(), [this](int32_t i) {
+        time_series[i] = new TimeSeriesSet(filenames[i], all_parameter_names);
+    });
 
-        rows += ts->get_number_rows();
+    for (uint32_t i = 0; i < time_series.size(); i++) {
+        rows += time_series[i]->get_number_rows();
     }
     if (verbose) cout << "number of time series files: " << filenames.size() << ", total rows: " << rows << endl;
 }
@@ -656,10 +952,39 @@ TimeSeriesSets* TimeSeriesSets::generate_from_arguments(const vector<string> &ar
     }
 
 
-    tss->load_time_series(verbose);
+    string cache_filename;
+    bool stream = argument_exists(arguments, "--stream_time_series");
+    if (get_argument(arguments, "--training_cache", false, cache_filename)) {
+        if (!tss->read_cache(cache_filename, stream, verbose)) {
+            if (stream) {
+                //the files are only loaded one at a time to write the cache
+                tss->write_cache(cache_filename);
+                if (!tss->read_cache(cache_filename, stream, verbose)) {
+                    cerr << "ERROR: could not stream the time series from cache '" << cache_filename << "' after writing it" << endl;
+                    exit(1);
+                }
+            } else {
+                tss->load_time_series(verbose);
+                tss->write_cache(cache_filename);
+            }
+        }
+    } else if (stream) {
+        cerr << "ERROR: --stream_time_series requires a --training_cache to stream the time series from." << endl << endl;
+        help_message();
+        exit(1);
+    } else {
+        tss->load_time_series(verbose);
+    }
 
     bool _normalize = argument_exists(arguments, "--normalize");
 
+    get_argument(arguments, "--normalize_type", false, tss->normalize_type);
+    if (tss->normalize_type != "min_max" && tss->normalize_type != "z_score") {
+        cerr << "ERROR: unknown --normalize_type '" << tss->normalize_type << "', it should be 'min_max' or 'z_score'." << endl << endl;
+        help_message();
+        exit(1);
+    }
+
     if (_normalize) {
         tss->normalized = true;
 
@@ -696,25 +1021,80 @@ TimeSeriesSets* TimeSeriesSets::generate_test(const vector<string> &_test_filena
     return tss;
 }
 
+//warns about any of the series with values outside the bounds they will be
+//normalized with (from the series statistics, so nothing is read again)
+void TimeSeriesSets::check_bounds(string field) {
+    double min = normalize_mins[field];
+    double max = normalize_maxs[field];
+
+    for (int32_t i = 0; i < (int32_t)time_series.size(); i++) {
+        if (time_series[i]->get_min(field) < min) {
+            cout << "WARNING: normalizing series " << field << " of '" << time_series[i]->get_filename() << "', series min " << time_series[i]->get_min(field) << " was less than min for normalization:" << min << endl;
+        }
+
+        if (time_series[i]->get_max(field) > max) {
+            cout << "WARNING: normalizing series " << field << " of '" << time_series[i]->get_filename() << "', series max " << time_series[i]->get_max(field) << " was greater than max for normalization:" << max << endl;
+        }
+    }
+}
+
+//normalizes every parameter of every set with normalize_mins and
+//normalize_maxs, with each of them done in parallel
+void TimeSeriesSets::normalize_series() {
+    int32_t number_parameters = all_parameter_names.size();
+    vector<double> mins, maxs;
+    for (int32_t i = 0; i < number_parameters; i++) {
+        mins.push_back(normalize_mins[all_parameter_names[i]]);
+        maxs.push_back(normalize_maxs[all_parameter_names[i]]);
+    }
+
+    ThreadPool::get_shared()->parallel_for(time_series.size() * number_parameters, [&](int32_t task) {
+        int32_t parameter = task % number_parameters;
+        time_series[task / number_parameters]->normalize_min_max(all_parameter_names[parameter], mins[parameter], maxs[parameter], false);
+    });
+}
+
 void TimeSeriesSets::normalize(bool verbose) {
-    if (verbose) cout << "normalizing:" << endl;
+    if (verbose) cout << "normalizing (" << normalize_type << "):" << endl;
 
     for (int i = 0; i < all_parameter_names.size(); i++) {
         string parameter_name = all_parameter_names[i];
 
-        double min = numeric_limits<double>::max();
-        double max = -numeric_limits<double>::max();
+        if (normalize_mins.count(parameter_name) > 0) {
+            if (verbose) cout << "user specified bounds for " << setw(30) << parameter_name << ", min: " << setw(12) << normalize_mins[parameter_name] << ", max: " << setw(12) << normalize_maxs[parameter_name] << endl;
+            check_bounds(parameter_name);
+
+        } else if (normalize_type == "z_score") {
+            //the mean and variance over all series of the same name, merged
+            //from each series' mean and variance
+            double count = 0.0;
+            double average = 0.0;
+            double squared_differences = 0.0;
+
+            for (int j = 0; j < (int32_t)time_series.size(); j++) {
+                double series_count = time_series[j]->get_number_rows();
+                double difference = time_series[j]->get_average(parameter_name) - average;
+                double total = count + series_count;
+
+                average += difference * (series_count / total);
+                squared_differences += time_series[j]->get_variance(parameter_name) * (series_count - 1) + difference * difference * (count * series_count / total);
+                count = total;
+            }
+            double std_dev = sqrt(squared_differences / (count - 1));
 
-        //get the min of all series of the same name
-        //get the max of all series of the same name
+            //normalizing between the mean and one standard deviation above it
+            //gives the z-scores, and they can be passed on as any other bounds
+            normalize_mins[parameter_name] = average;
+            normalize_maxs[parameter_name] = average + std_dev;
 
-        if (normalize_mins.count(parameter_name) > 0) {
-            min = normalize_mins[parameter_name];
-            max = normalize_maxs[parameter_name];
+            if (verbose) cout << "calculated z-score for    " << setw(30) << parameter_name << ", avg: " << setw(12) << average << ", std_dev: " << setw(12) << std_dev << endl;
 
-            if (verbose) cout << "user specified bounds for ";
+        } else {
+            //get the min of all series of the same name
+            //get the max of all series of the same name
+            double min = numeric_limits<double>::max();
+            double max = -numeric_limits<double>::max();
 
-        }  else {
             for (int j = 0; j < time_series.size(); j++) {
                 double current_min = time_series[j]->get_min(parameter_name);
                 double current_max = time_series[j]->get_max(parameter_name);
@@ -726,16 +1106,12 @@ void TimeSeriesSets::normalize(bool verbose) {
             normalize_mins[parameter_name] = min;
             normalize_maxs[parameter_name] = max;
 
-            if (verbose) cout << "calculated bounds for     ";
-        }
-
-        if (verbose) cout << setw(30) << parameter_name << ", min: " << setw(12) << min << ", max: " << setw(12) << max << endl;
-
-        //for each series, subtract min, divide by (max - min)
-        for (int j = 0; j < time_series.size(); j++) {
-            time_series[j]->normalize_min_max(parameter_name, min, max, false);
+            if (verbose) cout << "calculated bounds for     " << setw(30) << parameter_name << ", min: " << setw(12) << min << ", max: " << setw(12) << max << endl;
         }
     }
+
+    //for each series, subtract min, divide by (max - min)
+    normalize_series();
 }
 
 void TimeSeriesSets::normalize(const map<string,double> &_normalize_mins, const map<string,double> &_normalize_maxs, bool verbose) {
@@ -765,12 +1141,12 @@ void TimeSeriesSets::normalize(const map<string,double> &_normalize_mins, const
             exit(1);
         }
 
-        //for each series, subtract min, divide by (max - min)
-        for (int j = 0; j < time_series.size(); j++) {
-            time_series[j]->normalize_min_max(field, normalize_mins[field], normalize_maxs[field], false);
-        }
+        check_bounds(field);
     }
 
+    //for each series, subtract min, divide by (max - min)
+    normalize_series();
+
     normalized = true;
 }
 
@@ -815,6 +1191,36 @@ void TimeSeriesSets::export_test_series(int time_offset, vector< vector< vector<
 }
 
 
+void TimeSeriesSets::export_time_series(const vector<int> &series_indexes, int time_offset, SeriesViews &inputs, SeriesViews &outputs) {
+    inputs.clear();
+    outputs.clear();
+
+    for (uint32_t i = 0; i < series_indexes.size(); i++) {
+        int series_index = series_indexes[i];
+
+        inputs.add( time_series[series_index]->get_view(input_parameter_names, -time_offset) );
+        outputs.add( time_series[series_index]->get_view(output_parameter_names, time_offset) );
+    }
+}
+
+void TimeSeriesSets::export_training_series(int time_offset, SeriesViews &inputs, SeriesViews &outputs) {
+    if (training_indexes.size() == 0) {
+        cerr << "ERROR: attempting to export training time series, however the training_indexes were not specified." << endl;
+        exit(1);
+    }
+
+    export_time_series(training_indexes, time_offset, inputs, outputs);
+}
+
+void TimeSeriesSets::export_test_series(int time_offset, SeriesViews &inputs, SeriesViews &outputs) {
+    if (test_indexes.size() == 0) {
+        cerr << "ERROR: attempting to export test time series, however the test_indexes were not specified." << endl;
+        exit(1);
+    }
+
+    export_time_series(test_indexes, time_offset, inputs, outputs);
+}
+
 /**
  * This exports from all the loaded time series a particular column
  */
@@ -858,6 +1264,227 @@ void TimeSeriesSets::write_time_series_sets(string base_filename) {
     }
 }
 
+void TimeSeriesSets::write_to_stream(ostream &out, bool aligned) {
+    out.write((char*)&normalized, sizeof(bool));
+
+    write_binary_strings(out, filenames);
+    write_binary_indexes(out, training_indexes);
+    write_binary_indexes(out, test_indexes);
+
+    write_binary_strings(out, input_parameter_names);
+    write_binary_strings(out, output_parameter_names);
+    write_binary_strings(out, all_parameter_names);
+
+    write_binary_bounds(out, normalize_mins);
+    write_binary_bounds(out, normalize_maxs);
+
+    int32_t number_sets = time_series.size();
+    out.write((char*)&number_sets, sizeof(int32_t));
+    for (int32_t i = 0; i < number_sets; i++) {
+        time_series[i]->write_to_stream(out, aligned);
+    }
+}
+
+void TimeSeriesSets::read_from_stream(istream &in, bool aligned, const char *mapped) {
+    in.read((char*)&normalized, sizeof(bool));
+
+    read_binary_strings(in, filenames);
+    read_binary_indexes(in, training_indexes);
+    read_binary_indexes(in, test_indexes);
+
+    read_binary_strings(in, input_parameter_names);
+    read_binary_strings(in, output_parameter_names);
+    read_binary_strings(in, all_parameter_names);
+
+    read_binary_bounds(in, normalize_mins);
+    read_binary_bounds(in, normalize_maxs);
+
+    int32_t number_sets = 0;
+    in.read((char*)&number_sets, sizeof(int32_t));
+    time_series.clear();
+    for (int32_t i = 0; i < number_sets; i++) {
+        time_series.push_back(new TimeSeriesSet(in, aligned, mapped));
+    }
+
+    if (!in.good()) {
+        cerr << "ERROR: reached the end of the time series data before all of it was read" << endl;
+        exit(1);
+    }
+}
+
+#define TIME_SERIES_CACHE_MAGIC 0x43535445
+#define TIME_SERIES_CACHE_VERSION 3
+
+//64 bit FNV-1a over the contents of a file
+static bool get_file_checksum(string filename, uint64_t &checksum) {
+    ifstream in(filename, ios::in | ios::binary);
+    if (!in.is_open()) return false;
+
+    checksum = 14695981039346656037ull;
+
+    char buffer[1 << 16];
+    while (in) {
+        in.read(buffer, sizeof(buffer));
+        int64_t length = in.gcount();
+        for (int64_t i = 0; i < length; i++) {
+            checksum ^= (unsigned char)buffer[i];
+            checksum *= 1099511628211ull;
+        }
+    }
+    return in.eof();
+}
+
+//the size, modification time (to the nanosecond) and a checksum of the
+//contents of each of the files, which have to match for a cache of them to
+//be used. the checksum catches files rewritten within the resolution of the
+//modification time, and reading the files is still much faster than
+//parsing them.
+static bool get_file_stamps(const vector<string> &filenames, vector<int64_t> &stamps) {
+    stamps.clear();
+    for (int32_t i = 0; i < (int32_t)filenames.size(); i++) {
+        struct stat file_stat;
+        if (stat(filenames[i].c_str(), &file_stat) != 0) return false;
+
+        uint64_t checksum;
+        if (!get_file_checksum(filenames[i], checksum)) return false;
+
+        stamps.push_back(file_stat.st_size);
+        stamps.push_back(file_stat.st_mtim.tv_sec);
+        stamps.push_back(file_stat.st_mtim.tv_nsec);
+        stamps.push_back((int64_t)checksum);
+    }
+    return true;
+}
+
+//the cache holds the (unnormalized) sets loaded from the files, after a
+//header with the files' stamps (see get_file_stamps) and the parameters
+//which were loaded. each series' values are aligned in the file so that when
+//streaming they can be used where the file is mapped.
+bool TimeSeriesSets::read_cache(string cache_filename, bool stream, bool verbose) {
+    ifstream in(cache_filename, ios::in | ios::binary);
+    if (!in.is_open()) {
+        if (verbose) cout << "no time series cache in '" << cache_filename << "', loading the CSV files" << endl;
+        return false;
+    }
+
+    int32_t magic = 0, version = 0;
+    in.read((char*)&magic, sizeof(int32_t));
+    in.read((char*)&version, sizeof(int32_t));
+    if (magic != TIME_SERIES_CACHE_MAGIC || version != TIME_SERIES_CACHE_VERSION) {
+        cerr << "WARNING: '" << cache_filename << "' is not a time series cache of the current version, it will be rewritten" << endl;
+        return false;
+    }
+
+    vector<string> cached_filenames, cached_parameter_names;
+    read_binary_strings(in, cached_filenames);
+    read_binary_strings(in, cached_parameter_names);
+
+    int32_t number_stamps = 0;
+    in.read((char*)&number_stamps, sizeof(int32_t));
+    vector<int64_t> stamps(number_stamps);
+    in.read((char*)stamps.data(), sizeof(int64_t) * number_stamps);
+
+    vector<int64_t> current_stamps;
+    if (!in.good() || cached_filenames != filenames || cached_parameter_names != all_parameter_names || !get_file_stamps(filenames, current_stamps) || stamps != current_stamps) {
+        if (verbose) cout << "time series cache '" << cache_filename << "' is out of date, loading the CSV files" << endl;
+        return false;
+    }
+
+    const char *mapped = NULL;
+    size_t mapped_length = 0;
+    if (stream) {
+        int fd = open(cache_filename.c_str(), O_RDONLY);
+        struct stat file_stat;
+        if (fd >= 0 && fstat(fd, &file_stat) == 0) {
+            mapped_length = file_stat.st_size;
+            mapped = (const char*)mmap(NULL, mapped_length, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        if (fd >= 0) close(fd);
+
+        if (mapped == NULL || mapped == MAP_FAILED) {
+            cerr << "ERROR: could not map time series cache '" << cache_filename << "': " << strerror(errno) << endl;
+            exit(1);
+        }
+
+        //the series are visited in a random order
+        madvise((void*)mapped, mapped_length, MADV_RANDOM);
+    }
+
+    int32_t number_sets = 0;
+    in.read((char*)&number_sets, sizeof(int32_t));
+
+    vector<TimeSeriesSet*> cached_sets;
+    for (int32_t i = 0; i < number_sets && in.good(); i++) {
+        cached_sets.push_back(new TimeSeriesSet(in, true, mapped));
+    }
+
+    //seeking past the end of the file isn't an error, so when streaming the
+    //file has to be checked to be long enough
+    if (!in.good() || (int32_t)cached_sets.size() != (int32_t)filenames.size() || (stream && (size_t)in.tellg() > mapped_length)) {
+        cerr << "WARNING: time series cache '" << cache_filename << "' is incomplete, it will be rewritten" << endl;
+        for (int32_t i = 0; i < (int32_t)cached_sets.size(); i++) delete cached_sets[i];
+        if (stream) munmap((void*)mapped, mapped_length);
+        return false;
+    }
+
+    time_series = cached_sets;
+    if (stream) {
+        mapped_cache = mapped;
+        mapped_cache_length = mapped_length;
+    }
+
+    if (verbose) cout << (stream ? "streaming " : "loaded ") << time_series.size() << " time series from cache '" << cache_filename << "'" << endl;
+    return true;
+}
+
+void TimeSeriesSets::write_cache(string cache_filename) {
+    vector<int64_t> stamps;
+    if (!get_file_stamps(filenames, stamps)) {
+        cerr << "WARNING: could not stat the time series files, not writing cache '" << cache_filename << "'" << endl;
+        return;
+    }
+
+    //written to a temporary file and renamed, so a cache is never read while
+    //it is partially written
+    string temporary_filename = cache_filename + "." + to_string(getpid()) + ".tmp";
+    ofstream out(temporary_filename, ios::out | ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        cerr << "WARNING: could not open '" << temporary_filename << "' to write the time series cache" << endl;
+        return;
+    }
+
+    int32_t magic = TIME_SERIES_CACHE_MAGIC, version = TIME_SERIES_CACHE_VERSION;
+    out.write((char*)&magic, sizeof(int32_t));
+    out.write((char*)&version, sizeof(int32_t));
+
+    write_binary_strings(out, filenames);
+    write_binary_strings(out, all_parameter_names);
+
+    int32_t number_stamps = stamps.size();
+    out.write((char*)&number_stamps, sizeof(int32_t));
+    out.write((char*)stamps.data(), sizeof(int64_t) * number_stamps);
+
+    //if the files haven't been loaded (to stream them) they are loaded one
+    //at a time, so they never all have to fit in memory
+    int32_t number_sets = filenames.size();
+    out.write((char*)&number_sets, sizeof(int32_t));
+    for (int32_t i = 0; i < number_sets; i++) {
+        if (i < (int32_t)time_series.size()) {
+            time_series[i]->write_to_stream(out, true);
+        } else {
+            TimeSeriesSet *set = new TimeSeriesSet(filenames[i], all_parameter_names);
+            set->write_to_stream(out, true);
+            delete set;
+        }
+    }
+    out.close();
+
+    if (std::rename(temporary_filename.c_str(), cache_filename.c_str()) != 0) {
+        cerr << "WARNING: could not rename '" << temporary_filename << "' to '" << cache_filename << "'" << endl;
+        std::remove(temporary_filename.c_str());
+    }
+}
+
 void TimeSeriesSets::split_series(int series, int number_slices) {
     TimeSeriesSet *ts = time_series[series];
 
@@ -894,6 +1521,10 @@ int TimeSeriesSets::get_number_series() const {
     return time_series.size();
 }
 
+int TimeSeriesSets::get_number_rows(int series) const {
+    return time_series[series]->get_number_rows();
+}
+
 int TimeSeriesSets::get_number_inputs() const {
     return input_parameter_names.size();
 }
@@ -2,6 +2,7 @@
 #define EXAMM_TIME_SERIES_HXX
 
 #include <iostream>
+using std::istream;
 using std::ostream;
 
 #include <string>
@@ -13,6 +14,8 @@ using std::map;
 #include <vector>
 using std::vector;
 
+#include "series_view.hxx"
+
 class TimeSeries {
     private:
         string name;
@@ -27,11 +30,24 @@ class TimeSeries {
 
         vector<double> values;
 
+        //when streaming, the values are left in a memory mapped file instead,
+        //and are normalized as they are read (see get_value)
+        const double *mapped_values;
+        int32_t number_mapped_values;
+        double mapped_offset;
+        double mapped_range;
+
         TimeSeries();
     public:
         TimeSeries(string _name);
 
+        //reads a series written by write_to_stream. if mapped is given the
+        //stream is reading from a file which is mapped there, and the values
+        //are pointed to instead of read
+        TimeSeries(istream &in, bool aligned = false, const char *mapped = NULL);
+
         void add_value(double value);
+        void reserve(int32_t number_values);
         double get_value(int i);
 
         void calculate_statistics();
@@ -54,6 +70,11 @@ class TimeSeries {
         TimeSeries* copy();
 
         void copy_values(vector<double> &series);
+        SeriesColumn get_column(int32_t start) const;
+
+        //aligned pads the stream so the values start at a multiple of
+        //sizeof(double), so they can be used in place if it is mapped
+        void write_to_stream(ostream &out, bool aligned = false);
 };
 
 class TimeSeriesSet {
@@ -70,6 +91,8 @@ class TimeSeriesSet {
 
 
         TimeSeriesSet(string _filename, const vector<string> &_fields);
+        TimeSeriesSet(istream &in, bool aligned = false, const char *mapped = NULL);
+        ~TimeSeriesSet();
 
         void add_time_series(string name);
 
@@ -95,8 +118,13 @@ class TimeSeriesSet {
         void export_time_series(vector< vector<double> > &data, const vector<string> &requested_fields);
         void export_time_series(vector< vector<double> > &data, const vector<string> &requested_fields, int32_t time_offset);
 
+        //like export_time_series, but pointing into the loaded values instead of copying them
+        SeriesView get_view(const vector<string> &requested_fields, int32_t time_offset);
+
         TimeSeriesSet* copy();
 
+        void write_to_stream(ostream &out, bool aligned = false);
+
         void cut(int32_t start, int32_t stop);
         void split(int slices, vector<TimeSeriesSet*> &sub_series);
 
@@ -107,6 +135,7 @@ class TimeSeriesSet {
 class TimeSeriesSets {
     private:
         bool normalized;
+        string normalize_type;
 
         vector<string> filenames;
 
@@ -122,13 +151,25 @@ class TimeSeriesSets {
         map<string,double> normalize_mins;
         map<string,double> normalize_maxs;
 
+        //the cache file the series point into when streaming, which stays
+        //mapped until these sets are deleted
+        const char *mapped_cache;
+        size_t mapped_cache_length;
+
         void parse_parameters_string(const vector<string> &p);
         void load_time_series(bool verbose = false);
 
+        void check_bounds(string field);
+        void normalize_series();
+
+        bool read_cache(string cache_filename, bool stream, bool verbose);
+        void write_cache(string cache_filename);
+
     public:
         static void help_message();
 
         TimeSeriesSets();
+        ~TimeSeriesSets();
 
         static TimeSeriesSets* generate_from_arguments(const vector<string> &arguments, bool verbose = true);
         static TimeSeriesSets* generate_test(const vector<string> &_test_filenames, const vector<string> &_input_parameter_names, const vector<string> &_output_parameter_names, bool verbose = true);
@@ -141,12 +182,26 @@ class TimeSeriesSets {
 
         void write_time_series_sets(string base_filename);
 
+        //writes (or reads back) everything loaded, in binary, so the sets
+        //can be passed on without parsing the files again. as with
+        //TimeSeries, if mapped is given the stream reads from memory mapped
+        //there and the series use their values in place, so that memory has
+        //to outlive these sets.
+        void write_to_stream(ostream &out, bool aligned = false);
+        void read_from_stream(istream &in, bool aligned = false, const char *mapped = NULL);
+
         void export_time_series(const vector<int> &series_indexes, int time_offset, vector< vector< vector<double> > > &inputs, vector< vector< vector<double> > > &outputs);
 
         void export_training_series(int time_offset, vector< vector< vector<double> > > &inputs, vector< vector< vector<double> > > &outputs);
 
         void export_test_series(int time_offset, vector< vector< vector<double> > > &inputs, vector< vector< vector<double> > > &outputs);
 
+        //the same exports as views of the loaded series, which are only valid
+        //as long as these sets are
+        void export_time_series(const vector<int> &series_indexes, int time_offset, SeriesViews &inputs, SeriesViews &outputs);
+        void export_training_series(int time_offset, SeriesViews &inputs, SeriesViews &outputs);
+        void export_test_series(int time_offset, SeriesViews &inputs, SeriesViews &outputs);
+
         void export_series_by_name(string field_name, vector< vector<double> > &exported_series);
 
         map<string,double> get_normalize_mins() const;
@@ -156,6 +211,7 @@ class TimeSeriesSets {
         vector<string> get_output_parameter_names() const;
 
         int get_number_series() const;
+        int get_number_rows(int series) const;
 
         int get_number_inputs() const;
         int get_number_outputs() const;